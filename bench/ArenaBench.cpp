@@ -0,0 +1,34 @@
+#include "Bench.h"
+#include "accounting/Journal.h"
+#include <memory>
+#include <vector>
+
+using namespace market::accounting;
+
+int main()
+{
+    constexpr std::size_t ITERATIONS = 200000;
+
+    const std::vector<JournalEntry::Entry> lines = {
+        {Symbol("ACC001"), EntryType::DEBIT, Decimal(1000), "Cash received from customer settlement"},
+        {Symbol("ACC003"), EntryType::CREDIT, Decimal(1000), "Revenue recognized for settled order"}};
+
+    // Create a period's worth of entries, then drop them all at once
+    std::vector<std::shared_ptr<JournalEntry>> heapEntries;
+    heapEntries.reserve(ITERATIONS);
+    bench::run("create: JournalEntry on heap", ITERATIONS, [&](std::size_t)
+               { heapEntries.push_back(JournalEntry::create("TRX001", lines, "Sale")); });
+    bench::run("release: heap entries", 1, [&](std::size_t)
+               { heapEntries.clear(); });
+
+    auto arena = Arena::create();
+    std::vector<std::shared_ptr<JournalEntry>> arenaEntries;
+    arenaEntries.reserve(ITERATIONS);
+    bench::run("create: JournalEntry in arena", ITERATIONS, [&](std::size_t)
+               { arenaEntries.push_back(JournalEntry::create("TRX001", lines, "Sale", arena)); });
+    arena.reset();
+    bench::run("release: arena entries", 1, [&](std::size_t)
+               { arenaEntries.clear(); });
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "Bench.h"
+#include "accounting/BalanceKernel.h"
+#include "accounting/EntryType.h"
+#include "utils/Decimal.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+using market::accounting::BalanceKernel;
+using market::accounting::EntryType;
+
+namespace
+{
+    // Shape of the pre-columnar ledger: one heap object per entry
+    struct HeapEntry
+    {
+        std::string id;
+        std::string accountId;
+        std::string journalEntryId;
+        EntryType type;
+        Decimal amount;
+        std::int64_t timestamp;
+    };
+
+    // The entry-by-entry loop Ledger::getBalance used to run
+    Decimal balanceByEntry(const std::vector<std::shared_ptr<HeapEntry>> &entries, std::int64_t asOf)
+    {
+        Decimal balance(0);
+        for (const auto &entry : entries)
+        {
+            if (entry->timestamp <= asOf)
+            {
+                if (entry->type == EntryType::DEBIT)
+                {
+                    balance = balance + entry->amount;
+                }
+                else
+                {
+                    balance = balance - entry->amount;
+                }
+            }
+        }
+        return balance;
+    }
+}
+
+int main()
+{
+    constexpr std::size_t ENTRIES = 1 << 20;
+    constexpr std::size_t ITERATIONS = 50;
+
+    std::mt19937_64 random(42);
+    std::vector<std::shared_ptr<HeapEntry>> heapEntries;
+    std::vector<std::int64_t> amounts;
+    std::vector<std::int64_t> timestamps;
+    for (std::size_t i = 0; i < ENTRIES; ++i)
+    {
+        std::int64_t raw = static_cast<std::int64_t>(random() % 100000000) + 1;
+        EntryType type = random() % 2 ? EntryType::DEBIT : EntryType::CREDIT;
+        std::int64_t timestamp = static_cast<std::int64_t>(i);
+        heapEntries.push_back(std::make_shared<HeapEntry>(HeapEntry{"LEN", "ACC", "JEN", type, Decimal::fromRaw(raw), timestamp}));
+        amounts.push_back(type == EntryType::DEBIT ? raw : -raw);
+        timestamps.push_back(timestamp);
+    }
+    // Shuffle the heap objects' addresses the way a long-running ledger would
+    std::shuffle(heapEntries.begin(), heapEntries.end(), random);
+    // Varies per iteration so the compiler cannot hoist the loop
+    auto cutoffFor = [&](std::size_t i)
+    { return static_cast<std::int64_t>(ENTRIES * 3 / 4 + i); };
+
+    std::printf("%zu entries, detected kernel: %s\n", ENTRIES, BalanceKernel::getIsaName(BalanceKernel::getIsa()));
+    bench::run("as-of: shared_ptr entry loop", ITERATIONS, [&](std::size_t i)
+               { bench::doNotOptimize(balanceByEntry(heapEntries, cutoffFor(i))); });
+
+    for (auto isa : {BalanceKernel::Isa::SCALAR, BalanceKernel::Isa::SSE42, BalanceKernel::Isa::AVX2})
+    {
+        BalanceKernel::setIsa(isa);
+        if (BalanceKernel::getIsa() != isa)
+        {
+            continue;
+        }
+        std::string name = BalanceKernel::getIsaName(isa);
+        bench::run("as-of: sumUntil " + name, ITERATIONS, [&](std::size_t i)
+                   { bench::doNotOptimize(BalanceKernel::sumUntil(amounts.data(), timestamps.data(), ENTRIES, cutoffFor(i))); });
+        bench::run("total: sum " + name, ITERATIONS, [&](std::size_t)
+                   { bench::doNotOptimize(BalanceKernel::sum(amounts.data(), ENTRIES)); });
+        bench::run("split: sumBySign " + name, ITERATIONS, [&](std::size_t)
+                   {
+                       std::int64_t positive = 0;
+                       std::int64_t negative = 0;
+                       BalanceKernel::sumBySign(amounts.data(), ENTRIES, positive, negative);
+                       bench::doNotOptimize(positive); });
+    }
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace bench
+{
+    inline const void *volatile sink = nullptr;
+
+    // Keeps a computed value alive so the optimizer cannot drop the work
+    template <typename T>
+    inline void doNotOptimize(const T &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        sink = &value;
+#endif
+    }
+
+    // Runs fn(i) for i in [0, iterations) and prints the mean time per call.
+    template <typename Fn>
+    double run(const std::string &name, std::size_t iterations, Fn &&fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            fn(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double nsPerOp = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+        std::printf("%-40s %12.2f ns/op\n", name.c_str(), nsPerOp);
+        return nsPerOp;
+    }
+
+} // namespace bench
@@ -0,0 +1,80 @@
+#include "Bench.h"
+#include "accounting/EntryCodec.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace market::accounting;
+
+int main()
+{
+    constexpr std::size_t ENTRIES = 100000;
+
+    std::vector<std::shared_ptr<JournalEntry>> entries;
+    std::vector<std::shared_ptr<LedgerEntry>> postings;
+    entries.reserve(ENTRIES);
+    postings.reserve(ENTRIES);
+    for (std::size_t i = 0; i < ENTRIES; ++i)
+    {
+        Symbol account("ACC" + std::to_string(i % 1000));
+        Decimal amount(static_cast<int>(1000 + i % 97));
+        entries.push_back(JournalEntry::create(
+            "TRX" + std::to_string(i),
+            std::vector<JournalEntry::Entry>{{account, EntryType::DEBIT, amount, "Cash received from customer settlement"},
+             {Symbol("REV001"), EntryType::CREDIT, amount, ""}},
+            "Sale"));
+        postings.push_back(LedgerEntry::create(account, entries.back()->getNumericId(), EntryType::DEBIT, amount));
+    }
+
+    // Encoded back to back, as a log or a replication stream would carry them
+    std::string journal;
+    std::vector<std::size_t> journalEnds;
+    bench::run("encode: journal entry", ENTRIES, [&](std::size_t i)
+               {
+                   BinaryWriter writer(journal);
+                   EntryCodec::encode(*entries[i], writer);
+                   journalEnds.push_back(journal.size()); });
+
+    std::string ledger;
+    std::vector<std::size_t> ledgerEnds;
+    bench::run("encode: ledger entry", ENTRIES, [&](std::size_t i)
+               {
+                   BinaryWriter writer(ledger);
+                   EntryCodec::encode(*postings[i], writer);
+                   ledgerEnds.push_back(ledger.size()); });
+
+    auto message = [](const std::string &data, const std::vector<std::size_t> &ends, std::size_t i)
+    {
+        std::size_t begin = i == 0 ? 0 : ends[i - 1];
+        return std::string_view(data).substr(begin, ends[i] - begin);
+    };
+
+    // Scanning the fields alone is what a reader that skips a record pays
+    std::uint64_t fields = 0;
+    bench::run("scan fields: journal entry", ENTRIES, [&](std::size_t i)
+               {
+                   BinaryReader reader(message(journal, journalEnds, i));
+                   while (reader.next())
+                   {
+                       ++fields;
+                   } });
+    bench::doNotOptimize(fields);
+
+    auto arena = Arena::create();
+    std::shared_ptr<JournalEntry> decoded;
+    bench::run("decode: journal entry", ENTRIES, [&](std::size_t i)
+               { decoded = EntryCodec::decodeJournalEntry(message(journal, journalEnds, i)); });
+    bench::run("decode: journal entry, arena", ENTRIES, [&](std::size_t i)
+               { decoded = EntryCodec::decodeJournalEntry(message(journal, journalEnds, i), arena); });
+    bench::doNotOptimize(decoded);
+
+    std::shared_ptr<LedgerEntry> posting;
+    bench::run("decode: ledger entry", ENTRIES, [&](std::size_t i)
+               { posting = EntryCodec::decodeLedgerEntry(message(ledger, ledgerEnds, i)); });
+    bench::doNotOptimize(posting);
+
+    std::printf("%-40s %12.1f bytes\n", "size: journal entry", static_cast<double>(journal.size()) / ENTRIES);
+    std::printf("%-40s %12.1f bytes\n", "size: ledger entry", static_cast<double>(ledger.size()) / ENTRIES);
+    return 0;
+}
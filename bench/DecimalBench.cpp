@@ -0,0 +1,62 @@
+#include "Bench.h"
+#include "utils/Decimal.h"
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // The stream-based conversions Decimal used before fromChars/toChars
+    Decimal parseWithStream(const std::string &str)
+    {
+        std::istringstream iss(str);
+        double value;
+        iss >> value;
+        return Decimal(value);
+    }
+
+    std::string formatWithStream(const Decimal &value)
+    {
+        std::ostringstream oss;
+        oss << std::setprecision(17) << value.toDouble();
+        return oss.str();
+    }
+}
+
+int main()
+{
+    constexpr std::size_t ITERATIONS = 2000000;
+
+    std::vector<std::string> inputs;
+    for (int i = 0; i < 1024; ++i)
+    {
+        inputs.push_back(std::to_string(i * 7919 % 1000000) + "." + std::to_string(i * 31 % 100));
+    }
+    std::vector<Decimal> values;
+    for (const auto &input : inputs)
+    {
+        values.push_back(Decimal(input));
+    }
+
+    bench::run("parse: istringstream", ITERATIONS, [&](std::size_t i)
+               { bench::doNotOptimize(parseWithStream(inputs[i % inputs.size()])); });
+    bench::run("parse: Decimal::fromChars", ITERATIONS, [&](std::size_t i)
+               {
+                   const std::string &input = inputs[i % inputs.size()];
+                   Decimal value;
+                   Decimal::fromChars(input.data(), input.data() + input.size(), value);
+                   bench::doNotOptimize(value); });
+
+    bench::run("format: ostringstream", ITERATIONS, [&](std::size_t i)
+               { bench::doNotOptimize(formatWithStream(values[i % values.size()])); });
+    bench::run("format: Decimal::toString", ITERATIONS, [&](std::size_t i)
+               { bench::doNotOptimize(values[i % values.size()].toString()); });
+    bench::run("format: Decimal::toChars", ITERATIONS, [&](std::size_t i)
+               {
+                   char buffer[Decimal::MAX_CHARS];
+                   auto result = values[i % values.size()].toChars(buffer, buffer + sizeof(buffer));
+                   bench::doNotOptimize(result.ptr); });
+
+    return 0;
+}
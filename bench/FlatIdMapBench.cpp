@@ -0,0 +1,127 @@
+#include "Bench.h"
+#include "utils/FlatIdMap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Heap bytes in use, as the allocator rounds them
+static std::size_t heapBytes = 0;
+
+void *operator new(std::size_t size)
+{
+    void *p = std::malloc(size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    heapBytes += malloc_usable_size(p);
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p)
+    {
+        heapBytes -= malloc_usable_size(p);
+        std::free(p);
+    }
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+namespace
+{
+    // Stands in for a wallet: carries its own ID
+    struct Child
+    {
+        std::string id;
+        std::string currency;
+        const std::string &getId() const { return id; }
+    };
+
+    using ChildPtr = std::shared_ptr<Child>;
+    using NodeMap = std::unordered_map<std::string, ChildPtr>;
+    using FlatMap = FlatIdMap<Child>;
+
+    // The child collections of core::Account: wallets, assets,
+    // liabilities and contracts
+    template <typename Map>
+    struct Collections
+    {
+        Map maps[4];
+    };
+
+    void add(NodeMap &map, const ChildPtr &child) { map[child->id] = child; }
+    void add(FlatMap &map, const ChildPtr &child) { map.insert(child); }
+
+    ChildPtr find(const NodeMap &map, const std::string &id)
+    {
+        auto it = map.find(id);
+        return it != map.end() ? it->second : nullptr;
+    }
+
+    ChildPtr find(const FlatMap &map, const std::string &id) { return map.get(id); }
+
+    // Bytes per account, with children wallets in the first map
+    template <typename Map>
+    double footprint(const std::vector<ChildPtr> &children, std::size_t accounts, std::size_t wallets)
+    {
+        std::size_t before = heapBytes;
+        std::vector<Collections<Map>> all(accounts);
+        for (std::size_t a = 0; a < accounts; ++a)
+        {
+            for (std::size_t w = 0; w < wallets; ++w)
+            {
+                add(all[a].maps[0], children[(a * wallets + w) % children.size()]);
+            }
+        }
+        return static_cast<double>(heapBytes - before) / static_cast<double>(accounts);
+    }
+
+    template <typename Map>
+    void lookups(const std::string &name, const std::vector<ChildPtr> &children, std::size_t count)
+    {
+        constexpr std::size_t LOOKUPS = 1000000;
+        Map map;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            add(map, children[i]);
+        }
+        bench::run(name + ", hit", LOOKUPS, [&](std::size_t i)
+                   { bench::doNotOptimize(find(map, children[i % count]->id)); });
+        bench::run(name + ", miss", LOOKUPS, [&](std::size_t i)
+                   { bench::doNotOptimize(find(map, children[count + i % count]->id)); });
+    }
+}
+
+int main()
+{
+    constexpr std::size_t ACCOUNTS = 100000;
+    std::vector<ChildPtr> children;
+    for (std::size_t i = 0; i < 4096; ++i)
+    {
+        children.push_back(std::make_shared<Child>(Child{"WLT" + std::to_string(100000000 + i), "USD"}));
+    }
+
+    for (std::size_t wallets : {0, 1, 2, 4, 16})
+    {
+        double nodes = footprint<NodeMap>(children, ACCOUNTS, wallets);
+        double flat = footprint<FlatMap>(children, ACCOUNTS, wallets);
+        std::printf("bytes per account, %2zu wallets: unordered_map %7.1f, FlatIdMap %7.1f\n", wallets, nodes, flat);
+    }
+
+    for (std::size_t count : {1, 2, 4, 16, 256})
+    {
+        lookups<NodeMap>("unordered_map: " + std::to_string(count) + " entries", children, count);
+        lookups<FlatMap>("FlatIdMap: " + std::to_string(count) + " entries", children, count);
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "Bench.h"
+#include "accounting/JournalLog.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace market::accounting;
+
+int main(int argc, char **argv)
+{
+    // Pass a path on the disk to measure; tmpfs makes every sync free
+    std::string path = argc > 1 ? argv[1] : "JournalLogBench.log";
+    constexpr std::size_t ENTRIES = 20000;
+    constexpr std::size_t THREADS = 8;
+
+    const std::vector<JournalEntry::Entry> lines = {
+        {Symbol("ACC001"), EntryType::DEBIT, Decimal(1000), "Cash received from customer settlement"},
+        {Symbol("ACC003"), EntryType::CREDIT, Decimal(1000), "Revenue recognized for settled order"}};
+    std::vector<std::shared_ptr<JournalEntry>> entries;
+    for (std::size_t i = 0; i < ENTRIES; ++i)
+    {
+        entries.push_back(JournalEntry::create("TRX001", lines, "Sale"));
+    }
+
+    std::remove(path.c_str());
+    {
+        auto log = JournalLog::create(path);
+        bench::run("write: one thread, sync per entry", ENTRIES / 10, [&](std::size_t i)
+                   { log->write(*entries[i]); });
+
+        // Concurrent writers share syncs; all the work happens in the first
+        // call, so the time is averaged over the entries written
+        bench::run("write: 8 threads, group commit", ENTRIES / 10, [&](std::size_t i)
+                   {
+                       if (i != 0)
+                       {
+                           return;
+                       }
+                       std::vector<std::thread> threads;
+                       for (std::size_t t = 0; t < THREADS; ++t)
+                       {
+                           threads.emplace_back([&, t]
+                                                {
+                                                    for (std::size_t j = t; j < ENTRIES / 10; j += THREADS)
+                                                    {
+                                                        log->write(*entries[j]);
+                                                    } });
+                       }
+                       for (auto &thread : threads)
+                       {
+                           thread.join();
+                       } });
+
+        bench::run("append: batch, one sync at the end", ENTRIES, [&](std::size_t i)
+                   {
+                       log->append(*entries[i]);
+                       if (i + 1 == ENTRIES)
+                       {
+                           log->sync();
+                       } });
+    }
+
+    // Reopening reads back every entry written above
+    std::size_t replayed = 0;
+    bench::run("replay: per entry", ENTRIES + ENTRIES / 5, [&](std::size_t i)
+               {
+                   if (i == 0)
+                   {
+                       replayed = JournalLog::create(path)->getReplayedCount();
+                   } });
+    bench::doNotOptimize(replayed);
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "Bench.h"
+#include "accounting/Ledger.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace market::accounting;
+
+int main(int argc, char **argv)
+{
+    std::string path = argc > 1 ? argv[1] : "LedgerSnapshotBench.snap";
+    constexpr std::size_t ENTRIES = 200000;
+    constexpr std::size_t ACCOUNTS = 100;
+    constexpr std::size_t RUNS = 20;
+
+    std::vector<std::shared_ptr<JournalEntry>> entries;
+    entries.reserve(ENTRIES);
+    for (std::size_t i = 0; i < ENTRIES; ++i)
+    {
+        entries.push_back(JournalEntry::create(
+            "TRX001",
+            {{Symbol("ACC" + std::to_string(i % ACCOUNTS)), EntryType::DEBIT, Decimal(1000), ""},
+             {Symbol("CASH"), EntryType::CREDIT, Decimal(1000), ""}}));
+    }
+
+    auto ledger = Ledger::create("Bench Ledger");
+    ledger->postBatch(entries);
+    bench::run("write snapshot", 1, [&](std::size_t)
+               { ledger->writeSnapshot(path); });
+
+    // Startup cost per journal entry: rebuilding by posting against
+    // opening the snapshot, and opening it then reading every balance
+    std::shared_ptr<Ledger> rebuilt;
+    double rebuild = bench::run("startup: post every entry", RUNS, [&](std::size_t)
+                                {
+                                    rebuilt = Ledger::create("Bench Ledger");
+                                    rebuilt->postBatch(entries);
+                                });
+    bench::doNotOptimize(rebuilt);
+
+    std::shared_ptr<Ledger> opened;
+    double open = bench::run("startup: open snapshot", RUNS, [&](std::size_t)
+                             { opened = Ledger::openSnapshot(path); });
+
+    Decimal total;
+    bench::run("startup: open snapshot, read balances", RUNS, [&](std::size_t)
+               {
+                   opened = Ledger::openSnapshot(path);
+                   for (std::size_t a = 0; a < ACCOUNTS; ++a)
+                   {
+                       total = total + opened->getBalance("ACC" + std::to_string(a));
+                   } });
+    bench::doNotOptimize(total);
+    std::printf("open is %.0fx faster than posting\n", rebuild / open);
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "Bench.h"
+#include "database/LocalRepository.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef MARKET_HAVE_POSTGRES
+#include "database/Database.h"
+#endif
+
+using namespace market;
+
+namespace
+{
+    bool sameAccount(const core::Account &a, const core::Account &b)
+    {
+        if (a.getId() != b.getId() || a.getName() != b.getName() || a.getType() != b.getType() ||
+            a.getWallets().size() != b.getWallets().size())
+        {
+            return false;
+        }
+        for (const auto &wallet : a.getWallets())
+        {
+            auto other = b.getWallet(wallet->getId());
+            if (!other || other->getCurrency() != wallet->getCurrency() || other->getNetWorth() != wallet->getNetWorth())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // Pass a path on the disk to measure; tmpfs makes every sync free. Set
+    // MARKET_BENCH_PG to "host port dbname user password" to also time the
+    // same calls against PostgreSQL.
+    std::string path = argc > 1 ? argv[1] : "LocalRepositoryBench.store";
+    constexpr std::size_t ACCOUNTS = 20000;
+
+    // Each account holds two wallets, saved alongside it
+    std::vector<std::shared_ptr<core::Account>> accounts;
+    for (std::size_t i = 0; i < ACCOUNTS; ++i)
+    {
+        auto account = core::Account::create("Operating cash " + std::to_string(i), core::Account::AccountType::ASSET);
+        account->addWallet(financial::Wallet::restore("WLT" + std::to_string(2 * i), "USD", Decimal(static_cast<int>(i))));
+        account->addWallet(financial::Wallet::restore("WLT" + std::to_string(2 * i + 1), "EUR", Decimal(1)));
+        accounts.push_back(account);
+    }
+
+    std::remove(path.c_str());
+    {
+        auto store = LocalStore::open(path);
+        auto accountRepository = LocalAccountRepository::create(store);
+        auto walletRepository = LocalWalletRepository::create(store);
+
+        bench::run("local: save account + 2 wallets", ACCOUNTS, [&](std::size_t i)
+                   {
+                       for (const auto &wallet : accounts[i]->getWallets())
+                       {
+                           walletRepository->save(wallet);
+                       }
+                       accountRepository->save(accounts[i]); });
+        bench::run("local: findById, account + 2 wallets", ACCOUNTS, [&](std::size_t i)
+                   { bench::doNotOptimize(accountRepository->findById(accounts[(i * 7919) % ACCOUNTS]->getId())); });
+        bench::run("local: findById, miss", ACCOUNTS, [&](std::size_t)
+                   { bench::doNotOptimize(accountRepository->findById("ACC-none")); });
+        bench::run("local: findAll per account", ACCOUNTS, [&](std::size_t i)
+                   {
+                       if (i == 0)
+                       {
+                           bench::doNotOptimize(accountRepository->findAll());
+                       } });
+    }
+
+    // Round trip: every account comes back from a reopened store as saved
+    {
+        auto store = LocalStore::open(path);
+        auto accountRepository = LocalAccountRepository::create(store);
+        for (const auto &account : accounts)
+        {
+            auto loaded = accountRepository->findById(account->getId());
+            if (!loaded || !sameAccount(*account, *loaded))
+            {
+                std::fprintf(stderr, "round trip failed for %s\n", account->getId().c_str());
+                return 1;
+            }
+        }
+    }
+    std::remove(path.c_str());
+
+#ifdef MARKET_HAVE_POSTGRES
+    // Accounts only: the accounts table does not hold wallets
+    if (const char *settings = std::getenv("MARKET_BENCH_PG"))
+    {
+        std::istringstream fields(settings);
+        std::string host, port, dbname, user, password;
+        fields >> host >> port >> dbname >> user >> password;
+        Database database(host, port, dbname, user, password);
+        database.connect();
+        bench::run("postgres: saveAccount", ACCOUNTS / 10, [&](std::size_t i)
+                   { database.saveAccount(accounts[i]); });
+        bench::run("postgres: loadAccount", ACCOUNTS / 10, [&](std::size_t i)
+                   { bench::doNotOptimize(database.loadAccount(accounts[(i * 7919) % (ACCOUNTS / 10)]->getId())); });
+        for (std::size_t i = 0; i < ACCOUNTS / 10; ++i)
+        {
+            database.deleteAccount(accounts[i]->getId());
+        }
+    }
+#endif
+    return 0;
+}
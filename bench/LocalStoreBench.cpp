@@ -0,0 +1,71 @@
+#include "Bench.h"
+#include "utils/LocalStore.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    // Pass a path on the disk to measure; tmpfs makes every sync free
+    std::string path = argc > 1 ? argv[1] : "LocalStoreBench.store";
+    constexpr std::size_t KEYS = 100000;
+
+    // Keys and values shaped like stored accounts: prefix plus ID, then a
+    // name and type
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < KEYS; ++i)
+    {
+        char id[32];
+        std::snprintf(id, sizeof(id), "account/ACC%09zu", i + 1);
+        keys.push_back(id);
+    }
+    const std::string value = std::string("\x14\0\0\0", 4) + "Operating cash 00001" + '\0';
+
+    std::remove(path.c_str());
+    {
+        auto store = LocalStore::open(path);
+        bench::run("put: new key", KEYS, [&](std::size_t i)
+                   { store->put(keys[i], value); });
+        bench::run("put: overwrite", KEYS, [&](std::size_t i)
+                   { store->put(keys[(i * 7919) % KEYS], value); });
+
+        std::string out;
+        bench::run("get: hit", KEYS, [&](std::size_t i)
+                   {
+                       store->get(keys[(i * 7919) % KEYS], out);
+                       bench::doNotOptimize(out); });
+        bench::run("get: miss", KEYS, [&](std::size_t)
+                   { bench::doNotOptimize(store->get(value, out)); });
+
+        bench::run("remove", KEYS / 10, [&](std::size_t i)
+                   { store->remove(keys[i]); });
+
+        LocalStoreOptions synced;
+        synced.syncEachWrite = true;
+        auto durable = LocalStore::open(path + ".sync", synced);
+        bench::run("put: sync per write", KEYS / 100, [&](std::size_t i)
+                   { durable->put(keys[i], value); });
+        std::remove((path + ".sync").c_str());
+
+        // Averaged over the live records copied
+        std::size_t live = store->size();
+        bench::run("compact: per live record", live, [&](std::size_t i)
+                   {
+                       if (i == 0)
+                       {
+                           store->compact();
+                       } });
+    }
+
+    // Reopening rebuilds the index from every record left after compaction
+    std::size_t replayed = 0;
+    bench::run("open: replay per record", KEYS - KEYS / 10, [&](std::size_t i)
+               {
+                   if (i == 0)
+                   {
+                       replayed = LocalStore::open(path)->getReplayedCount();
+                   } });
+    bench::doNotOptimize(replayed);
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "Bench.h"
+#include "accounting/ReportWriter.h"
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace market::accounting;
+
+namespace
+{
+    struct Line
+    {
+        Symbol accountId;
+        std::string accountName;
+        Decimal debit;
+        Decimal credit;
+    };
+
+    // Accepts and drops everything, so only formatting is timed
+    class DiscardBuffer : public std::streambuf
+    {
+    protected:
+        int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+        std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+    };
+
+    // One trial balance row the way generate() printed it before ReportWriter
+    void writeWithStream(std::ostream &out, const Line &line)
+    {
+        out << std::left << std::setw(16) << line.accountId
+            << std::setw(24) << line.accountName
+            << std::right << std::setw(16) << line.debit.toString()
+            << std::setw(16) << line.credit.toString() << "\n";
+    }
+}
+
+int main()
+{
+    constexpr std::size_t ROWS = 1000000;
+
+    std::vector<Line> lines;
+    for (int i = 0; i < 1024; ++i)
+    {
+        Decimal balance = Decimal::fromRaw(static_cast<std::int64_t>(i) * 7919 * 1000003 - 4000000000000LL);
+        Line line{Symbol("ACC" + std::to_string(i)), "Account " + std::to_string(i), Decimal(0), Decimal(0)};
+        (balance >= Decimal(0) ? line.debit : line.credit) = balance >= Decimal(0) ? balance : -balance;
+        lines.push_back(line);
+    }
+
+    DiscardBuffer buffer;
+    std::ostream discard(&buffer);
+
+    bench::run("row: iostream setw + toString", ROWS, [&](std::size_t i)
+               { writeWithStream(discard, lines[i % lines.size()]); });
+
+    for (auto format : {ReportFormat::TEXT, ReportFormat::CSV, ReportFormat::JSON_LINES, ReportFormat::BINARY})
+    {
+        static const char *const NAMES[] = {"text", "csv", "json lines", "binary"};
+        auto writer = ReportWriter::create(format, discard);
+        writer->beginReport("TRIAL BALANCE", {"Debit", "Credit"});
+        bench::run(std::string("row: ReportWriter ") + NAMES[static_cast<int>(format)], ROWS, [&](std::size_t i)
+                   {
+                       const Line &line = lines[i % lines.size()];
+                       writer->row(line.accountId, line.accountName, {line.debit, line.credit}); });
+        writer->endReport();
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "utils/Decimal.h"
+#include "utils/Symbol.h"
+#include "utils/ThreadPool.h"
+#include "accounting/Ledger.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        // Set of (account, asOf) balances shared between reports. Reports
+        // register what they need with request(); resolve() then reads each
+        // distinct balance from the ledger exactly once.
+        class BalanceCache
+        {
+        public:
+            using TimePoint = std::chrono::system_clock::time_point;
+
+            // asOf meaning "everything posted so far"
+            static constexpr TimePoint CURRENT = TimePoint::max();
+
+            void request(Symbol accountId, const TimePoint &asOf = CURRENT);
+
+            // Reads every requested balance from one snapshot, in parallel
+            // chunks when a pool is given
+            void resolve(const Ledger &ledger, ThreadPool *pool = nullptr);
+            void resolve(const Ledger::Snapshot &snapshot, ThreadPool *pool = nullptr);
+
+            // Throws std::out_of_range for a balance that was not requested
+            // and std::logic_error before resolve()
+            Decimal getBalance(Symbol accountId, const TimePoint &asOf = CURRENT) const;
+            std::int64_t getRawBalance(Symbol accountId, const TimePoint &asOf = CURRENT) const;
+            Decimal getBalance(std::string_view accountId, const TimePoint &asOf = CURRENT) const
+            {
+                return getBalance(Symbol::find(accountId), asOf);
+            }
+            std::int64_t getRawBalance(std::string_view accountId, const TimePoint &asOf = CURRENT) const
+            {
+                return getRawBalance(Symbol::find(accountId), asOf);
+            }
+
+            // Number of distinct balances requested
+            std::size_t size() const;
+            bool isResolved() const { return resolved_; }
+
+            // Ledger sequence number the balances were resolved at; see
+            // Ledger::Snapshot::getSequence
+            std::uint64_t getSequence() const { return sequence_; }
+
+        private:
+            // Balances sharing one asOf; reports rarely use more than a few
+            struct Group
+            {
+                TimePoint asOf;
+                SymbolMap<std::int64_t> balances;
+            };
+
+            std::vector<Group> groups_;
+            bool resolved_ = false;
+            std::uint64_t sequence_ = 0;
+        };
+
+    } // namespace accounting
+} // namespace market
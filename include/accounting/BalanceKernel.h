@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace market::accounting
+{
+
+    // Vectorized reductions over raw Decimal columns (see Decimal::toRaw).
+    // The widest instruction set supported by the CPU is chosen once at
+    // startup; every implementation returns exactly the same results, sums
+    // wrapping modulo 2^64 on overflow.
+    class BalanceKernel
+    {
+    public:
+        enum class Isa
+        {
+            SCALAR,
+            SSE42,
+            AVX2
+        };
+
+        // Sum of signed amounts
+        static std::int64_t sum(const std::int64_t *amounts, std::size_t count);
+
+        // Sum of the amounts whose timestamp is at or before cutoff. Does not
+        // require the timestamps to be sorted.
+        static std::int64_t sumUntil(const std::int64_t *amounts, const std::int64_t *timestamps,
+                                     std::size_t count, std::int64_t cutoff);
+
+        // Sums the positive and the negative values separately, e.g. to split
+        // account balances into debit and credit totals.
+        static void sumBySign(const std::int64_t *values, std::size_t count,
+                              std::int64_t &positive, std::int64_t &negative);
+
+        static Isa getIsa();
+        static const char *getIsaName(Isa isa);
+
+        // Overrides the detected instruction set; requests for one the CPU
+        // lacks fall back to the best supported one. Used by benchmarks.
+        static void setIsa(Isa isa);
+    };
+
+} // namespace market::accounting
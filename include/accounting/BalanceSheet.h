@@ -7,19 +7,23 @@
 #include <unordered_map>
 #include "utils/Decimal.h"
 #include "utils/IDGenerator.h"
+#include "utils/Symbol.h"
+#include "accounting/IReport.h"
 #include "accounting/Ledger.h"
+#include "accounting/BalanceCache.h"
+#include "utils/ThreadPool.h"
 
 namespace market
 {
     namespace accounting
     {
 
-        class BalanceSheet
+        class BalanceSheet : public IReport
         {
         public:
             struct AccountBalance
             {
-                std::string accountId;
+                Symbol accountId;
                 std::string accountName;
                 Decimal balance;
                 bool isDebit;
@@ -35,11 +39,22 @@ namespace market
             static std::shared_ptr<BalanceSheet> create(
                 const std::string &name,
                 std::shared_ptr<Ledger> ledger,
-                const std::chrono::system_clock::time_point &asOf);
+                const std::chrono::system_clock::time_point &asOf,
+                std::shared_ptr<ThreadPool> pool = nullptr);
 
-            void addAssetAccount(const std::string &accountId, const std::string &accountName, bool isDebit = true);
-            void addLiabilityAccount(const std::string &accountId, const std::string &accountName, bool isDebit = false);
-            void addEquityAccount(const std::string &accountId, const std::string &accountName, bool isDebit = false);
+            // Each add reads one balance and updates its section total
+            void addAssetAccount(Symbol accountId, const std::string &accountName, bool isDebit = true);
+            void addLiabilityAccount(Symbol accountId, const std::string &accountName, bool isDebit = false);
+            void addEquityAccount(Symbol accountId, const std::string &accountName, bool isDebit = false);
+
+            // Re-reads every account's balance from one ledger snapshot and
+            // recomputes the totals, in parallel chunks when a pool was given
+            void refresh();
+
+            void write(ReportWriter &writer) const override;
+            std::string getName() const override { return name_; }
+            void collectBalanceRequests(BalanceCache &balances) const override;
+            void compute(const BalanceCache &balances) override;
 
             const Section &getAssets() const { return assets_; }
             const Section &getLiabilities() const { return liabilities_; }
@@ -49,7 +64,6 @@ namespace market
             Decimal getTotalEquity() const { return equity_.total; }
             bool isBalanced() const { return assets_.total == (liabilities_.total + equity_.total); }
 
-            const std::string &getName() const { return name_; }
             const std::string &getId() const { return id_; }
             const std::chrono::system_clock::time_point &getAsOf() const { return asOf_; }
 
@@ -59,21 +73,23 @@ namespace market
                 const std::string &id,
                 const std::string &name,
                 std::shared_ptr<Ledger> ledger,
-                const std::chrono::system_clock::time_point &asOf);
+                const std::chrono::system_clock::time_point &asOf,
+                std::shared_ptr<ThreadPool> pool);
 
-            void updateSection(Section &section, const std::string &accountId, const std::string &accountName, bool isDebit);
-            void calculateTotals();
+            void updateSection(Section &section, Symbol accountId, const std::string &accountName, bool isDebit);
+            void computeSection(const BalanceCache &balances, Section &section);
 
             std::string id_;
             std::string name_;
             std::shared_ptr<Ledger> ledger_;
             std::chrono::system_clock::time_point asOf_;
+            std::shared_ptr<ThreadPool> pool_;
 
             Section assets_{"Assets", {}, Decimal(0)};
             Section liabilities_{"Liabilities", {}, Decimal(0)};
             Section equity_{"Equity", {}, Decimal(0)};
 
-            std::unordered_map<std::string, bool> accountTypes_; // true for debit, false for credit
+            std::unordered_map<Symbol, bool> accountTypes_; // true for debit, false for credit
         };
 
     } // namespace accounting
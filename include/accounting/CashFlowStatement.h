@@ -1,7 +1,6 @@
 #pragma once
 
-#include "accounting/IReport.h"
-#include "accounting/Ledger.h"
+#include "accounting/LiveReport.h"
 #include <vector>
 #include <string>
 #include <memory>
@@ -11,47 +10,38 @@ namespace market
     namespace accounting
     {
 
-        class CashFlowStatement : public IReport
+        // Inflow accounts count when their balance is positive, outflow
+        // accounts when it is negative
+        class CashFlowStatement : public SignedStatement
         {
         public:
-            struct AccountLine
-            {
-                std::string accountId;
-                std::string accountName;
-                Decimal amount;
-            };
-
+            // Only accounts with a balance of their section's sign are
+            // listed, so showEmptyAccounts has no effect; it is kept for
+            // callers that pass it
             static std::shared_ptr<CashFlowStatement> create(
                 std::shared_ptr<Ledger> ledger,
                 const std::vector<std::pair<std::string, std::string>> &inflowAccounts,
                 const std::vector<std::pair<std::string, std::string>> &outflowAccounts,
-                bool showEmptyAccounts = false);
+                bool showEmptyAccounts = false,
+                std::shared_ptr<ThreadPool> pool = nullptr);
 
-            void generate(std::ostream &out) const override;
             std::string getName() const override { return "Cash Flow Statement"; }
-            Decimal getTotalInflows() const { return totalInflows_; }
-            Decimal getTotalOutflows() const { return totalOutflows_; }
-            Decimal getNetCashFlow() const { return totalInflows_ - totalOutflows_; }
-            const std::vector<AccountLine> &getInflowLines() const { return inflowLines_; }
-            const std::vector<AccountLine> &getOutflowLines() const { return outflowLines_; }
+
+            Decimal getTotalInflows() const { return getPositiveTotal(); }
+            Decimal getTotalOutflows() const { return getNegativeTotal(); }
+            Decimal getNetCashFlow() const { return getNet(); }
+
+            std::vector<AccountLine> getInflowLines() const { return getPositiveLines(); }
+            std::vector<AccountLine> getOutflowLines() const { return getNegativeLines(); }
 
         private:
+            friend class ReportEngine;
             CashFlowStatement(
                 std::shared_ptr<Ledger> ledger,
                 const std::vector<std::pair<std::string, std::string>> &inflowAccounts,
                 const std::vector<std::pair<std::string, std::string>> &outflowAccounts,
-                bool showEmptyAccounts);
-            void compute();
-
-            std::shared_ptr<Ledger> ledger_;
-            std::vector<std::pair<std::string, std::string>> inflowAccounts_;
-            std::vector<std::pair<std::string, std::string>> outflowAccounts_;
-            std::vector<AccountLine> inflowLines_;
-            std::vector<AccountLine> outflowLines_;
-            Decimal totalInflows_;
-            Decimal totalOutflows_;
-            bool showEmptyAccounts_;
+                std::shared_ptr<ThreadPool> pool);
         };
 
     } // namespace accounting
-} // namespace market
\ No newline at end of file
+} // namespace market
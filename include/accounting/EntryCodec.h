@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include "accounting/JournalEntry.h"
+#include "accounting/Ledger.h"
+#include "utils/Arena.h"
+#include "utils/BinaryCodec.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        // BinaryCodec messages for journal and ledger entries, the record
+        // format of JournalLog. Field numbers:
+        //
+        //     JournalEntry  6 numeric id, 2 transaction id, 3 timestamp (ns
+        //                   since the epoch), 4 description, 5 line
+        //                   (repeated message)
+        //     line          1 account id, 2 type (0 debit, 1 credit),
+        //                   3 raw amount, 4 description
+        //     LedgerEntry   1 numeric id, 2 account id, 7 numeric journal
+        //                   entry id, 4 type, 5 raw amount, 6 timestamp
+        //
+        // Fields 1 of JournalEntry and 3 of LedgerEntry are retired and
+        // skipped. Account IDs are interned straight from the encoded bytes.
+        // Decoding throws std::runtime_error for a malformed message and
+        // whatever restore() throws for one that does not make a valid entry.
+        class EntryCodec
+        {
+        public:
+            static void encode(const JournalEntry &entry, BinaryWriter &out);
+            static void encode(const LedgerEntry &entry, BinaryWriter &out);
+
+            // Restored in arena, when given
+            static std::shared_ptr<JournalEntry> decodeJournalEntry(std::string_view data, const std::shared_ptr<Arena> &arena = nullptr);
+            static std::shared_ptr<LedgerEntry> decodeLedgerEntry(std::string_view data, const std::shared_ptr<Arena> &arena = nullptr);
+        };
+
+    } // namespace accounting
+} // namespace market
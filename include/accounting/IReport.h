@@ -3,18 +3,38 @@
 #include <string>
 #include <memory>
 #include <ostream>
+#include "accounting/ReportWriter.h"
 
 namespace market
 {
     namespace accounting
     {
+        class BalanceCache;
 
         class IReport
         {
         public:
             virtual ~IReport() = default;
-            virtual void generate(std::ostream &out) const = 0;
+
+            // Streams the report's rows and totals to writer
+            virtual void write(ReportWriter &writer) const = 0;
+
+            // Writes the report as a fixed-width text table
+            virtual void generate(std::ostream &out) const
+            {
+                auto writer = ReportWriter::create(ReportFormat::TEXT, out);
+                write(*writer);
+                writer->flush();
+            }
+
             virtual std::string getName() const = 0;
+
+            // Registers every (account, asOf) balance the report reads, so a
+            // ReportEngine can resolve each one once for all its reports
+            virtual void collectBalanceRequests(BalanceCache &balances) const = 0;
+
+            // Rebuilds the report from resolved balances
+            virtual void compute(const BalanceCache &balances) = 0;
         };
 
         using IReportPtr = std::shared_ptr<IReport>;
@@ -1,7 +1,6 @@
 #pragma once
 
-#include "accounting/IReport.h"
-#include "accounting/Ledger.h"
+#include "accounting/LiveReport.h"
 #include <vector>
 #include <string>
 #include <memory>
@@ -11,47 +10,38 @@ namespace market
     namespace accounting
     {
 
-        class IncomeStatement : public IReport
+        // Revenue accounts count when their balance is positive, expense
+        // accounts when it is negative
+        class IncomeStatement : public SignedStatement
         {
         public:
-            struct AccountLine
-            {
-                std::string accountId;
-                std::string accountName;
-                Decimal amount;
-            };
-
+            // Only accounts with a balance of their section's sign are
+            // listed, so showEmptyAccounts has no effect; it is kept for
+            // callers that pass it
             static std::shared_ptr<IncomeStatement> create(
                 std::shared_ptr<Ledger> ledger,
                 const std::vector<std::pair<std::string, std::string>> &revenueAccounts,
                 const std::vector<std::pair<std::string, std::string>> &expenseAccounts,
-                bool showEmptyAccounts = false);
+                bool showEmptyAccounts = false,
+                std::shared_ptr<ThreadPool> pool = nullptr);
 
-            void generate(std::ostream &out) const override;
             std::string getName() const override { return "Income Statement"; }
-            Decimal getTotalRevenue() const { return totalRevenue_; }
-            Decimal getTotalExpenses() const { return totalExpenses_; }
-            Decimal getNetIncome() const { return totalRevenue_ - totalExpenses_; }
-            const std::vector<AccountLine> &getRevenueLines() const { return revenueLines_; }
-            const std::vector<AccountLine> &getExpenseLines() const { return expenseLines_; }
+
+            Decimal getTotalRevenue() const { return getPositiveTotal(); }
+            Decimal getTotalExpenses() const { return getNegativeTotal(); }
+            Decimal getNetIncome() const { return getNet(); }
+
+            std::vector<AccountLine> getRevenueLines() const { return getPositiveLines(); }
+            std::vector<AccountLine> getExpenseLines() const { return getNegativeLines(); }
 
         private:
+            friend class ReportEngine;
             IncomeStatement(
                 std::shared_ptr<Ledger> ledger,
                 const std::vector<std::pair<std::string, std::string>> &revenueAccounts,
                 const std::vector<std::pair<std::string, std::string>> &expenseAccounts,
-                bool showEmptyAccounts);
-            void compute();
-
-            std::shared_ptr<Ledger> ledger_;
-            std::vector<std::pair<std::string, std::string>> revenueAccounts_;
-            std::vector<std::pair<std::string, std::string>> expenseAccounts_;
-            std::vector<AccountLine> revenueLines_;
-            std::vector<AccountLine> expenseLines_;
-            Decimal totalRevenue_;
-            Decimal totalExpenses_;
-            bool showEmptyAccounts_;
+                std::shared_ptr<ThreadPool> pool);
         };
 
     } // namespace accounting
-} // namespace market
\ No newline at end of file
+} // namespace market
@@ -4,9 +4,16 @@
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include "utils/Decimal.h"
 #include "utils/IDGenerator.h"
+#include "utils/Symbol.h"
+#include "utils/Span.h"
+#include "utils/Arena.h"
 #include "financial/Transaction.h"
 #include "accounting/JournalEntry.h"
 
@@ -14,31 +21,230 @@ namespace market
 {
     namespace accounting
     {
+        class JournalLog;
+
         class Journal
         {
         public:
-            static std::shared_ptr<Journal> create(const std::string &name);
+            // Entries selected through one of the journal's indices, or a
+            // run of consecutive entries, viewed in place without copying
+            // their shared_ptrs. Iterating yields const JournalEntry&. Valid
+            // until the next addEntry.
+            class EntryRange
+            {
+            public:
+                class const_iterator
+                {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type = JournalEntry;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const JournalEntry *;
+                    using reference = const JournalEntry &;
+
+                    const_iterator() = default;
+                    // Without index, steps through entries themselves
+                    const_iterator(const std::shared_ptr<JournalEntry> *entries, const std::size_t *index)
+                        : entries_(entries), index_(index) {}
+
+                    reference operator*() const { return *get(); }
+                    pointer operator->() const { return get(); }
+                    const_iterator &operator++()
+                    {
+                        if (index_)
+                        {
+                            ++index_;
+                        }
+                        else
+                        {
+                            ++entries_;
+                        }
+                        return *this;
+                    }
+                    const_iterator operator++(int)
+                    {
+                        const_iterator previous = *this;
+                        ++*this;
+                        return previous;
+                    }
+                    bool operator==(const const_iterator &other) const { return index_ == other.index_ && entries_ == other.entries_; }
+                    bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+                private:
+                    pointer get() const { return (index_ ? entries_[*index_] : *entries_).get(); }
+
+                    const std::shared_ptr<JournalEntry> *entries_ = nullptr;
+                    const std::size_t *index_ = nullptr;
+                };
+
+                EntryRange() = default;
+                EntryRange(Span<const std::shared_ptr<JournalEntry>> entries, Span<const std::size_t> indices)
+                    : entries_(entries), indices_(indices), indexed_(true) {}
+                explicit EntryRange(Span<const std::shared_ptr<JournalEntry>> entries)
+                    : entries_(entries), indexed_(false) {}
+
+                const_iterator begin() const
+                {
+                    return indexed_ ? const_iterator(entries_.data(), indices_.begin()) : const_iterator(entries_.begin(), nullptr);
+                }
+                const_iterator end() const
+                {
+                    return indexed_ ? const_iterator(entries_.data(), indices_.end()) : const_iterator(entries_.end(), nullptr);
+                }
+                std::size_t size() const { return indexed_ ? indices_.size() : entries_.size(); }
+                bool empty() const { return size() == 0; }
 
+            private:
+                Span<const std::shared_ptr<JournalEntry>> entries_;
+                Span<const std::size_t> indices_;
+                bool indexed_ = true;
+            };
+
+            // Entries are allocated on the heap by default. With
+            // periodArena, each period's entries come from an arena of their
+            // own that is freed in bulk once the period is closed and its
+            // entries are released; worth it only for many short-lived
+            // entries.
+            static std::shared_ptr<Journal> create(const std::string &name, bool periodArena = false);
+
+            // With a log attached, returns once the entry is durable in it
             void addEntry(std::shared_ptr<JournalEntry> entry);
-            std::vector<std::shared_ptr<JournalEntry>> getEntries() const;
-            std::vector<std::shared_ptr<JournalEntry>> getEntriesByAccount(const std::string &accountId) const;
-            std::vector<std::shared_ptr<JournalEntry>> getEntriesByTransaction(const std::string &transactionId) const;
+
+            // Adds several entries, waiting for the log once for all of them
+            void addEntries(Span<const std::shared_ptr<JournalEntry>> entries);
+
+            // Creates a journal entry, in the current period's arena if there
+            // is one, and adds it
+            std::shared_ptr<JournalEntry> createEntry(
+                const std::string &transactionId,
+                const std::vector<JournalEntry::Entry> &entries,
+                const std::string &description = "");
+
+            // Ends the current period: hands back its entries and clears the
+            // journal. With a period arena, a fresh one is started and the
+            // closed period's is freed once the returned entries are released.
+            std::vector<std::shared_ptr<JournalEntry>> closePeriod();
+
+            // Entries added from now on are written to log before they are
+            // added; see JournalLog::recover for reopening a journal
+            void attachLog(std::shared_ptr<JournalLog> log) { log_ = std::move(log); }
+            const std::shared_ptr<JournalLog> &getLog() const { return log_; }
+
+            // Null unless the journal was created with periodArena
+            const std::shared_ptr<Arena> &getArena() const { return arena_; }
+            const std::vector<std::shared_ptr<JournalEntry>> &getEntries() const { return entries_; }
+            std::vector<std::shared_ptr<JournalEntry>> getEntriesByAccount(Symbol accountId) const;
+            // By name, without interning it; an unknown account has no entries
+            std::vector<std::shared_ptr<JournalEntry>> getEntriesByAccount(std::string_view accountId) const
+            {
+                return getEntriesByAccount(Symbol::find(accountId));
+            }
+            std::vector<std::shared_ptr<JournalEntry>> getEntriesByTransaction(std::string_view transactionId) const;
             std::vector<std::shared_ptr<JournalEntry>> getEntriesByDateRange(
                 const std::chrono::system_clock::time_point &start,
                 const std::chrono::system_clock::time_point &end) const;
 
+            // Views over the journal's storage; no allocation or refcounting
+            EntryRange getEntryRangeByAccount(Symbol accountId) const;
+            EntryRange getEntryRangeByAccount(std::string_view accountId) const
+            {
+                return getEntryRangeByAccount(Symbol::find(accountId));
+            }
+            EntryRange getEntryRangeByTransaction(std::string_view transactionId) const;
+            // Entries within [start, end] in timestamp order, those with
+            // equal timestamps in the order they were added
+            EntryRange getEntryRangeByDateRange(
+                const std::chrono::system_clock::time_point &start,
+                const std::chrono::system_clock::time_point &end) const;
+
+            // Visitors: call fn(const JournalEntry&) for each matching entry,
+            // in the order the entries were added.
+            template <typename Fn>
+            void forEachEntry(Fn &&fn) const
+            {
+                for (const auto &entry : entries_)
+                {
+                    fn(*entry);
+                }
+            }
+
+            template <typename Fn>
+            void forEachEntryByAccount(Symbol accountId, Fn &&fn) const
+            {
+                for (const auto &entry : getEntryRangeByAccount(accountId))
+                {
+                    fn(entry);
+                }
+            }
+
+            template <typename Fn>
+            void forEachEntryByAccount(std::string_view accountId, Fn &&fn) const
+            {
+                forEachEntryByAccount(Symbol::find(accountId), std::forward<Fn>(fn));
+            }
+
+            template <typename Fn>
+            void forEachEntryByTransaction(std::string_view transactionId, Fn &&fn) const
+            {
+                for (const auto &entry : getEntryRangeByTransaction(transactionId))
+                {
+                    fn(entry);
+                }
+            }
+
+            template <typename Fn>
+            void forEachEntryByDateRange(
+                const std::chrono::system_clock::time_point &start,
+                const std::chrono::system_clock::time_point &end,
+                Fn &&fn) const
+            {
+                if (timeOrdered_)
+                {
+                    for (const auto &entry : timeOrderedRange(start, end))
+                    {
+                        fn(*entry);
+                    }
+                    return;
+                }
+                for (const auto &entry : entries_)
+                {
+                    if (entry->getTimestamp() >= start && entry->getTimestamp() <= end)
+                    {
+                        fn(*entry);
+                    }
+                }
+            }
+
             const std::string &getName() const { return name_; }
             const std::string &getId() const { return id_; }
 
         private:
             static IDGenerator idGen_;
-            Journal(const std::string &id, const std::string &name);
+            Journal(const std::string &id, const std::string &name, bool periodArena);
+
+            // Adds entry to the in-memory entries and indices
+            void insert(std::shared_ptr<JournalEntry> entry);
+            std::vector<std::shared_ptr<JournalEntry>> collect(const std::vector<size_t> &indices) const;
+
+            // Entries within [start, end]; only valid while timeOrdered_
+            Span<const std::shared_ptr<JournalEntry>> timeOrderedRange(
+                const std::chrono::system_clock::time_point &start,
+                const std::chrono::system_clock::time_point &end) const;
 
             std::string id_;
             std::string name_;
+            std::shared_ptr<Arena> arena_;
+            std::shared_ptr<JournalLog> log_;
             std::vector<std::shared_ptr<JournalEntry>> entries_;
-            std::unordered_map<std::string, std::vector<size_t>> accountIndex_;
-            std::unordered_map<std::string, std::vector<size_t>> transactionIndex_;
+            SymbolMap<std::vector<size_t>> accountIndex_;
+            // Keyed by views of each entry's own transaction ID
+            std::unordered_map<std::string_view, std::vector<size_t>> transactionIndex_;
+            // True while entries were added in timestamp order, which lets
+            // date range queries binary search instead of scanning.
+            bool timeOrdered_ = true;
+            // Every entry's index in timestamp order, kept only once
+            // timeOrdered_ is false
+            std::vector<size_t> timeIndex_;
         };
 
     } // namespace accounting
@@ -3,10 +3,15 @@
 #include "utils/Decimal.h"
 #include "accounting/EntryType.h"
 #include "utils/IDGenerator.h"
+#include "utils/Symbol.h"
+#include "utils/Arena.h"
 #include <string>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <chrono>
+#include <cstdint>
+#include <string_view>
 
 namespace market::accounting
 {
@@ -16,31 +21,68 @@ namespace market::accounting
     public:
         struct Entry
         {
-            std::string accountId;
+            Symbol accountId;
             EntryType type;
             Decimal amount;
-            std::string description;
+            std::pmr::string description;
         };
 
+        // When an arena is given, the entry, its control block, its lines
+        // and all of its strings are allocated from it.
         static std::shared_ptr<JournalEntry> create(
             const std::string &transactionId,
             const std::vector<Entry> &entries,
-            const std::string &description = "");
+            const std::string &description = "",
+            const std::shared_ptr<Arena> &arena = nullptr);
 
-        const std::string &getId() const { return id_; }
-        const std::string &getTransactionId() const { return transactionId_; }
-        const std::vector<Entry> &getEntries() const { return entries_; }
-        const std::string &getDescription() const { return description_; }
+        // Rebuilds an entry read back from storage with its original ID and
+        // timestamp. Checked like create(); the ID counter skips past id.
+        static std::shared_ptr<JournalEntry> restore(
+            std::uint64_t id,
+            const std::string &transactionId,
+            const std::vector<Entry> &entries,
+            const std::string &description,
+            const std::chrono::system_clock::time_point &timestamp,
+            const std::shared_ptr<Arena> &arena = nullptr);
+
+        // Ledger postings refer back to the entry by its numeric ID; the
+        // string form is only built when asked for
+        std::string getId() const { return idGen_.format(id_); }
+        std::uint64_t getNumericId() const { return id_; }
+        const std::pmr::string &getTransactionId() const { return transactionId_; }
+        const std::pmr::vector<Entry> &getEntries() const { return entries_; }
+        const std::pmr::string &getDescription() const { return description_; }
         const std::chrono::system_clock::time_point &getTimestamp() const { return timestamp_; }
 
+        // Converts between numeric IDs and their string form, for stored
+        // records; parseId is false for a string not in that form
+        static std::string formatId(std::uint64_t id) { return idGen_.format(id); }
+        static bool parseId(std::string_view id, std::uint64_t &value) { return idGen_.parse(id, value); }
+
     private:
         static IDGenerator idGen_;
-        JournalEntry(const std::string &id, const std::string &transactionId, const std::vector<Entry> &entries, const std::string &description);
+        JournalEntry(
+            std::uint64_t id,
+            const std::string &transactionId,
+            const std::vector<Entry> &entries,
+            const std::string &description,
+            const std::chrono::system_clock::time_point &timestamp,
+            std::pmr::memory_resource *resource);
+
+        // Throws std::invalid_argument unless the lines are positive and balance
+        static void validate(const std::vector<Entry> &entries);
+        static std::shared_ptr<JournalEntry> make(
+            std::uint64_t id,
+            const std::string &transactionId,
+            const std::vector<Entry> &entries,
+            const std::string &description,
+            const std::chrono::system_clock::time_point &timestamp,
+            const std::shared_ptr<Arena> &arena);
 
-        std::string id_;
-        std::string transactionId_;
-        std::vector<Entry> entries_;
-        std::string description_;
+        std::uint64_t id_;
+        std::pmr::string transactionId_;
+        std::pmr::vector<Entry> entries_;
+        std::pmr::string description_;
         std::chrono::system_clock::time_point timestamp_;
     };
 
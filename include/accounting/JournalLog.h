@@ -0,0 +1,149 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "accounting/JournalEntry.h"
+#include "utils/Arena.h"
+
+namespace market
+{
+    namespace accounting
+    {
+        class Journal;
+        class Ledger;
+
+        // Group commit settings. Records appended while a sync is in flight
+        // always go out together in the next one; maxDelay additionally
+        // holds a sync back to let a group build up, unless it already has
+        // maxRecords records or maxBytes bytes.
+        struct JournalLogOptions
+        {
+            std::size_t maxRecords = 1024;
+            std::size_t maxBytes = 1 << 20;
+            std::chrono::microseconds maxDelay{0};
+        };
+
+        // Append-only, checksummed log of journal entries. After an 8-byte
+        // header ("MJNL", u32 version) the file is a sequence of records
+        //
+        //     [u32 length][u32 crc32 of payload][payload]
+        //
+        // all little-endian, where the payload is the entry's EntryCodec
+        // message. A record counts once its payload is complete and its
+        // checksum matches. A crash can only tear the last record, so a
+        // damaged record with no complete record anywhere after it (cut
+        // short, failing its checksum, or not decoding, like a zero-filled
+        // tail) is cut off when the log is reopened; damage with a complete
+        // record after it means the file is damaged.
+        //
+        // A background thread writes buffered records and fdatasyncs them, so
+        // concurrent appenders share one sync.
+        class JournalLog
+        {
+        public:
+            // Called with each entry read back while the log is opened
+            using Replayer = std::function<void(std::shared_ptr<JournalEntry>)>;
+
+            // Opens or creates the log at path; a new log is durable, along
+            // with its directory entry, by the time this returns. An existing
+            // log is read from start to end first, passing every entry to
+            // replay (restored in arena, when given) before a torn tail is
+            // truncated. Throws std::runtime_error if the file cannot be
+            // used, including when a record other than the last fails its
+            // checksum; the file is then left as it was.
+            static std::shared_ptr<JournalLog> create(
+                const std::string &path,
+                const Replayer &replay = nullptr,
+                const JournalLogOptions &options = JournalLogOptions(),
+                const std::shared_ptr<Arena> &arena = nullptr);
+
+            // Opens the log at path, replays it into journal and, when given,
+            // posts the replayed entries to ledger, then attaches the log to
+            // journal so later entries are logged too
+            static std::shared_ptr<JournalLog> recover(
+                const std::string &path,
+                Journal &journal,
+                Ledger *ledger = nullptr,
+                const JournalLogOptions &options = JournalLogOptions());
+
+            // Syncs whatever is still buffered and closes the file
+            ~JournalLog();
+
+            JournalLog(const JournalLog &) = delete;
+            JournalLog &operator=(const JournalLog &) = delete;
+
+            // Buffers entry and returns its log sequence number, without
+            // waiting for it to reach disk. Blocks while maxBytes are already
+            // waiting, so appenders cannot outrun the disk indefinitely.
+            std::uint64_t append(const JournalEntry &entry);
+
+            // Returns once the record numbered lsn and all before it are on
+            // disk. Throws std::runtime_error if writing the log failed.
+            void waitDurable(std::uint64_t lsn);
+
+            // Appends and waits for the record to be durable
+            void write(const JournalEntry &entry) { waitDurable(append(entry)); }
+
+            // Waits until everything appended so far is durable
+            void sync();
+
+            const std::string &getPath() const { return path_; }
+            std::uint64_t getDurableLsn() const;
+
+            // What opening the log found
+            std::size_t getReplayedCount() const { return replayed_; }
+            std::uint64_t getTruncatedBytes() const { return truncated_; }
+
+        private:
+            static constexpr char MAGIC[4] = {'M', 'J', 'N', 'L'};
+            static constexpr std::uint32_t VERSION = 2;
+            static constexpr std::size_t HEADER_SIZE = 8;
+            static constexpr std::size_t RECORD_HEADER_SIZE = 8;
+
+            JournalLog(const std::string &path, int fd, const JournalLogOptions &options);
+
+            // Reads every complete record of a size-byte file, returning the
+            // offset just past the last one
+            std::uint64_t replay(const Replayer &replay, const std::shared_ptr<Arena> &arena, std::uint64_t size);
+
+            // Whether a complete, checksummed record of at least one byte
+            // starts anywhere after the damaged one at start. Scans the mapped
+            // file, so it is only called once replay has found damage.
+            bool recordFollows(std::uint64_t start, std::uint64_t size) const;
+            std::runtime_error corruptRecord(std::uint64_t start) const;
+
+            static void encode(const JournalEntry &entry, std::string &out);
+
+            void flusherLoop();
+
+            std::string path_;
+            int fd_;
+            JournalLogOptions options_;
+            std::size_t replayed_;
+            std::uint64_t truncated_;
+
+            mutable std::mutex mutex_;
+            std::condition_variable pending_;  // Signals the flusher
+            std::condition_variable durable_;  // Signals appenders and waiters
+            std::vector<char> buffer_;         // Records not yet handed to the flusher
+            std::size_t bufferedRecords_;
+            std::chrono::steady_clock::time_point firstBuffered_;
+            std::uint64_t appendedLsn_;
+            std::uint64_t durableLsn_;
+            bool syncRequested_;
+            bool stopping_;
+            std::string error_;
+            std::thread flusher_;
+        };
+
+    } // namespace accounting
+} // namespace market
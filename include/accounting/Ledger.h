@@ -1,14 +1,26 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <chrono>
-#include <unordered_map>
+#include <cstdint>
+#include <iterator>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <utility>
 #include "utils/Decimal.h"
 #include "utils/IDGenerator.h"
+#include "utils/Symbol.h"
+#include "utils/Span.h"
+#include "utils/Arena.h"
 #include "accounting/Journal.h"
 #include "accounting/EntryType.h"
+#include "accounting/LedgerSnapshotFile.h"
 
 namespace market
 {
@@ -26,60 +38,458 @@ namespace market
                 std::chrono::system_clock::time_point timestamp;
             };
 
+            // Allocates from arena when one is given
             static std::shared_ptr<LedgerEntry> create(
-                const std::string &accountId,
-                const std::string &journalEntryId,
+                Symbol accountId,
+                std::uint64_t journalEntryId,
                 market::accounting::EntryType type,
-                const Decimal &amount);
+                const Decimal &amount,
+                const std::shared_ptr<Arena> &arena = nullptr);
 
-            const std::string &getId() const { return id_; }
-            const std::string &getAccountId() const { return accountId_; }
-            const std::string &getJournalEntryId() const { return journalEntryId_; }
+            // Rebuilds an entry read back from storage with its original ID
+            // and timestamp; the ID counter skips past id
+            static std::shared_ptr<LedgerEntry> restore(
+                std::uint64_t id,
+                Symbol accountId,
+                std::uint64_t journalEntryId,
+                market::accounting::EntryType type,
+                const Decimal &amount,
+                const std::chrono::system_clock::time_point &timestamp,
+                const std::shared_ptr<Arena> &arena = nullptr);
+
+            std::string getId() const { return idGen_.format(id_); }
+            std::uint64_t getNumericId() const { return id_; }
+            Symbol getAccountId() const { return accountId_; }
+            // Numeric ID of the journal entry; see JournalEntry::formatId
+            std::uint64_t getJournalEntryId() const { return journalEntryId_; }
             market::accounting::EntryType getType() const { return type_; }
             const Decimal &getAmount() const { return amount_; }
             const std::chrono::system_clock::time_point &getTimestamp() const { return timestamp_; }
 
         private:
+            friend class Ledger;
             static IDGenerator idGen_;
             LedgerEntry(
-                const std::string &id,
-                const std::string &accountId,
-                const std::string &journalEntryId,
+                std::uint64_t id,
+                Symbol accountId,
+                std::uint64_t journalEntryId,
                 market::accounting::EntryType type,
-                const Decimal &amount);
+                const Decimal &amount,
+                const std::chrono::system_clock::time_point &timestamp);
 
-            std::string id_;
-            std::string accountId_;
-            std::string journalEntryId_;
+            // Throws std::invalid_argument for a missing ID or non-positive amount
+            static void validate(Symbol accountId, std::uint64_t journalEntryId, const Decimal &amount);
+            static std::shared_ptr<LedgerEntry> make(
+                std::uint64_t id,
+                Symbol accountId,
+                std::uint64_t journalEntryId,
+                market::accounting::EntryType type,
+                const Decimal &amount,
+                const std::chrono::system_clock::time_point &timestamp,
+                const std::shared_ptr<Arena> &arena);
+
+            // Plain values only: an entry is a small record that the Ledger
+            // copies into its columns and rebuilds from them on read.
+            std::uint64_t id_;
+            Symbol accountId_;
+            std::uint64_t journalEntryId_;
             market::accounting::EntryType type_;
             Decimal amount_;
             std::chrono::system_clock::time_point timestamp_;
         };
 
-        class Ledger
+        class Ledger : public std::enable_shared_from_this<Ledger>
         {
+            struct AccountColumns;
+
         public:
+            // Accounts are partitioned across this many independently locked
+            // shards, so threads posting to different accounts rarely contend
+            static constexpr std::size_t SHARD_COUNT = 16;
+
+            // Raw columns of a run of one account's entries, in timestamp
+            // order: ids, signed raw amounts (debits positive), system_clock
+            // ticks and numeric journal entry IDs. Suited to BalanceKernel.
+            struct ColumnView
+            {
+                Span<const std::uint64_t> ids;
+                Span<const std::int64_t> amounts;
+                Span<const std::int64_t> timestamps;
+                Span<const std::uint64_t> journalEntries;
+            };
+
+            // Contiguous run of one account's entries, in timestamp order.
+            // Iterating yields LedgerEntry values rebuilt from the columns.
+            // Only a Snapshot hands these out: the range points into the
+            // account's columns, which a posting can move, so it is valid
+            // only while the snapshot it came from is alive.
+            class EntryRange
+            {
+            public:
+                class const_iterator
+                {
+                public:
+                    using iterator_category = std::input_iterator_tag;
+                    using value_type = LedgerEntry;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = LedgerEntry;
+
+                    const_iterator() = default;
+                    const_iterator(Symbol accountId, const AccountColumns *columns, std::size_t index)
+                        : accountId_(accountId), columns_(columns), index_(index) {}
+
+                    LedgerEntry operator*() const;
+                    const_iterator &operator++()
+                    {
+                        ++index_;
+                        return *this;
+                    }
+                    const_iterator operator++(int)
+                    {
+                        const_iterator previous = *this;
+                        ++index_;
+                        return previous;
+                    }
+                    bool operator==(const const_iterator &other) const { return index_ == other.index_ && columns_ == other.columns_; }
+                    bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+                private:
+                    Symbol accountId_;
+                    const AccountColumns *columns_ = nullptr;
+                    std::size_t index_ = 0;
+                };
+
+                EntryRange() = default;
+                EntryRange(Symbol accountId, const AccountColumns *columns, std::size_t first, std::size_t last)
+                    : accountId_(accountId), columns_(columns), first_(first), last_(last) {}
+
+                const_iterator begin() const { return const_iterator(accountId_, columns_, first_); }
+                const_iterator end() const { return const_iterator(accountId_, columns_, last_); }
+                std::size_t size() const { return last_ - first_; }
+                bool empty() const { return first_ == last_; }
+                ColumnView columns() const;
+
+            private:
+                Symbol accountId_;
+                const AccountColumns *columns_ = nullptr;
+                std::size_t first_ = 0;
+                std::size_t last_ = 0;
+            };
+
+            // Consistent read-only view of the whole ledger. Holds a shared
+            // lock on every shard, so postings wait until it is destroyed and
+            // each journal entry is seen either completely or not at all.
+            // Ranges taken from it stay valid for its lifetime.
+            //
+            // The thread holding a snapshot must not post to the ledger, nor
+            // call the Ledger's own reads (getBalance, getEntries,
+            // forEachEntry): those lock the shard again, std::shared_mutex is
+            // not recursive, and a posting queued in between deadlocks them.
+            // Read through the snapshot instead.
+            class Snapshot
+            {
+            public:
+                // Every account with at least one entry, in no particular order
+                std::vector<Symbol> getAccountIds() const;
+
+                Decimal getBalance(Symbol accountId) const;
+                Decimal getBalance(Symbol accountId, const std::chrono::system_clock::time_point &asOf) const;
+                EntryRange getEntryRange(Symbol accountId) const;
+
+                // By name, without interning it; an unknown account has no entries
+                Decimal getBalance(std::string_view accountId) const { return getBalance(Symbol::find(accountId)); }
+                Decimal getBalance(std::string_view accountId, const std::chrono::system_clock::time_point &asOf) const
+                {
+                    return getBalance(Symbol::find(accountId), asOf);
+                }
+                EntryRange getEntryRange(std::string_view accountId) const { return getEntryRange(Symbol::find(accountId)); }
+
+                EntryRange getEntryRange(
+                    Symbol accountId,
+                    const std::chrono::system_clock::time_point &start,
+                    const std::chrono::system_clock::time_point &end) const;
+
+                // Sequence number of the last posting the snapshot includes
+                std::uint64_t getSequence() const { return sequence_; }
+
+            private:
+                friend class Ledger;
+                explicit Snapshot(const Ledger &ledger);
+
+                const Ledger *ledger_;
+                std::array<std::shared_lock<std::shared_mutex>, SHARD_COUNT> locks_;
+                std::uint64_t sequence_;
+            };
+
+            // One line of a posting, as delivered to subscribers
+            struct Posting
+            {
+                Symbol accountId;
+                std::int64_t amount; // raw Decimal, positive for debits
+                std::chrono::system_clock::time_point timestamp;
+            };
+
+            // The lines applied atomically by one addEntry or one journal
+            // entry. Sequence numbers count postings from 1; a snapshot
+            // includes exactly the postings up to its getSequence().
+            struct PostingEvent
+            {
+                std::uint64_t sequence;
+                Span<const Posting> lines;
+            };
+
+            using Listener = std::function<void(const PostingEvent &)>;
+
+            // Keeps a listener registered until it is reset or destroyed.
+            // Does not keep the ledger alive.
+            class Subscription
+            {
+            public:
+                Subscription() = default;
+                Subscription(Subscription &&other) noexcept;
+                Subscription &operator=(Subscription &&other) noexcept;
+                Subscription(const Subscription &) = delete;
+                Subscription &operator=(const Subscription &) = delete;
+                ~Subscription() { reset(); }
+
+                void reset();
+                explicit operator bool() const { return id_ != 0; }
+
+            private:
+                friend class Ledger;
+                Subscription(std::weak_ptr<Ledger> ledger, std::uint64_t id)
+                    : ledger_(std::move(ledger)), id_(id) {}
+
+                std::weak_ptr<Ledger> ledger_;
+                std::uint64_t id_ = 0;
+            };
+
             static std::shared_ptr<Ledger> create(const std::string &name);
 
+            // Opens a file written by writeSnapshot without reading its
+            // entries: each account's columns stay in the read-only mapping
+            // until the account is next posted to, when they are copied into
+            // memory. New postings get sequence numbers and entry IDs after
+            // the snapshot's.
+            static std::shared_ptr<Ledger> openSnapshot(const std::string &path);
+
+            // Writes a consistent image of the ledger; see LedgerSnapshotFile.
+            // Postings wait while the accounts are being written.
+            void writeSnapshot(const std::string &path) const;
+
+            // All postings and reads below are thread-safe. A posting locks
+            // the shards of every account it touches, so concurrent readers
+            // never see part of a journal entry.
+
             void addEntry(std::shared_ptr<LedgerEntry> entry);
-            Decimal getBalance(const std::string &accountId) const;
-            Decimal getBalance(const std::string &accountId, const std::chrono::system_clock::time_point &asOf) const;
-            std::vector<std::shared_ptr<LedgerEntry>> getEntries(const std::string &accountId) const;
-            std::vector<std::shared_ptr<LedgerEntry>> getEntries(
-                const std::string &accountId,
+            void addEntry(const LedgerEntry &entry);
+
+            // Posts every line of a journal entry, stamped with the journal
+            // entry's timestamp. Lines are validated before any is appended,
+            // so a rejected entry leaves the ledger unchanged.
+            void post(const JournalEntry &entry);
+
+            // Posts a batch of journal entries: validates the whole batch up
+            // front, grows each account's columns once, then appends every
+            // line in a single pass. Each journal entry is applied
+            // atomically; the batch as a whole is not.
+            void postBatch(Span<const std::shared_ptr<JournalEntry>> entries);
+
+            Decimal getBalance(Symbol accountId) const;
+            Decimal getBalance(Symbol accountId, const std::chrono::system_clock::time_point &asOf) const;
+            std::vector<LedgerEntry> getEntries(Symbol accountId) const;
+            std::vector<LedgerEntry> getEntries(
+                Symbol accountId,
                 const std::chrono::system_clock::time_point &start,
                 const std::chrono::system_clock::time_point &end) const;
 
+            // By name, without interning it; an unknown account has no entries
+            Decimal getBalance(std::string_view accountId) const { return getBalance(Symbol::find(accountId)); }
+            Decimal getBalance(std::string_view accountId, const std::chrono::system_clock::time_point &asOf) const
+            {
+                return getBalance(Symbol::find(accountId), asOf);
+            }
+            std::vector<LedgerEntry> getEntries(std::string_view accountId) const { return getEntries(Symbol::find(accountId)); }
+
+            Snapshot snapshot() const { return Snapshot(*this); }
+
+            // Calls listener after every posting. It runs on the posting
+            // thread once the posting's shards are unlocked, so it may read
+            // the ledger; events from different threads can arrive out of
+            // sequence order. A listener that has already been copied for
+            // delivery may still run once after its subscription is reset.
+            Subscription subscribe(Listener listener);
+
+            // Visitors: call fn(const LedgerEntry&) for each of the account's
+            // entries in timestamp order, without building a vector. The
+            // account's shard stays read-locked while fn runs, so fn must not
+            // post to this ledger.
+            template <typename Fn>
+            void forEachEntry(Symbol accountId, Fn &&fn) const
+            {
+                std::shared_lock<std::shared_mutex> lock(shards_[shardOf(accountId)].mutex);
+                for (const LedgerEntry &entry : rangeOf(accountId, findAccount(accountId)))
+                {
+                    fn(entry);
+                }
+            }
+
+            template <typename Fn>
+            void forEachEntry(std::string_view accountId, Fn &&fn) const
+            {
+                forEachEntry(Symbol::find(accountId), std::forward<Fn>(fn));
+            }
+
+            template <typename Fn>
+            void forEachEntry(
+                Symbol accountId,
+                const std::chrono::system_clock::time_point &start,
+                const std::chrono::system_clock::time_point &end,
+                Fn &&fn) const
+            {
+                std::shared_lock<std::shared_mutex> lock(shards_[shardOf(accountId)].mutex);
+                for (const LedgerEntry &entry : rangeOf(accountId, findAccount(accountId), start, end))
+                {
+                    fn(entry);
+                }
+            }
+
             const std::string &getName() const { return name_; }
             const std::string &getId() const { return id_; }
 
         private:
+            // Column that can start out as a view of a mapped snapshot; the
+            // first call to own() copies it into memory so it can be changed
+            template <typename T>
+            class Column
+            {
+            public:
+                const T *data() const { return mapped_ ? view_.data() : values_.data(); }
+                std::size_t size() const { return mapped_ ? view_.size() : values_.size(); }
+                bool empty() const { return size() == 0; }
+                const T *begin() const { return data(); }
+                const T *end() const { return data() + size(); }
+                const T &operator[](std::size_t index) const { return data()[index]; }
+                const T &back() const { return data()[size() - 1]; }
+
+                void map(Span<const T> view)
+                {
+                    values_.clear();
+                    view_ = view;
+                    mapped_ = true;
+                }
+
+                std::vector<T> &own()
+                {
+                    if (mapped_)
+                    {
+                        values_.assign(view_.begin(), view_.end());
+                        view_ = {};
+                        mapped_ = false;
+                    }
+                    return values_;
+                }
+
+            private:
+                std::vector<T> values_;
+                Span<const T> view_;
+                bool mapped_ = false;
+            };
+
+            // Entries of one account stored column by column, in timestamp
+            // order, so balance and range scans stream through contiguous
+            // arrays. amounts holds raw Decimal values, positive for debits
+            // and negative for credits; timestamps holds system_clock ticks;
+            // cumulative[i] is the raw balance after entry i.
+            // debits/credits are running totals kept by append.
+            struct AccountColumns
+            {
+                Column<std::uint64_t> ids;
+                Column<std::int64_t> amounts;
+                Column<std::int64_t> timestamps;
+                Column<std::int64_t> cumulative;
+                Column<std::uint64_t> journalEntries;
+                Decimal debits;
+                Decimal credits;
+            };
+
+            struct Shard
+            {
+                mutable std::shared_mutex mutex;
+                SymbolMap<AccountColumns> accounts;
+            };
+
+            // Holds exclusive locks on a set of shards, taken in index order
+            // so that concurrent postings cannot deadlock
+            class ShardGuard
+            {
+            public:
+                ShardGuard(const Ledger &ledger, std::uint32_t shards);
+                ~ShardGuard();
+                ShardGuard(const ShardGuard &) = delete;
+                ShardGuard &operator=(const ShardGuard &) = delete;
+
+            private:
+                const Ledger &ledger_;
+                std::uint32_t shards_;
+            };
+            static_assert(SHARD_COUNT <= 32, "shard sets are 32-bit masks");
+
+            using ListenerList = std::vector<std::pair<std::uint64_t, std::shared_ptr<const Listener>>>;
+
             static IDGenerator idGen_;
             Ledger(const std::string &id, const std::string &name);
 
+            // Called with the posting's shards locked
+            std::uint64_t nextSequence() { return sequence_.fetch_add(1, std::memory_order_relaxed) + 1; }
+            void notify(std::uint64_t sequence, const JournalEntry &entry) const;
+            void notify(const PostingEvent &event) const;
+            void unsubscribe(std::uint64_t id);
+
+            static std::size_t shardOf(Symbol accountId) { return accountId.getId() % SHARD_COUNT; }
+            static std::uint32_t shardsOf(const JournalEntry &entry);
+            const AccountColumns *findAccount(Symbol accountId) const
+            {
+                return shards_[shardOf(accountId)].accounts.find(accountId);
+            }
+            AccountColumns &account(Symbol accountId) { return shards_[shardOf(accountId)].accounts[accountId]; }
+
+            // Unlocked reads shared by Ledger and Snapshot
+            static Decimal balanceOf(const AccountColumns *account);
+            static Decimal balanceOf(const AccountColumns *account, const std::chrono::system_clock::time_point &asOf);
+            static EntryRange rangeOf(Symbol accountId, const AccountColumns *account);
+            static EntryRange rangeOf(
+                Symbol accountId,
+                const AccountColumns *account,
+                const std::chrono::system_clock::time_point &start,
+                const std::chrono::system_clock::time_point &end);
+
+            static void validate(const JournalEntry &entry);
+            static void reserve(AccountColumns &account, std::size_t additional);
+            static void append(
+                AccountColumns &account,
+                std::uint64_t id,
+                std::uint64_t journalEntryId,
+                EntryType type,
+                const Decimal &amount,
+                std::int64_t timestamp);
+            void appendLines(const JournalEntry &entry);
+            static std::vector<LedgerEntry> collect(const EntryRange &range);
+
             std::string id_;
             std::string name_;
-            std::unordered_map<std::string, std::vector<std::shared_ptr<LedgerEntry>>> accountEntries_;
+            // Keeps the mapping that opened accounts still point into
+            std::shared_ptr<const LedgerSnapshotFile> snapshotFile_;
+            std::array<Shard, SHARD_COUNT> shards_;
+            std::atomic<std::uint64_t> sequence_{0};
+
+            // Copy-on-write, so notifying never holds the lock while
+            // listeners run
+            mutable std::mutex listenersMutex_;
+            std::shared_ptr<const ListenerList> listeners_;
+            std::atomic<bool> hasListeners_{false};
+            std::uint64_t nextListenerId_ = 0;
         };
 
     } // namespace accounting
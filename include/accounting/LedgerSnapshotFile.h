@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utils/Decimal.h"
+#include "utils/MappedFile.h"
+#include "utils/Span.h"
+#include "utils/Symbol.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        // Columnar image of a ledger, laid out so that it can be used straight
+        // from a read-only mapping. Every reference inside the file is a byte
+        // offset from its start, so the mapping can land anywhere; columns
+        // are 8-byte aligned arrays in host byte order, which the header
+        // records and open() checks.
+        //
+        //     header        magic "MLSN", version, byte order, clock period,
+        //                   ledger sequence, highest ledger entry ID, offsets
+        //     columns       per account: ids, amounts, timestamps,
+        //                   cumulative balances, journal entry IDs
+        //     accounts      one fixed-size record per account
+        //     strings       u64 offsets[count + 1], then the bytes; holds the
+        //                   ledger name and account IDs
+        //
+        // Symbols are process-local, so the file refers to every name by
+        // string index; callers intern them when they need them.
+        class LedgerSnapshotFile
+        {
+        public:
+            // One account's columns, viewed in the mapping
+            struct Account
+            {
+                std::string_view accountId;
+                Decimal debits;
+                Decimal credits;
+                Span<const std::uint64_t> ids;
+                Span<const std::int64_t> amounts;
+                Span<const std::int64_t> timestamps;
+                Span<const std::int64_t> cumulative;
+                Span<const std::uint64_t> journalEntries;
+            };
+
+            // Writes a snapshot to a temporary file next to path and renames
+            // it into place once it is synced, so readers only ever see a
+            // complete file
+            class Writer
+            {
+            public:
+                Writer(const std::string &path, const std::string &ledgerName, std::uint64_t sequence);
+                ~Writer();
+
+                Writer(const Writer &) = delete;
+                Writer &operator=(const Writer &) = delete;
+
+                // Columns are written out immediately; nothing is kept but the
+                // account's record and the names it refers to
+                void addAccount(
+                    Symbol accountId,
+                    Decimal debits,
+                    Decimal credits,
+                    Span<const std::uint64_t> ids,
+                    Span<const std::int64_t> amounts,
+                    Span<const std::int64_t> timestamps,
+                    Span<const std::int64_t> cumulative,
+                    Span<const std::uint64_t> journalEntries);
+
+                // Throws std::runtime_error on any I/O failure, including a
+                // failure to sync the directory after the rename
+                void commit();
+
+            private:
+                struct Output;
+
+                // text must outlive the writer
+                std::uint32_t addString(std::string_view text);
+
+                std::string path_;
+                std::string ledgerName_;
+                std::unique_ptr<Output> out_;
+                std::uint64_t sequence_;
+                std::uint64_t maxEntryId_;
+                std::uint32_t nameString_;
+                std::vector<char> accounts_;
+                std::vector<std::string_view> strings_;
+            };
+
+            // Maps the file read-only and checks its header and the bounds of
+            // every column. Throws std::runtime_error for a file that is not a
+            // usable snapshot.
+            static std::shared_ptr<LedgerSnapshotFile> open(const std::string &path);
+
+            std::uint32_t getVersion() const { return version_; }
+            std::string_view getLedgerName() const { return getString(nameString_); }
+            std::uint64_t getSequence() const { return sequence_; }
+            std::uint64_t getMaxEntryId() const { return maxEntryId_; }
+            std::size_t getAccountCount() const { return accountCount_; }
+            Account getAccount(std::size_t index) const;
+            std::string_view getString(std::uint32_t index) const;
+
+        private:
+            LedgerSnapshotFile(std::shared_ptr<MappedFile> file);
+
+            std::shared_ptr<MappedFile> file_;
+            std::uint32_t version_ = 0;
+            std::uint64_t sequence_ = 0;
+            std::uint64_t maxEntryId_ = 0;
+            std::size_t accountCount_ = 0;
+            std::uint32_t nameString_ = 0;
+            const char *accounts_ = nullptr;
+            const std::uint64_t *stringOffsets_ = nullptr;
+            std::uint64_t stringCount_ = 0;
+            const char *stringData_ = nullptr;
+        };
+
+    } // namespace accounting
+} // namespace market
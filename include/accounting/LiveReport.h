@@ -0,0 +1,133 @@
+#pragma once
+
+#include "accounting/IReport.h"
+#include "accounting/Ledger.h"
+#include "accounting/BalanceCache.h"
+#include "accounting/ReportSection.h"
+#include "utils/Symbol.h"
+#include "utils/ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace market
+{
+    namespace accounting
+    {
+
+        // Base of the reports that can follow their ledger as it is posted
+        // to. It owns the subscription and the mutex guarding the report's
+        // balances; a subclass only says how its sections are loaded and
+        // which posting lines touch them.
+        class LiveReport : public IReport, public std::enable_shared_from_this<LiveReport>
+        {
+        public:
+            // Ignored while live updates are on; the report is already current
+            void compute(const BalanceCache &balances) override;
+
+            // Subscribes to the ledger and applies every new posting to the
+            // affected balances and totals as it happens. Lines are rebuilt
+            // lazily, the next time they are asked for.
+            void enableLiveUpdates();
+            void disableLiveUpdates();
+            bool isLive() const;
+
+        protected:
+            LiveReport(std::shared_ptr<Ledger> ledger, std::shared_ptr<ThreadPool> pool);
+
+            // Resolves this report's own balances and computes it
+            void compute();
+
+            // Both called with mutex_ held. loadSections reads every balance
+            // the report lists; applyLine adds a posting's raw delta and
+            // returns false if the report does not list the account.
+            virtual void loadSections(const BalanceCache &balances) = 0;
+            virtual bool applyLine(Symbol accountId, std::int64_t delta) = 0;
+
+            std::shared_ptr<Ledger> ledger_;
+            std::shared_ptr<ThreadPool> pool_;
+
+            mutable std::mutex mutex_;
+            // Set whenever the balances change; lines are rebuilt from them
+            // on the next request
+            mutable bool linesStale_;
+
+        private:
+            void load(const BalanceCache &balances);
+            void apply(const Ledger::PostingEvent &event);
+
+            Ledger::Subscription subscription_;
+            // Postings up to this sequence number are already in the totals
+            std::uint64_t sequence_;
+        };
+
+        // Base of the statements made of two sections, the first counting
+        // only accounts with a positive balance and the second only those
+        // with a negative one, both reported as positive amounts: revenue
+        // and expenses, or cash inflows and outflows. A subclass names the
+        // sections and their totals.
+        class SignedStatement : public LiveReport
+        {
+        public:
+            struct AccountLine
+            {
+                Symbol accountId;
+                std::string accountName;
+                Decimal amount;
+            };
+
+            void write(ReportWriter &writer) const override;
+            void collectBalanceRequests(BalanceCache &balances) const override;
+
+        protected:
+            // Headings written by write()
+            struct Titles
+            {
+                const char *report;
+                const char *positiveSection;
+                const char *positiveTotal;
+                const char *negativeSection;
+                const char *negativeTotal;
+                const char *net;
+            };
+
+            SignedStatement(
+                std::shared_ptr<Ledger> ledger,
+                const std::vector<std::pair<std::string, std::string>> &positiveAccounts,
+                const std::vector<std::pair<std::string, std::string>> &negativeAccounts,
+                const Titles &titles,
+                std::shared_ptr<ThreadPool> pool);
+
+            Decimal getPositiveTotal() const;
+            Decimal getNegativeTotal() const;
+            // Positive total less negative total
+            Decimal getNet() const;
+
+            // Copies taken under the report's lock, so they stay valid while
+            // live updates go on
+            std::vector<AccountLine> getPositiveLines() const;
+            std::vector<AccountLine> getNegativeLines() const;
+
+        private:
+            void loadSections(const BalanceCache &balances) override;
+            bool applyLine(Symbol accountId, std::int64_t delta) override;
+            void buildLines() const;
+            // Lines for the accounts of a section whose balance has the
+            // given sign, reported as positive amounts
+            std::vector<AccountLine> buildLines(const ReportSection &section, bool positive) const;
+            // Rows from balances, a copy of the section's own
+            static void writeSection(ReportWriter &writer, const ReportSection &section, const std::vector<std::int64_t> &balances, bool positive);
+
+            ReportSection positiveAccounts_;
+            ReportSection negativeAccounts_;
+            Titles titles_;
+
+            mutable std::vector<AccountLine> positiveLines_;
+            mutable std::vector<AccountLine> negativeLines_;
+        };
+
+    } // namespace accounting
+} // namespace market
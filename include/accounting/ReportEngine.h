@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "accounting/IReport.h"
+#include "accounting/Ledger.h"
+#include "accounting/BalanceCache.h"
+#include "accounting/TrialBalance.h"
+#include "accounting/IncomeStatement.h"
+#include "accounting/CashFlowStatement.h"
+#include "utils/ThreadPool.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        // Computes a set of reports over one ledger in a single pass: the
+        // balances all reports need are collected, each distinct
+        // (account, asOf) pair is read once from one snapshot, and the
+        // results are fanned out to every report.
+        class ReportEngine
+        {
+        public:
+            static std::shared_ptr<ReportEngine> create(
+                std::shared_ptr<Ledger> ledger,
+                std::shared_ptr<ThreadPool> pool = nullptr);
+
+            // Reports created here stay empty until the next run()
+            std::shared_ptr<TrialBalance> addTrialBalance(
+                const std::vector<std::pair<std::string, std::string>> &accountNames,
+                bool showEmptyAccounts = false);
+            std::shared_ptr<IncomeStatement> addIncomeStatement(
+                const std::vector<std::pair<std::string, std::string>> &revenueAccounts,
+                const std::vector<std::pair<std::string, std::string>> &expenseAccounts,
+                bool showEmptyAccounts = false);
+            std::shared_ptr<CashFlowStatement> addCashFlowStatement(
+                const std::vector<std::pair<std::string, std::string>> &inflowAccounts,
+                const std::vector<std::pair<std::string, std::string>> &outflowAccounts,
+                bool showEmptyAccounts = false);
+
+            // Adds a report built elsewhere, such as a BalanceSheet. It must
+            // read from this engine's ledger and is recomputed by run().
+            void addReport(IReportPtr report);
+
+            void run();
+
+            const std::vector<IReportPtr> &getReports() const { return reports_; }
+
+            // Distinct balances read from the ledger by the last run()
+            std::size_t getBalanceCount() const { return balanceCount_; }
+
+        private:
+            ReportEngine(std::shared_ptr<Ledger> ledger, std::shared_ptr<ThreadPool> pool);
+
+            std::shared_ptr<Ledger> ledger_;
+            std::shared_ptr<ThreadPool> pool_;
+            std::vector<IReportPtr> reports_;
+            std::size_t balanceCount_;
+        };
+
+    } // namespace accounting
+} // namespace market
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include "utils/Symbol.h"
+#include "utils/ThreadPool.h"
+#include "accounting/BalanceCache.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        // Balances behind one list of report accounts: the raw current
+        // balance of every listed account and the sums of the positive and
+        // of the negative ones. Loaded in full from a BalanceCache, then
+        // kept current by applying posting deltas in O(1) per account.
+        class ReportSection
+        {
+        public:
+            ReportSection() = default;
+            explicit ReportSection(const std::vector<std::pair<std::string, std::string>> &accounts);
+
+            const std::vector<std::pair<Symbol, std::string>> &getAccounts() const { return accounts_; }
+            std::int64_t getPositiveTotal() const { return positive_; }
+            std::int64_t getNegativeTotal() const { return negative_; }
+
+            void request(BalanceCache &balances) const;
+
+            // Reads every balance from a resolved cache and recomputes the
+            // totals, in parallel chunks when a pool is given
+            void load(const BalanceCache &balances, ThreadPool *pool);
+
+            // Adds a raw delta to each occurrence of accountId; returns false
+            // when the section does not list the account
+            bool apply(Symbol accountId, std::int64_t delta);
+
+            // Raw balance of every account, in account order. The account
+            // list itself never changes after construction.
+            const std::vector<std::int64_t> &getBalances() const { return balances_; }
+
+            // Builds report lines in account order. add(lines, index, balance)
+            // appends the line for accounts_[index], if it has one.
+            template <typename Line, typename Add>
+            std::vector<Line> buildLines(ThreadPool *pool, Add add) const
+            {
+                std::vector<std::vector<Line>> chunkLines(ThreadPool::chunkCount(accounts_.size(), ThreadPool::ACCOUNT_GRAIN));
+                ThreadPool::parallelFor(pool, accounts_.size(), ThreadPool::ACCOUNT_GRAIN, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                                        {
+                    for (std::size_t i = begin; i < end; ++i)
+                    {
+                        add(chunkLines[chunk], i, balances_[i]);
+                    } });
+
+                std::vector<Line> lines;
+                for (auto &chunk : chunkLines)
+                {
+                    lines.insert(lines.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+                }
+                return lines;
+            }
+
+        private:
+            std::vector<std::pair<Symbol, std::string>> accounts_;
+            std::vector<std::int64_t> balances_;
+            // Where each account appears in accounts_; a list may repeat one
+            SymbolMap<std::vector<std::size_t>> positions_;
+            std::int64_t positive_ = 0;
+            std::int64_t negative_ = 0;
+        };
+
+    } // namespace accounting
+} // namespace market
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "utils/Decimal.h"
+#include "utils/Symbol.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        enum class ReportFormat
+        {
+            TEXT,       // Fixed-width table, as printed by IReport::generate
+            CSV,        // One header line, then one line per row or total
+            JSON_LINES, // One JSON object per line
+            BINARY      // Length-prefixed records with raw Decimal values
+        };
+
+        // Receives a report one record at a time, so rows can be emitted as
+        // they are read instead of being collected first. A report is
+        // beginReport(), any mix of rows, sections and totals, then
+        // endReport(). Output goes through a fixed buffer and amounts are
+        // formatted with Decimal::toChars, so records do not allocate.
+        class ReportWriter
+        {
+        public:
+            static std::shared_ptr<ReportWriter> create(ReportFormat format, std::ostream &out);
+
+            // Flushes whatever is still buffered. Errors are swallowed here,
+            // so call flush() first to find out about them.
+            virtual ~ReportWriter();
+
+            ReportWriter(const ReportWriter &) = delete;
+            ReportWriter &operator=(const ReportWriter &) = delete;
+
+            // columns names the amounts carried by every row and total of
+            // the report; each of those throws std::invalid_argument when
+            // given a different number of amounts
+            void beginReport(std::string_view title, std::initializer_list<std::string_view> columns);
+            void row(Symbol accountId, std::string_view accountName, std::initializer_list<Decimal> amounts);
+
+            // Rows between beginSection and endSection belong to the section;
+            // endSection writes its total
+            void beginSection(std::string_view name);
+            void endSection(std::string_view label, std::initializer_list<Decimal> totals);
+
+            // A total outside any section, such as net income
+            void total(std::string_view label, std::initializer_list<Decimal> amounts);
+
+            // A closing remark such as "BALANCED"
+            void status(std::string_view text);
+            void endReport();
+
+            // Writes everything buffered so far to the stream and flushes it.
+            // A full buffer is handed to the stream without flushing it, so
+            // the stream's own buffering still applies in between.
+            void flush();
+
+        protected:
+            static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+            explicit ReportWriter(std::ostream &out);
+
+            virtual void writeBeginReport(std::string_view title, std::initializer_list<std::string_view> columns) = 0;
+            virtual void writeRow(Symbol accountId, std::string_view accountName, std::initializer_list<Decimal> amounts) = 0;
+            virtual void writeBeginSection(std::string_view name) = 0;
+            virtual void writeEndSection(std::string_view label, std::initializer_list<Decimal> totals) = 0;
+            virtual void writeTotal(std::string_view label, std::initializer_list<Decimal> amounts) = 0;
+            virtual void writeStatus(std::string_view text) = 0;
+            virtual void writeEndReport() = 0;
+
+            // Section the current record belongs to; empty outside sections
+            const std::string &getSection() const { return section_; }
+            std::size_t getColumnCount() const { return columns_; }
+
+            void put(char c)
+            {
+                if (used_ == BUFFER_SIZE)
+                {
+                    spill();
+                }
+                buffer_[used_++] = c;
+            }
+            void put(std::string_view text)
+            {
+                if (text.size() <= BUFFER_SIZE - used_)
+                {
+                    std::memcpy(buffer_ + used_, text.data(), text.size());
+                    used_ += text.size();
+                    return;
+                }
+                putSlow(text);
+            }
+            void put(Decimal value);
+            void putSpaces(std::size_t count)
+            {
+                if (count <= BUFFER_SIZE - used_)
+                {
+                    std::memset(buffer_ + used_, ' ', count);
+                    used_ += count;
+                    return;
+                }
+                for (; count > 0; --count)
+                {
+                    put(' ');
+                }
+            }
+            void putUint32(std::uint32_t value);
+            void putInt64(std::int64_t value);
+
+        private:
+            // Hands the buffer to the stream without flushing the stream
+            void spill();
+            void putSlow(std::string_view text);
+            void checkAmounts(std::size_t count) const;
+
+            std::ostream &out_;
+            std::size_t columns_;
+            std::string section_;
+            std::size_t used_;
+            char buffer_[BUFFER_SIZE];
+        };
+
+        using ReportWriterPtr = std::shared_ptr<ReportWriter>;
+
+    } // namespace accounting
+} // namespace market
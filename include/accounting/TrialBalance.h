@@ -1,7 +1,7 @@
 #pragma once
 
-#include "accounting/IReport.h"
-#include "accounting/Ledger.h"
+#include "accounting/LiveReport.h"
+#include "accounting/ReportSection.h"
 #include <vector>
 #include <string>
 #include <memory>
@@ -11,37 +11,52 @@ namespace market
     namespace accounting
     {
 
-        class TrialBalance : public IReport
+        class TrialBalance : public LiveReport
         {
         public:
             struct AccountLine
             {
-                std::string accountId;
+                Symbol accountId;
                 std::string accountName;
                 Decimal debit;
                 Decimal credit;
             };
 
-            static std::shared_ptr<TrialBalance> create(std::shared_ptr<Ledger> ledger, const std::vector<std::pair<std::string, std::string>> &accountNames, bool showEmptyAccounts = false);
+            // With a pool, balances and lines are computed in parallel chunks
+            static std::shared_ptr<TrialBalance> create(
+                std::shared_ptr<Ledger> ledger,
+                const std::vector<std::pair<std::string, std::string>> &accountNames,
+                bool showEmptyAccounts = false,
+                std::shared_ptr<ThreadPool> pool = nullptr);
 
-            void generate(std::ostream &out) const override;
+            void write(ReportWriter &writer) const override;
             std::string getName() const override { return "Trial Balance"; }
-            bool isBalanced() const { return totalDebits_ == totalCredits_; }
-            Decimal getTotalDebits() const { return totalDebits_; }
-            Decimal getTotalCredits() const { return totalCredits_; }
-            const std::vector<AccountLine> &getLines() const { return lines_; }
+            void collectBalanceRequests(BalanceCache &balances) const override;
+
+            bool isBalanced() const;
+            Decimal getTotalDebits() const;
+            Decimal getTotalCredits() const;
+
+            // A copy taken under the report's lock, so it stays valid while
+            // live updates go on
+            std::vector<AccountLine> getLines() const;
 
         private:
-            TrialBalance(std::shared_ptr<Ledger> ledger, const std::vector<std::pair<std::string, std::string>> &accountNames, bool showEmptyAccounts);
-            void compute();
-
-            std::shared_ptr<Ledger> ledger_;
-            std::vector<std::pair<std::string, std::string>> accountNames_;
-            std::vector<AccountLine> lines_;
-            Decimal totalDebits_;
-            Decimal totalCredits_;
+            friend class ReportEngine;
+            TrialBalance(
+                std::shared_ptr<Ledger> ledger,
+                const std::vector<std::pair<std::string, std::string>> &accountNames,
+                bool showEmptyAccounts,
+                std::shared_ptr<ThreadPool> pool);
+            void loadSections(const BalanceCache &balances) override;
+            bool applyLine(Symbol accountId, std::int64_t delta) override;
+            void buildLines() const;
+
+            ReportSection accounts_;
             bool showEmptyAccounts_;
+
+            mutable std::vector<AccountLine> lines_;
         };
 
     } // namespace accounting
-} // namespace market
\ No newline at end of file
+} // namespace market
@@ -25,6 +25,10 @@ namespace market::contracts
 
         static std::shared_ptr<Contract> create(const std::string &type, std::shared_ptr<market::core::Account> party1, std::shared_ptr<market::core::Account> party2);
 
+        // Rebuilds a contract read back from storage with its original ID, in
+        // the DRAFT state with no terms; the ID counter skips past id
+        static std::shared_ptr<Contract> restore(const std::string &id, const std::string &type, std::shared_ptr<market::core::Account> party1, std::shared_ptr<market::core::Account> party2);
+
         const std::string &getId() const { return id_; }
         const std::string &getType() const { return type_; }
         std::shared_ptr<market::core::Account> getParty1() const { return party1_; }
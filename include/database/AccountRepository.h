@@ -1,12 +1,94 @@
 #pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include "database/Repository.h"
+#include "database/AccountStore.h"
 #include "core/Account.h"
 
-class AccountRepository : public Repository<Account>
+class ConnectionPool;
+
+// Write-back settings. Changes are flushed once flushBatchSize of them are
+// pending or flushInterval has passed since the last flush, whichever
+// comes first.
+struct AccountRepositoryOptions
+{
+    std::size_t cacheCapacity = 10000;
+    std::size_t flushBatchSize = 1000;
+    std::chrono::milliseconds flushInterval{1000};
+};
+
+// Accounts stored through a ConnectionPool, or any AccountStore, with an
+// LRU cache in front of loading so repeat lookups skip the round-trip.
+// save and remove only record the change; a background thread writes
+// pending changes in batches of at most flushBatchSize, each inside one
+// transaction. Lookups see pending changes before they reach the
+// database. Thread-safe.
+class AccountRepository : public Repository<market::core::Account>
 {
 public:
-    void save(std::shared_ptr<Account> account) override;
-    std::shared_ptr<Account> findById(const std::string &id) override;
-    std::vector<std::shared_ptr<Account>> findAll() override;
+    static std::shared_ptr<AccountRepository> create(
+        std::shared_ptr<ConnectionPool> pool,
+        const AccountRepositoryOptions &options = AccountRepositoryOptions());
+    static std::shared_ptr<AccountRepository> create(
+        std::shared_ptr<AccountStore> store,
+        const AccountRepositoryOptions &options = AccountRepositoryOptions());
+
+    // Flushes what is still pending; errors at this point are lost, so call
+    // flush() first to see them
+    ~AccountRepository() override;
+
+    AccountRepository(const AccountRepository &) = delete;
+    AccountRepository &operator=(const AccountRepository &) = delete;
+
+    void save(std::shared_ptr<market::core::Account> account) override;
+    std::shared_ptr<market::core::Account> findById(const std::string &id) override;
+    std::vector<std::shared_ptr<market::core::Account>> findAll() override;
     void remove(const std::string &id) override;
-};
\ No newline at end of file
+
+    // Writes every pending change now, flushBatchSize at a time, each
+    // batch in a transaction of its own. Throws std::runtime_error if a
+    // batch fails; batches already written stay stored, and the failed
+    // batch and the rest stay pending.
+    void flush();
+
+    std::size_t getPendingCount() const;
+    std::size_t getCachedCount() const;
+
+private:
+    using AccountPtr = std::shared_ptr<market::core::Account>;
+    // Pending change per account ID; a null account means removal
+    using Changes = std::unordered_map<std::string, AccountPtr>;
+
+    AccountRepository(std::shared_ptr<AccountStore> store, const AccountRepositoryOptions &options);
+
+    // Callers hold mutex_
+    const AccountPtr *findPending(const std::string &id) const;
+    void cache(const std::string &id, const AccountPtr &account);
+    void uncache(const std::string &id);
+    void recordChange(const std::string &id, AccountPtr account);
+
+    void write(const Changes &changes);
+    void flusherLoop();
+
+    std::shared_ptr<AccountStore> store_;
+    AccountRepositoryOptions options_;
+
+    mutable std::mutex mutex_;
+    // Most recently used first
+    std::list<std::pair<std::string, AccountPtr>> lru_;
+    std::unordered_map<std::string, std::list<std::pair<std::string, AccountPtr>>::iterator> cached_;
+    Changes dirty_;
+    Changes flushing_; // Batch being written; still visible to lookups
+    std::uint64_t changeCount_;
+
+    std::mutex flushMutex_; // One batch at a time
+    std::condition_variable wake_;
+    bool stopping_;
+    std::thread flusher_;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <libpq-fe.h>
+#include "core/Account.h"
+
+// Account statements prepared on every connection, with the binary
+// encoding of their parameters and results. Shared by Database and
+// AsyncDatabase so both speak the same statements.
+class AccountStatements
+{
+public:
+    static constexpr const char *SAVE = "save_account";     // $1 id, $2 name, $3 type; no rows
+    static constexpr const char *LOAD = "load_account";     // $1 id; name, type
+    static constexpr const char *REMOVE = "delete_account"; // $1 id; no rows
+    static constexpr int COUNT = 3;
+
+    // Sends the PQprepare for statement index (0 to COUNT - 1); pipelined
+    // connections use it to queue all three without waiting
+    static int sendPrepare(PGconn *conn, int index);
+
+    // Prepares all three and waits for each; throws std::runtime_error
+    static void prepare(PGconn *conn);
+
+    // Binary parameters for one statement. Points into its own storage
+    // and the strings it was built from, so it cannot be copied.
+    class Params
+    {
+    public:
+        explicit Params(const market::core::Account &account);
+        explicit Params(const std::string &accountId);
+        Params(const Params &) = delete;
+        Params &operator=(const Params &) = delete;
+
+        int count() const { return count_; }
+        const char *const *values() const { return values_; }
+        const int *lengths() const { return lengths_; }
+        const int *formats() const { return FORMATS; }
+
+    private:
+        static const int FORMATS[3];
+
+        int count_;
+        const char *values_[3];
+        int lengths_[3];
+        char type_[2];
+    };
+
+    // Reads row of a LOAD result, or of any result whose name and type
+    // columns are given; throws std::runtime_error on an unknown type
+    static std::shared_ptr<market::core::Account> readAccount(
+        const PGresult *res, int row, const std::string &accountId, int nameColumn = 0, int typeColumn = 1);
+
+    static std::int16_t readInt16(const PGresult *res, int row, int column);
+    static std::string readText(const PGresult *res, int row, int column);
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/Account.h"
+
+// Storage behind AccountRepository. The repository's own one reads and
+// writes PostgreSQL through a ConnectionPool; tests pass one of their own
+// to check the cache and write-back without a server. Called from several
+// threads at once.
+class AccountStore
+{
+public:
+    using AccountPtr = std::shared_ptr<market::core::Account>;
+
+    virtual ~AccountStore() = default;
+
+    // Null if no account has id
+    virtual AccountPtr load(const std::string &id) = 0;
+    virtual void loadAll(const std::function<void(AccountPtr)> &visit) = 0;
+
+    // Saves and removes in one transaction: all of it is stored or, when
+    // this throws, none of it. No ID appears twice.
+    virtual void write(const std::vector<AccountPtr> &saved, const std::vector<std::string> &removed) = 0;
+};
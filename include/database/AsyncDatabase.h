@@ -0,0 +1,112 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <libpq-fe.h>
+#include "core/Account.h"
+
+struct AsyncDatabaseOptions
+{
+    // Requests submitted but not yet completed; submitting more waits
+    std::size_t maxInFlight = 1024;
+};
+
+// Non-blocking client on one connection in libpq pipeline mode. Calls
+// queue a prepared statement and return a future straight away; a
+// background thread sends queued statements without waiting for earlier
+// ones to finish and completes the futures as results arrive, in
+// submission order. Each statement is followed by its own sync, so it runs
+// in a transaction of its own and one failure does not abort the others.
+// If the connection is lost, every request in flight fails; the next
+// request submitted reconnects and prepares the statements again before
+// it is sent, and fails too if the server still cannot be reached.
+// Thread-safe.
+class AsyncDatabase
+{
+public:
+    // Connects and prepares the account statements; throws
+    // std::runtime_error if the server cannot be reached
+    static std::shared_ptr<AsyncDatabase> create(const std::string &host,
+                                                 const std::string &port,
+                                                 const std::string &dbname,
+                                                 const std::string &user,
+                                                 const std::string &password,
+                                                 const AsyncDatabaseOptions &options = AsyncDatabaseOptions());
+
+    // Waits for every submitted request to complete, then disconnects
+    ~AsyncDatabase();
+
+    AsyncDatabase(const AsyncDatabase &) = delete;
+    AsyncDatabase &operator=(const AsyncDatabase &) = delete;
+
+    // Futures fail with std::runtime_error carrying the server's message
+    std::future<void> saveAccount(const std::shared_ptr<market::core::Account> &account);
+    std::future<std::shared_ptr<market::core::Account>> loadAccount(const std::string &accountId);
+    std::future<void> deleteAccount(const std::string &accountId);
+
+    // Waits until everything submitted so far has completed
+    void drain();
+
+    std::size_t getInFlightCount() const;
+    // False from a lost connection until a request reconnects
+    bool isConnected() const;
+
+private:
+    struct Request
+    {
+        // Queues the statement on the connection; 0 if libpq refused it
+        std::function<int(PGconn *)> send;
+        // Called with the statement's result, or with an error message
+        std::function<void(const PGresult *result, const std::string &error)> complete;
+    };
+
+    struct Pending
+    {
+        explicit Pending(Request request) : request(std::move(request)) {}
+
+        Request request;
+        std::unique_ptr<PGresult, void (*)(PGresult *)> result{nullptr, PQclear};
+        std::string error;
+        bool awaitingSync = false;
+    };
+
+    AsyncDatabase(PGconn *conn, std::string conninfo, const AsyncDatabaseOptions &options);
+
+    // A connection in pipeline mode with the statements prepared; throws
+    // std::runtime_error
+    static PGconn *connect(const std::string &conninfo);
+
+    void submit(Request request);
+
+    // Run on the loop thread only
+    void loop();
+    void sendQueued(std::vector<Request> &batch);
+    void readResults();
+    void finish(Pending &pending);
+    void reconnect();
+    void failAll(const std::string &error);
+
+    PGconn *conn_; // Replaced by reconnect
+    std::string conninfo_;
+    AsyncDatabaseOptions options_;
+    int wakeRead_;
+    int wakeWrite_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable space_;  // Signals submitters and drain()
+    std::vector<Request> queued_;    // Not yet sent
+    std::size_t outstanding_;        // Queued plus in flight
+    bool broken_;
+    std::string brokenError_;
+    bool stopping_;
+
+    std::deque<Pending> inFlight_;   // Sent, oldest first; loop thread only
+    std::thread loop_;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "database/Database.h"
+
+// Fixed set of connections shared by worker threads. A thread leases a
+// connection, uses it on its own and hands it back when the lease goes out
+// of scope; a connection returned inside a transaction is rolled back, and
+// one that was lost is reconnected before it is leased again.
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool>
+{
+public:
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(Lease &&other) noexcept = default;
+        Lease &operator=(Lease &&other) noexcept;
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease() { release(); }
+
+        Database &operator*() const { return *connection_; }
+        Database *operator->() const { return connection_.get(); }
+        explicit operator bool() const { return connection_ != nullptr; }
+
+        // Returns the connection to the pool early
+        void release();
+
+    private:
+        friend class ConnectionPool;
+        Lease(std::shared_ptr<ConnectionPool> pool, std::unique_ptr<Database> connection)
+            : pool_(std::move(pool)), connection_(std::move(connection)) {}
+
+        std::shared_ptr<ConnectionPool> pool_;
+        std::unique_ptr<Database> connection_;
+    };
+
+    // Opens all size connections up front, so bad settings fail here
+    static std::shared_ptr<ConnectionPool> create(const std::string &host,
+                                                  const std::string &port,
+                                                  const std::string &dbname,
+                                                  const std::string &user,
+                                                  const std::string &password,
+                                                  std::size_t size);
+
+    // Waits for a free connection
+    Lease acquire();
+
+    // Throws std::runtime_error if none is free within timeout
+    Lease acquire(std::chrono::milliseconds timeout);
+
+    std::size_t getSize() const { return size_; }
+    std::size_t getAvailable() const;
+
+private:
+    ConnectionPool(std::size_t size) : size_(size) {}
+
+    Lease lease(std::unique_lock<std::mutex> &lock);
+    void giveBack(std::unique_ptr<Database> connection);
+
+    std::size_t size_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<std::unique_ptr<Database>> idle_;
+};
@@ -1,9 +1,17 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <functional>
+#include <vector>
 #include <libpq-fe.h>
 #include "core/Account.h"
+#include "database/AccountStatements.h"
+#include "accounting/Ledger.h"
 
+// One connection to PostgreSQL; not thread-safe, so threads that share a
+// server should each take a connection from a ConnectionPool. Account
+// operations run as statements prepared once per connection, with
+// parameters and results in binary format.
 class Database
 {
 public:
@@ -14,6 +22,9 @@ public:
              const std::string &password);
     ~Database();
 
+    Database(const Database &) = delete;
+    Database &operator=(const Database &) = delete;
+
     // Connection management
     void connect();
     void disconnect();
@@ -23,13 +34,35 @@ public:
     void beginTransaction();
     void commitTransaction();
     void rollbackTransaction();
+    bool isInTransaction() const;
 
     // Account operations
-    void saveAccount(const std::shared_ptr<Account> &account);
-    std::shared_ptr<Account> loadAccount(const std::string &accountId);
+    void saveAccount(const std::shared_ptr<market::core::Account> &account);
+    std::shared_ptr<market::core::Account> loadAccount(const std::string &accountId);
     void deleteAccount(const std::string &accountId);
 
+    // Bulk operations. Rows travel over the COPY protocol in binary format,
+    // inside a transaction of their own unless one is already open.
+    // saveAccounts upserts through a temporary table, so account IDs in one
+    // call must be distinct. saveLedgerEntries stores every entry of a
+    // consistent snapshot of ledger the same way, skipping entries already
+    // stored, so saving a ledger again only adds its new entries. Postings
+    // to the ledger wait only while its entries are copied into memory.
+    void saveAccounts(const std::vector<std::shared_ptr<market::core::Account>> &accounts);
+    void saveLedgerEntries(const market::accounting::Ledger &ledger);
+
+    // Streaming loads: rows are fetched one at a time in single-row mode,
+    // so the full result set is never held in memory. loadAll passes each
+    // account to visit, when given, and posts every stored ledger entry
+    // to ledger in timestamp order.
+    using AccountVisitor = std::function<void(std::shared_ptr<market::core::Account>)>;
+    void loadAccounts(const AccountVisitor &visit);
+    void loadLedgerEntries(market::accounting::Ledger &ledger);
+    void loadAll(market::accounting::Ledger &ledger, const AccountVisitor &visit = nullptr);
+
 private:
+    using Result = std::unique_ptr<PGresult, void (*)(PGresult *)>;
+
     PGconn *conn_;
     std::string host_;
     std::string port_;
@@ -37,6 +70,21 @@ private:
     std::string user_;
     std::string password_;
 
+    void requireConnection() const;
+    void prepareStatements();
     void executeQuery(const std::string &query);
-    std::string escapeString(const std::string &str);
-};
\ No newline at end of file
+
+    // Runs fn inside a transaction unless the caller already opened one
+    void inTransaction(const std::function<void()> &fn);
+    void startCopy(const char *query);
+
+    // Sends query with a binary result and calls row for each row as it
+    // arrives. Cancels the query if row throws.
+    void streamQuery(const char *query, const std::function<void(const PGresult *)> &row);
+
+    // Runs a prepared statement with binary parameters and asks for a
+    // binary result; throws std::runtime_error unless it has status expected
+    Result executePrepared(const char *statement,
+                           const AccountStatements::Params &params,
+                           ExecStatusType expected);
+};
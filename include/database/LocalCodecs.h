@@ -0,0 +1,175 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "core/Account.h"
+#include "financial/Wallet.h"
+#include "financial/Asset.h"
+#include "financial/Liability.h"
+#include "financial/Transaction.h"
+#include "contracts/Contract.h"
+#include "utils/LocalStore.h"
+
+// BinaryCodec messages for the domain objects, as stored by LocalRepository.
+// Each codec names the key prefix its type is stored under and turns an
+// object into a message and back; the ID is the key, so it is not repeated
+// in the message. Other objects are referred to by ID: a parent stores the
+// IDs of the objects it holds, and a transaction or contract the IDs of the
+// accounts it names. Saving an object stores only its own record, so the
+// objects it refers to are saved through their own repositories.
+//
+// Decoding happens in two steps. decode builds the object from its own
+// fields and the objects it cannot be constructed without; link then adds
+// the objects it holds, once the loader knows about it, so that an account
+// and its contracts can refer to each other. Both throw std::runtime_error
+// if the message is malformed or names an object that is not stored.
+
+// Turns stored IDs into objects for the duration of one lookup. Each object
+// is decoded at most once per loader, so references that form a cycle
+// resolve to the object already being built and every reference to a
+// stored object shares one instance. Not thread-safe; use one per lookup.
+class LocalLoader
+{
+public:
+    explicit LocalLoader(const LocalStore &store) : store_(store) {}
+
+    // Null if no object with this ID is stored
+    template <typename Codec>
+    std::shared_ptr<typename Codec::Entity> find(const std::string &id);
+
+    // As find, but throws std::runtime_error naming owner if it is missing
+    template <typename Codec>
+    std::shared_ptr<typename Codec::Entity> require(std::string_view id, const std::string &owner);
+
+    // Decodes a record already read from the store, unless the object was
+    // decoded before
+    template <typename Codec>
+    std::shared_ptr<typename Codec::Entity> load(const std::string &id, std::string_view data);
+
+private:
+    const LocalStore &store_;
+    // Objects decoded so far, by store key
+    std::unordered_map<std::string, std::shared_ptr<void>> loaded_;
+};
+
+// 1 name, 2 type, then repeated IDs: 3 wallet, 4 asset, 5 liability,
+// 6 contract
+class AccountCodec
+{
+public:
+    using Entity = market::core::Account;
+    static constexpr const char *PREFIX = "account/";
+    std::string encode(const market::core::Account &account) const;
+    std::shared_ptr<market::core::Account> decode(const std::string &id, std::string_view data, LocalLoader &loader) const;
+    void link(market::core::Account &account, std::string_view data, LocalLoader &loader) const;
+};
+
+// 1 currency, 2 raw balance, 3 transaction ID (repeated)
+class WalletCodec
+{
+public:
+    using Entity = market::financial::Wallet;
+    static constexpr const char *PREFIX = "wallet/";
+    std::string encode(const market::financial::Wallet &wallet) const;
+    std::shared_ptr<market::financial::Wallet> decode(const std::string &id, std::string_view data, LocalLoader &loader) const;
+    void link(market::financial::Wallet &wallet, std::string_view data, LocalLoader &loader) const;
+};
+
+// 1 type, 2 raw value; a strategy has to be set again after loading
+class AssetCodec
+{
+public:
+    using Entity = market::financial::Asset;
+    static constexpr const char *PREFIX = "asset/";
+    std::string encode(const market::financial::Asset &asset) const;
+    std::shared_ptr<market::financial::Asset> decode(const std::string &id, std::string_view data, LocalLoader &loader) const;
+    void link(market::financial::Asset &, std::string_view, LocalLoader &) const {}
+};
+
+// 1 type, 2 raw value
+class LiabilityCodec
+{
+public:
+    using Entity = market::financial::Liability;
+    static constexpr const char *PREFIX = "liability/";
+    std::string encode(const market::financial::Liability &liability) const;
+    std::shared_ptr<market::financial::Liability> decode(const std::string &id, std::string_view data, LocalLoader &loader) const;
+    void link(market::financial::Liability &, std::string_view, LocalLoader &) const {}
+};
+
+// 1 type, 2 raw amount, 3 account ID, 4 asset ID, 5 liability ID,
+// 6 timestamp (ns since the epoch), 7 status
+class TransactionCodec
+{
+public:
+    using Entity = market::financial::Transaction;
+    static constexpr const char *PREFIX = "transaction/";
+    std::string encode(const market::financial::Transaction &transaction) const;
+    std::shared_ptr<market::financial::Transaction> decode(const std::string &id, std::string_view data, LocalLoader &loader) const;
+    void link(market::financial::Transaction &, std::string_view, LocalLoader &) const {}
+};
+
+// 1 type, 2 state, 3 and 4 party IDs, 5 term (repeated; 1 key, 2 value)
+class ContractCodec
+{
+public:
+    using Entity = market::contracts::Contract;
+    static constexpr const char *PREFIX = "contract/";
+    std::string encode(const market::contracts::Contract &contract) const;
+    std::shared_ptr<market::contracts::Contract> decode(const std::string &id, std::string_view data, LocalLoader &loader) const;
+    void link(market::contracts::Contract &, std::string_view, LocalLoader &) const {}
+};
+
+template <typename Codec>
+std::shared_ptr<typename Codec::Entity> LocalLoader::find(const std::string &id)
+{
+    std::string key = Codec::PREFIX + id;
+    auto found = loaded_.find(key);
+    if (found != loaded_.end())
+    {
+        return std::static_pointer_cast<typename Codec::Entity>(found->second);
+    }
+    std::string data;
+    if (!store_.get(key, data))
+    {
+        return nullptr;
+    }
+    return load<Codec>(id, data);
+}
+
+template <typename Codec>
+std::shared_ptr<typename Codec::Entity> LocalLoader::require(std::string_view id, const std::string &owner)
+{
+    std::string name(id);
+    std::shared_ptr<typename Codec::Entity> found = find<Codec>(name);
+    if (!found)
+    {
+        throw std::runtime_error(std::string(Codec::PREFIX) + name + " of " + owner + " not found");
+    }
+    return found;
+}
+
+template <typename Codec>
+std::shared_ptr<typename Codec::Entity> LocalLoader::load(const std::string &id, std::string_view data)
+{
+    std::string key = Codec::PREFIX + id;
+    auto found = loaded_.find(key);
+    if (found != loaded_.end())
+    {
+        return std::static_pointer_cast<typename Codec::Entity>(found->second);
+    }
+
+    Codec codec;
+    std::shared_ptr<typename Codec::Entity> entity = codec.decode(id, data, *this);
+    // Decoding what it refers to may have come back round to this object
+    // and built it already; keep that one, which the others point at
+    auto [slot, inserted] = loaded_.emplace(std::move(key), entity);
+    if (!inserted)
+    {
+        return std::static_pointer_cast<typename Codec::Entity>(slot->second);
+    }
+    codec.link(*entity, data, *this);
+    return entity;
+}
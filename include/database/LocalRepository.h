@@ -0,0 +1,88 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "database/Repository.h"
+#include "database/LocalCodecs.h"
+#include "utils/LocalStore.h"
+
+// Repository kept in a LocalStore on this machine, for nodes that run
+// without a database server. Each entity is stored under Codec::PREFIX plus
+// its ID, so several repositories can share one store. Writes go to the
+// store's file straight away. Lookups decode a fresh object each time, as
+// Database does, together with every stored object it refers to; within
+// one findById or findAll each stored object is decoded once, so the
+// results share them. Thread-safe.
+template <typename T, typename Codec>
+class LocalRepository : public Repository<T>
+{
+public:
+    static std::shared_ptr<LocalRepository> create(std::shared_ptr<LocalStore> store)
+    {
+        if (!store)
+        {
+            throw std::invalid_argument("Store cannot be null");
+        }
+        return std::shared_ptr<LocalRepository>(new LocalRepository(std::move(store)));
+    }
+
+    void save(std::shared_ptr<T> entity) override
+    {
+        if (!entity)
+        {
+            throw std::invalid_argument("Entity cannot be null");
+        }
+        store_->put(key(entity->getId()), Codec().encode(*entity));
+    }
+
+    std::shared_ptr<T> findById(const std::string &id) override
+    {
+        LocalLoader loader(*store_);
+        return loader.find<Codec>(id);
+    }
+
+    std::vector<std::shared_ptr<T>> findAll() override
+    {
+        // Decoded after the walk, since decoding looks up the entities each
+        // one refers to in the same store
+        std::vector<std::pair<std::string, std::string>> stored;
+        std::string_view prefix(Codec::PREFIX);
+        store_->forEach(prefix, [&](std::string_view storedKey, std::string_view value)
+                        { stored.emplace_back(storedKey.substr(prefix.size()), value); });
+
+        LocalLoader loader(*store_);
+        std::vector<std::shared_ptr<T>> entities;
+        entities.reserve(stored.size());
+        for (const auto &[id, value] : stored)
+        {
+            entities.push_back(loader.load<Codec>(id, value));
+        }
+        return entities;
+    }
+
+    void remove(const std::string &id) override
+    {
+        store_->remove(key(id));
+    }
+
+    const std::shared_ptr<LocalStore> &getStore() const { return store_; }
+
+private:
+    explicit LocalRepository(std::shared_ptr<LocalStore> store)
+        : store_(std::move(store)) {}
+
+    static std::string key(const std::string &id)
+    {
+        return Codec::PREFIX + id;
+    }
+
+    std::shared_ptr<LocalStore> store_;
+};
+
+using LocalAccountRepository = LocalRepository<market::core::Account, AccountCodec>;
+using LocalWalletRepository = LocalRepository<market::financial::Wallet, WalletCodec>;
+using LocalAssetRepository = LocalRepository<market::financial::Asset, AssetCodec>;
+using LocalLiabilityRepository = LocalRepository<market::financial::Liability, LiabilityCodec>;
+using LocalTransactionRepository = LocalRepository<market::financial::Transaction, TransactionCodec>;
+using LocalContractRepository = LocalRepository<market::contracts::Contract, ContractCodec>;
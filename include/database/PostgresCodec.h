@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include "utils/Decimal.h"
+
+// Binary wire formats of the PostgreSQL types Database reads and writes
+// directly. Pure functions with no libpq dependency, so they build into
+// market_core and are tested without a server.
+
+// Binary timestamptz counts microseconds from 2000-01-01 00:00:00 UTC;
+// precision below a microsecond is truncated
+std::int64_t toPostgresTime(const std::chrono::system_clock::time_point &timestamp);
+std::chrono::system_clock::time_point fromPostgresTime(std::int64_t micros);
+
+// Binary numeric: ndigits, weight, sign and display scale as int16,
+// then ndigits base-10000 digits, the first worth 10000^weight. Every
+// field is in network byte order.
+struct PostgresNumeric
+{
+    static constexpr std::uint16_t POSITIVE = 0x0000;
+    static constexpr std::uint16_t NEGATIVE = 0x4000;
+    static constexpr std::int64_t BASE = 10000;
+    static constexpr int MAX_DIGITS = 10; // At most five each side of the point
+
+    std::uint16_t header[4];
+    std::uint16_t digits[MAX_DIGITS];
+    int size; // Digits used
+
+    // Bytes on the wire: the header plus size digits
+    int byteSize() const { return 8 + size * 2; }
+};
+
+// Always exact, with Decimal::SCALE as the display scale
+PostgresNumeric toNumeric(const Decimal &value);
+
+// Reads size bytes of binary numeric. Throws std::runtime_error if they
+// are malformed, NaN or infinite, or have more than Decimal::SCALE decimal
+// places that are not zero, and std::overflow_error if the value is out of
+// Decimal's range.
+Decimal fromNumeric(const char *data, int size);
@@ -15,6 +15,10 @@ namespace market::financial
     public:
         static std::shared_ptr<Asset> create(const std::string &type, const Decimal &value);
 
+        // Rebuilds an asset read back from storage with its original ID;
+        // the ID counter skips past id
+        static std::shared_ptr<Asset> restore(const std::string &id, const std::string &type, const Decimal &value);
+
         Asset(const std::string &id, const std::string &type, const Decimal &value);
         virtual ~Asset() = default;
 
@@ -1,41 +1,47 @@
 #pragma once
 #include <memory>
 #include "utils/Decimal.h"
-class Asset;
 
-class AssetStrategy
+namespace market::financial
 {
-public:
-    virtual Decimal calculateValue(const Asset &asset) const = 0;
-    virtual ~AssetStrategy() = default;
-};
 
-class CashAssetStrategy : public AssetStrategy
-{
-public:
-    Decimal calculateValue(const Asset &asset) const override;
-};
+    class Asset;
 
-class StockAssetStrategy : public AssetStrategy
-{
-public:
-    Decimal calculateValue(const Asset &asset) const override;
-};
+    class AssetStrategy
+    {
+    public:
+        virtual Decimal calculateValue(const Asset &asset) const = 0;
+        virtual ~AssetStrategy() = default;
+    };
 
-class BondAssetStrategy : public AssetStrategy
-{
-public:
-    Decimal calculateValue(const Asset &asset) const override;
-};
+    class CashAssetStrategy : public AssetStrategy
+    {
+    public:
+        Decimal calculateValue(const Asset &asset) const override;
+    };
 
-class CommodityAssetStrategy : public AssetStrategy
-{
-public:
-    Decimal calculateValue(const Asset &asset) const override;
-};
+    class StockAssetStrategy : public AssetStrategy
+    {
+    public:
+        Decimal calculateValue(const Asset &asset) const override;
+    };
 
-class DerivativeAssetStrategy : public AssetStrategy
-{
-public:
-    Decimal calculateValue(const Asset &asset) const override;
-};
\ No newline at end of file
+    class BondAssetStrategy : public AssetStrategy
+    {
+    public:
+        Decimal calculateValue(const Asset &asset) const override;
+    };
+
+    class CommodityAssetStrategy : public AssetStrategy
+    {
+    public:
+        Decimal calculateValue(const Asset &asset) const override;
+    };
+
+    class DerivativeAssetStrategy : public AssetStrategy
+    {
+    public:
+        Decimal calculateValue(const Asset &asset) const override;
+    };
+
+} // namespace market::financial
\ No newline at end of file
@@ -15,6 +15,10 @@ namespace market::financial
     public:
         static std::shared_ptr<Liability> create(const std::string &type, const Decimal &value);
 
+        // Rebuilds a liability read back from storage with its original ID;
+        // the ID counter skips past id
+        static std::shared_ptr<Liability> restore(const std::string &id, const std::string &type, const Decimal &value);
+
         // Getters
         const std::string &getId() const { return id_; }
         const std::string &getType() const { return type_; }
@@ -1,23 +1,29 @@
 #pragma once
 #include <memory>
 #include "utils/Decimal.h"
-class Liability;
 
-class LiabilityStrategy
+namespace market::financial
 {
-public:
-    virtual Decimal calculateValue(const Liability &liability) const = 0;
-    virtual ~LiabilityStrategy() = default;
-};
 
-class LoanLiabilityStrategy : public LiabilityStrategy
-{
-public:
-    Decimal calculateValue(const Liability &liability) const override;
-};
+    class Liability;
 
-class MarginLiabilityStrategy : public LiabilityStrategy
-{
-public:
-    Decimal calculateValue(const Liability &liability) const override;
-};
\ No newline at end of file
+    class LiabilityStrategy
+    {
+    public:
+        virtual Decimal calculateValue(const Liability &liability) const = 0;
+        virtual ~LiabilityStrategy() = default;
+    };
+
+    class LoanLiabilityStrategy : public LiabilityStrategy
+    {
+    public:
+        Decimal calculateValue(const Liability &liability) const override;
+    };
+
+    class MarginLiabilityStrategy : public LiabilityStrategy
+    {
+    public:
+        Decimal calculateValue(const Liability &liability) const override;
+    };
+
+} // namespace market::financial
\ No newline at end of file
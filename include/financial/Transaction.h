@@ -31,6 +31,10 @@ namespace market::financial
 
         static std::shared_ptr<Transaction> create(Type type, const Decimal &amount, std::shared_ptr<market::core::Account> account, std::shared_ptr<Asset> asset, std::shared_ptr<Liability> liability);
 
+        // Rebuilds a transaction read back from storage with its original ID,
+        // timestamp and status; the ID counter skips past id
+        static std::shared_ptr<Transaction> restore(const std::string &id, Type type, const Decimal &amount, std::shared_ptr<market::core::Account> account, std::shared_ptr<Asset> asset, std::shared_ptr<Liability> liability, std::chrono::system_clock::time_point timestamp, Status status);
+
         const std::string &getId() const { return id_; }
         Type getType() const { return type_; }
         const Decimal &getAmount() const { return amount_; }
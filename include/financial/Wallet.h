@@ -15,6 +15,12 @@ namespace market::financial
     public:
         static std::shared_ptr<Wallet> create(const std::string &currency);
 
+        // Rebuilds a wallet read back from storage with its original ID and
+        // balance; the ID counter skips past id
+        static std::shared_ptr<Wallet> restore(const std::string &id, const std::string &currency, const Decimal &balance);
+
+        virtual ~Wallet() = default;
+
         const std::string &getId() const { return id_; }
         const std::string &getCurrency() const { return currency_; }
 
@@ -25,7 +31,6 @@ namespace market::financial
 
     private:
         Wallet(const std::string &id, const std::string &currency);
-        virtual ~Wallet() = default;
 
         std::string id_;
         std::string currency_;
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+
+// Thread-safe monotonic arena. Allocations bump through large blocks and
+// individual deallocation is a no-op; every block is released together when
+// the arena is destroyed. Objects created through adopt() keep their arena
+// alive, so dropping the last of them frees the whole arena in one go.
+class Arena : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    static std::shared_ptr<Arena> create(std::size_t blockSize = DEFAULT_BLOCK_SIZE)
+    {
+        return std::shared_ptr<Arena>(new Arena(blockSize));
+    }
+
+    std::size_t getBytesAllocated() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytesAllocated_;
+    }
+
+    // Takes ownership of an object constructed in memory from this arena.
+    // The returned pointer's control block also lives in the arena and holds
+    // a reference to it; releasing the pointer only runs the destructor.
+    template <typename T>
+    static std::shared_ptr<T> adopt(const std::shared_ptr<Arena> &arena, T *object);
+
+private:
+    explicit Arena(std::size_t blockSize) : resource_(blockSize), bytesAllocated_(0) {}
+
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bytesAllocated_ += bytes;
+        return resource_.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    mutable std::mutex mutex_;
+    std::pmr::monotonic_buffer_resource resource_;
+    std::size_t bytesAllocated_;
+};
+
+// Standard allocator drawing from an Arena. Each copy holds a reference to
+// the arena, so containers and control blocks using it keep it alive.
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(std::shared_ptr<Arena> arena) : arena_(std::move(arena)) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.getArena()) {}
+
+    T *allocate(std::size_t count)
+    {
+        return static_cast<T *>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, std::size_t) {}
+
+    const std::shared_ptr<Arena> &getArena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena_ == other.getArena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena_ != other.getArena(); }
+
+private:
+    std::shared_ptr<Arena> arena_;
+};
+
+template <typename T>
+std::shared_ptr<T> Arena::adopt(const std::shared_ptr<Arena> &arena, T *object)
+{
+    return std::shared_ptr<T>(object, [](T *p)
+                              { p->~T(); },
+                              ArenaAllocator<T>(arena));
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Tagged binary encoding shared by every persisted object. A message is a
+// sequence of fields, each a varint key (field number << 3 | wire type)
+// followed by its value:
+//
+//     wire type 0   varint; signed values are zigzag-encoded first
+//     wire type 2   varint length, then that many bytes; strings and
+//                   nested messages
+//
+// so small numbers and short strings take a byte or two. Readers skip
+// fields they do not know and leave absent ones at their defaults, which
+// lets a field be added or retired without bumping the version of the file
+// holding the messages. A field's number and wire type never change once
+// written.
+
+class BinaryWriter
+{
+public:
+    // Appends to out
+    explicit BinaryWriter(std::string &out) : out_(out) {}
+
+    void writeUint(std::uint32_t field, std::uint64_t value)
+    {
+        writeKey(field, VARINT);
+        putVarint(value);
+    }
+
+    void writeInt(std::uint32_t field, std::int64_t value)
+    {
+        writeUint(field, zigzag(value));
+    }
+
+    void writeBytes(std::uint32_t field, std::string_view bytes)
+    {
+        writeKey(field, BYTES);
+        putVarint(bytes.size());
+        out_.append(bytes.data(), bytes.size());
+    }
+
+    // Writes a nested message by calling fn with this writer
+    template <typename Fn>
+    void writeMessage(std::uint32_t field, Fn &&fn)
+    {
+        writeKey(field, BYTES);
+        // Room for a one-byte length, widened afterwards if it is longer
+        std::size_t start = out_.size();
+        out_.push_back(0);
+        fn(*this);
+        finishMessage(start);
+    }
+
+    static std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+private:
+    friend class BinaryReader;
+    static constexpr std::uint32_t VARINT = 0;
+    static constexpr std::uint32_t BYTES = 2;
+
+    void writeKey(std::uint32_t field, std::uint32_t wireType)
+    {
+        putVarint((static_cast<std::uint64_t>(field) << 3) | wireType);
+    }
+
+    void putVarint(std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+
+    void finishMessage(std::size_t start);
+
+    std::string &out_;
+};
+
+// Reads the fields of one message in place; byte values are views into the
+// encoded data, so nothing is copied until the caller asks. Throws
+// std::runtime_error for data that is cut short or malformed.
+//
+//     BinaryReader reader(data);
+//     while (reader.next())
+//     {
+//         switch (reader.field())
+//         {
+//         case 1: id = reader.getBytes(); break;
+//         case 2: amount = reader.getInt(); break;
+//         default: break; // Added by a newer writer
+//         }
+//     }
+class BinaryReader
+{
+public:
+    explicit BinaryReader(std::string_view data) : data_(data) {}
+
+    // Moves to the next field; false once the message is used up
+    bool next();
+
+    std::uint32_t field() const { return field_; }
+
+    // The current field's value; throws if it was written with another
+    // wire type
+    std::uint64_t getUint() const;
+    std::int64_t getInt() const;
+    std::string_view getBytes() const;
+    BinaryReader getMessage() const { return BinaryReader(getBytes()); }
+
+private:
+    std::uint64_t readVarint();
+
+    std::string_view data_;
+    std::size_t position_ = 0;
+    std::uint32_t field_ = 0;
+    std::uint32_t wireType_ = 0;
+    std::uint64_t value_ = 0;
+    std::string_view bytes_;
+};
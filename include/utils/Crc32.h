@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE 802.3, the zlib and PNG polynomial), computed eight bytes at
+// a time with slicing tables.
+class Crc32
+{
+public:
+    // Checksum of [data, data + size). Pass a previous result as crc to
+    // continue a checksum across several buffers.
+    static std::uint32_t compute(const void *data, std::size_t size, std::uint32_t crc = 0);
+};
@@ -1,36 +1,107 @@
 #pragma once
 #include <string>
-#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <charconv>
 
+// Number of fractional digits carried by every Decimal. Matches the
+// DECIMAL(20,8) columns in the database schema.
+#ifndef MARKET_DECIMAL_SCALE
+#define MARKET_DECIMAL_SCALE 8
+#endif
+
+// Multiplication and division go through a 128-bit intermediate when the
+// compiler provides one; otherwise they use 64 bits and throw on overflow.
+#if !defined(MARKET_DECIMAL_INT128) && defined(__SIZEOF_INT128__)
+#define MARKET_DECIMAL_INT128 1
+#endif
+
+namespace decimal_detail
+{
+    constexpr std::int64_t pow10(int exponent)
+    {
+        std::int64_t result = 1;
+        for (int i = 0; i < exponent; ++i)
+        {
+            result *= 10;
+        }
+        return result;
+    }
+}
+
+// Fixed-point decimal stored as a 64-bit integer count of 10^-SCALE units.
+// Addition, subtraction and comparisons are exact integer operations and are
+// defined inline so that summing loops can be vectorized by the compiler.
 class Decimal
 {
 public:
-    Decimal() : value_(0) {}
-    explicit Decimal(double value) : value_(value) {}
+    static constexpr int SCALE = MARKET_DECIMAL_SCALE;
+    static_assert(SCALE >= 0 && SCALE <= 18, "Decimal scale must be between 0 and 18");
+    static constexpr std::int64_t ONE = decimal_detail::pow10(SCALE);
+    // Longest text produced by toChars(): sign, 19 digits and the point
+    static constexpr std::size_t MAX_CHARS = 21;
+
+    enum class RoundingMode
+    {
+        HALF_EVEN,
+        HALF_UP,
+        HALF_DOWN,
+        DOWN,
+        UP,
+        FLOOR,
+        CEILING
+    };
+
+    constexpr Decimal() : value_(0) {}
+    constexpr explicit Decimal(int value) : value_(static_cast<std::int64_t>(value) * ONE) {}
+    constexpr explicit Decimal(std::int64_t value) : value_(value * ONE) {}
+    explicit Decimal(double value);
     explicit Decimal(const std::string &str);
 
-    // Arithmetic operators
-    Decimal operator+(const Decimal &other) const;
-    Decimal operator-(const Decimal &other) const;
-    Decimal operator*(const Decimal &other) const;
-    Decimal operator/(const Decimal &other) const;
+    // Raw access to the scaled integer representation
+    static constexpr Decimal fromRaw(std::int64_t raw)
+    {
+        Decimal result;
+        result.value_ = raw;
+        return result;
+    }
+    constexpr std::int64_t toRaw() const { return value_; }
+
+    // Arithmetic operators (wrap on overflow, like the underlying integer)
+    constexpr Decimal operator+(const Decimal &other) const { return fromRaw(value_ + other.value_); }
+    constexpr Decimal operator-(const Decimal &other) const { return fromRaw(value_ - other.value_); }
+    Decimal operator*(const Decimal &other) const { return multiply(other, RoundingMode::HALF_EVEN); }
+    Decimal operator/(const Decimal &other) const { return divide(other, RoundingMode::HALF_EVEN); }
+
+    // Rounded to SCALE digits using the given mode; throw std::overflow_error
+    // when the result does not fit.
+    Decimal multiply(const Decimal &other, RoundingMode mode) const;
+    Decimal divide(const Decimal &other, RoundingMode mode) const;
 
     // Unary minus operator
-    Decimal operator-() const { return Decimal(-value_); }
+    constexpr Decimal operator-() const { return fromRaw(-value_); }
 
     // Comparison operators
-    bool operator==(const Decimal &other) const;
-    bool operator!=(const Decimal &other) const;
-    bool operator<(const Decimal &other) const;
-    bool operator>(const Decimal &other) const;
-    bool operator<=(const Decimal &other) const;
-    bool operator>=(const Decimal &other) const;
+    constexpr bool operator==(const Decimal &other) const { return value_ == other.value_; }
+    constexpr bool operator!=(const Decimal &other) const { return value_ != other.value_; }
+    constexpr bool operator<(const Decimal &other) const { return value_ < other.value_; }
+    constexpr bool operator>(const Decimal &other) const { return value_ > other.value_; }
+    constexpr bool operator<=(const Decimal &other) const { return value_ <= other.value_; }
+    constexpr bool operator>=(const Decimal &other) const { return value_ >= other.value_; }
 
     // Conversion
-    double toDouble() const { return value_; }
+    double toDouble() const;
     std::string toString() const;
 
+    // Allocation-free parsing and formatting in the style of std::from_chars
+    // and std::to_chars. Accepts an optional sign, digits and an optional
+    // fraction; fraction digits beyond SCALE are rounded using mode. On error
+    // value is left unchanged.
+    static std::from_chars_result fromChars(const char *first, const char *last, Decimal &value,
+                                            RoundingMode mode = RoundingMode::HALF_EVEN);
+    // Writes the shortest exact representation, without a terminator.
+    std::to_chars_result toChars(char *first, char *last) const;
+
 private:
-    double value_;
-    static constexpr double EPSILON = 1e-10;
-};
\ No newline at end of file
+    std::int64_t value_;
+};
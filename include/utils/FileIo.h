@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Helpers shared by the files that write their own records: JournalLog,
+// LedgerSnapshotFile and LocalStore. Failures throw std::runtime_error.
+
+// "what path: strerror(errno)", built from the current errno
+std::runtime_error ioError(const std::string &what, const std::string &path);
+
+// Writes all of [data, data + size) at the file position, retrying short
+// writes and EINTR
+void writeAll(int fd, const char *data, std::size_t size, const std::string &path);
+
+// As writeAll, but at offset, leaving the file position alone
+void writeAt(int fd, const char *data, std::size_t size, std::uint64_t offset, const std::string &path);
+
+// Makes a new or renamed entry in the directory holding path durable
+void syncDirectory(const std::string &path);
+
+// Little-endian u32, the byte order of every length and checksum on disk
+inline void storeUint32(char *out, std::uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+inline std::uint32_t loadUint32(const char *in)
+{
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+// JournalLog and LocalStore frame records as [u32 length][u32 crc32 of
+// payload][payload]. Whether a record whose payload has at least minLength
+// (at least 1) bytes and a matching checksum starts anywhere in data after
+// start and ends by size. A crash can only tear the last record, so damage
+// at start is a torn write only when this is false.
+bool recordFollows(const char *data, std::uint64_t start, std::uint64_t size, std::uint32_t minLength);
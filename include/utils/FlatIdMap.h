@@ -0,0 +1,259 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+// Map from ID to shared object for objects that carry their own ID, so only
+// the pointers are stored and the key is read back through getId(). Up to N
+// objects sit inline and are found by a linear scan, with no allocation at
+// all; past that they move to an open-addressing table (linear probing,
+// power-of-two capacity, at most three quarters full) that erases by
+// shifting later entries back instead of leaving tombstones.
+//
+// Iteration yields the shared pointers, in no particular order, and is
+// invalidated by any insert or erase. T only needs to be complete where
+// entries are looked up, inserted or erased.
+template <typename T, std::size_t N = 2>
+class FlatIdMap
+{
+public:
+    using value_type = std::shared_ptr<T>;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::shared_ptr<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::shared_ptr<T> *;
+        using reference = const std::shared_ptr<T> &;
+
+        const_iterator() = default;
+        const_iterator(pointer slot, pointer end) : slot_(slot), end_(end) { skipEmpty(); }
+
+        reference operator*() const { return *slot_; }
+        pointer operator->() const { return slot_; }
+        const_iterator &operator++()
+        {
+            ++slot_;
+            skipEmpty();
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const const_iterator &other) const { return slot_ == other.slot_; }
+        bool operator!=(const const_iterator &other) const { return slot_ != other.slot_; }
+
+    private:
+        void skipEmpty()
+        {
+            while (slot_ != end_ && !*slot_)
+            {
+                ++slot_;
+            }
+        }
+
+        pointer slot_ = nullptr;
+        pointer end_ = nullptr;
+    };
+
+    FlatIdMap() = default;
+
+    FlatIdMap(const FlatIdMap &other)
+    {
+        for (const auto &value : other)
+        {
+            insert(value);
+        }
+    }
+
+    FlatIdMap(FlatIdMap &&other) noexcept
+        : inline_(std::move(other.inline_)), table_(std::move(other.table_)), size_(other.size_), capacity_(other.capacity_)
+    {
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+
+    FlatIdMap &operator=(FlatIdMap other) noexcept
+    {
+        std::swap(inline_, other.inline_);
+        std::swap(table_, other.table_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+        return *this;
+    }
+
+    // Null if there is no object with this ID
+    const std::shared_ptr<T> *find(std::string_view id) const
+    {
+        if (!table_)
+        {
+            for (std::size_t i = 0; i < size_; ++i)
+            {
+                if (inline_[i]->getId() == id)
+                {
+                    return &inline_[i];
+                }
+            }
+            return nullptr;
+        }
+        for (std::size_t slot = home(id);; slot = next(slot))
+        {
+            const std::shared_ptr<T> &value = table_[slot];
+            if (!value)
+            {
+                return nullptr;
+            }
+            if (value->getId() == id)
+            {
+                return &value;
+            }
+        }
+    }
+
+    std::shared_ptr<T> get(std::string_view id) const
+    {
+        const std::shared_ptr<T> *found = find(id);
+        return found ? *found : nullptr;
+    }
+
+    bool contains(std::string_view id) const { return find(id) != nullptr; }
+
+    // False, leaving the map as it was, if an object with the same ID is
+    // already there; value must not be null
+    bool insert(std::shared_ptr<T> value)
+    {
+        if (find(value->getId()))
+        {
+            return false;
+        }
+        if (!table_ && size_ < N)
+        {
+            inline_[size_++] = std::move(value);
+            return true;
+        }
+        if ((size_ + 1) * 4 > capacity_ * 3)
+        {
+            grow();
+        }
+        place(std::move(value));
+        ++size_;
+        return true;
+    }
+
+    // False if there was no object with this ID
+    bool erase(std::string_view id)
+    {
+        const std::shared_ptr<T> *found = find(id);
+        if (!found)
+        {
+            return false;
+        }
+        std::shared_ptr<T> *slot = const_cast<std::shared_ptr<T> *>(found);
+        --size_;
+        if (!table_)
+        {
+            // Keep the inline entries packed at the front
+            *slot = std::move(inline_[size_]);
+            inline_[size_].reset();
+            return true;
+        }
+
+        // Shift back later entries of the same probe run that would no
+        // longer be reachable past the hole
+        std::size_t hole = static_cast<std::size_t>(slot - table_.get());
+        table_[hole].reset();
+        for (std::size_t i = next(hole); table_[i]; i = next(i))
+        {
+            std::size_t wanted = home(table_[i]->getId());
+            // Move it unless its home lies cyclically in (hole, i]
+            bool reachable = hole < i ? (wanted > hole && wanted <= i) : (wanted > hole || wanted <= i);
+            if (!reachable)
+            {
+                table_[hole] = std::move(table_[i]);
+                hole = i;
+            }
+        }
+        return true;
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const_iterator begin() const
+    {
+        return table_ ? const_iterator(table_.get(), table_.get() + capacity_)
+                      : const_iterator(inline_.data(), inline_.data() + size_);
+    }
+
+    const_iterator end() const
+    {
+        return table_ ? const_iterator(table_.get() + capacity_, table_.get() + capacity_)
+                      : const_iterator(inline_.data() + size_, inline_.data() + size_);
+    }
+
+private:
+    // Table capacity when the inline entries first spill over
+    static constexpr std::uint32_t FIRST_CAPACITY = N * 4 < 8 ? 8 : static_cast<std::uint32_t>(N * 4);
+
+    std::size_t home(std::string_view id) const
+    {
+        return std::hash<std::string_view>()(id) & (capacity_ - 1);
+    }
+
+    std::size_t next(std::size_t slot) const
+    {
+        return (slot + 1) & (capacity_ - 1);
+    }
+
+    // Caller has checked the ID is absent and that there is room
+    void place(std::shared_ptr<T> value)
+    {
+        std::size_t slot = home(value->getId());
+        while (table_[slot])
+        {
+            slot = next(slot);
+        }
+        table_[slot] = std::move(value);
+    }
+
+    void grow()
+    {
+        std::uint32_t oldCapacity = capacity_;
+        std::unique_ptr<std::shared_ptr<T>[]> old = std::move(table_);
+        capacity_ = old ? oldCapacity * 2 : FIRST_CAPACITY;
+        table_.reset(new std::shared_ptr<T>[capacity_]);
+
+        if (old)
+        {
+            for (std::uint32_t i = 0; i < oldCapacity; ++i)
+            {
+                if (old[i])
+                {
+                    place(std::move(old[i]));
+                }
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < size_; ++i)
+            {
+                place(std::move(inline_[i]));
+            }
+        }
+    }
+
+    std::array<std::shared_ptr<T>, N> inline_;     // Packed at the front; unused once table_ is set
+    std::unique_ptr<std::shared_ptr<T>[]> table_;  // capacity_ slots; null while entries fit inline
+    std::uint32_t size_ = 0;
+    std::uint32_t capacity_ = 0;
+};
@@ -1,27 +1,125 @@
 #pragma once
 #include <atomic>
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
-#include <sstream>
-#include <iomanip>
+#include <string_view>
 
 class IDGenerator
 {
 public:
+    static constexpr std::size_t MAX_LENGTH = 31;
+
+    // Formatted identifier held inline, together with its numeric value so
+    // hot paths can skip the string entirely.
+    class ID
+    {
+    public:
+        std::uint64_t value() const { return value_; }
+        std::string_view view() const { return std::string_view(chars_, length_); }
+        std::string str() const { return std::string(chars_, length_); }
+        operator std::string() const { return str(); }
+
+    private:
+        friend class IDGenerator;
+        char chars_[MAX_LENGTH + 1];
+        std::uint8_t length_;
+        std::uint64_t value_;
+    };
+
     IDGenerator(const std::string &prefix, int digits)
-        : prefix_(prefix), digits_(digits), counter_(0) {}
+        : prefixLength_(prefix.size()), digits_(digits < 0 ? 0 : static_cast<std::size_t>(digits)), counter_(0)
+    {
+        // Room for the prefix and the widest 64-bit counter
+        if (prefixLength_ + (digits_ > 20 ? digits_ : 20) > MAX_LENGTH)
+        {
+            throw std::invalid_argument("ID prefix and width exceed " + std::to_string(MAX_LENGTH) + " characters");
+        }
+        prefix.copy(prefix_, prefixLength_);
+    }
+
+    // Wait-free: a single fetch_add, then formatting on the caller's stack
+    ID next() { return format(nextValue()); }
+    std::uint64_t nextValue() { return counter_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    // Makes sure next() never again returns value or anything below it, so
+    // IDs restored from storage cannot be handed out twice
+    void advancePast(std::uint64_t value)
+    {
+        std::uint64_t current = counter_.load(std::memory_order_relaxed);
+        while (current < value && !counter_.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
 
-    std::string next()
+    // For an ID restored from storage: if this generator formatted it,
+    // advancePast its counter. IDs in any other form are left alone.
+    void observe(std::string_view id)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::stringstream ss;
-        ss << prefix_ << std::setfill('0') << std::setw(digits_) << ++counter_;
-        return ss.str();
+        std::uint64_t value;
+        if (parse(id, value))
+        {
+            advancePast(value);
+        }
+    }
+
+    // Reads the counter back out of an ID this generator formatted; false
+    // when id does not have the prefix followed by digits
+    bool parse(std::string_view id, std::uint64_t &value) const
+    {
+        if (id.size() <= prefixLength_ || id.compare(0, prefixLength_, std::string_view(prefix_, prefixLength_)) != 0)
+        {
+            return false;
+        }
+        std::uint64_t result = 0;
+        for (char c : id.substr(prefixLength_))
+        {
+            if (c < '0' || c > '9' || result > (UINT64_MAX - 9) / 10)
+            {
+                return false;
+            }
+            result = result * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        value = result;
+        return true;
+    }
+
+    // Formats value as prefix followed by the zero-padded counter
+    ID format(std::uint64_t value) const
+    {
+        ID id;
+        id.value_ = value;
+
+        char digits[20];
+        std::size_t count = 0;
+        do
+        {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        char *out = id.chars_;
+        for (std::size_t i = 0; i < prefixLength_; ++i)
+        {
+            *out++ = prefix_[i];
+        }
+        for (std::size_t i = count; i < digits_; ++i)
+        {
+            *out++ = '0';
+        }
+        while (count != 0)
+        {
+            *out++ = digits[--count];
+        }
+        *out = '\0';
+        id.length_ = static_cast<std::uint8_t>(out - id.chars_);
+        return id;
     }
 
 private:
-    std::string prefix_;
-    int digits_;
+    char prefix_[MAX_LENGTH];
+    std::size_t prefixLength_;
+    std::size_t digits_;
     std::atomic<uint64_t> counter_;
-    std::mutex mutex_;
-};
\ No newline at end of file
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct LocalStoreOptions
+{
+    // fdatasync after every put and remove; otherwise writes reach disk on
+    // sync(), compaction and close
+    bool syncEachWrite = false;
+    // Compact once the space held by overwritten and removed values passes
+    // this and also exceeds the space held by live ones
+    std::uint64_t compactThreshold = 4 << 20;
+};
+
+// Embedded key-value store in a single log-structured file. After an 8-byte
+// header ("MLST", u32 version) the file is a sequence of records
+//
+//     [u32 length][u32 crc32 of payload][payload]
+//     payload: [u8 kind][u32 key length][key][value]
+//
+// all little-endian, where kind is 0 for a put and 1 for a removal. Every
+// write appends a record; an in-memory index maps each live key to where
+// its latest value sits, so a lookup is one hash probe and one pread.
+// Opening replays the file to rebuild the index and cuts off a tail torn by
+// a crash, as JournalLog does: a damaged record is cut off only when no
+// complete record follows it, and otherwise open() throws. Compaction rewrites the live records into a
+// fresh file and renames it over the old one.
+//
+// Thread-safe; lookups run concurrently with each other and wait only for
+// writes to the index and for compaction.
+class LocalStore
+{
+public:
+    // Called with each key and value; the views are valid only during the call
+    using Visitor = std::function<void(std::string_view key, std::string_view value)>;
+
+    // Opens or creates the store at path. Throws std::runtime_error if the
+    // file cannot be used or is not a store.
+    static std::shared_ptr<LocalStore> open(const std::string &path,
+                                            const LocalStoreOptions &options = LocalStoreOptions());
+
+    // Syncs and closes the file
+    ~LocalStore();
+
+    LocalStore(const LocalStore &) = delete;
+    LocalStore &operator=(const LocalStore &) = delete;
+
+    // Throws std::invalid_argument for an empty key and std::runtime_error
+    // if the write fails
+    void put(std::string_view key, std::string_view value);
+
+    // Copies the value for key into value; false if there is none
+    bool get(std::string_view key, std::string &value) const;
+    bool contains(std::string_view key) const;
+
+    // False if key was not there
+    bool remove(std::string_view key);
+
+    // Visits every key starting with prefix, in no particular order. The
+    // store is locked against writes meanwhile, so visit must not write.
+    void forEach(std::string_view prefix, const Visitor &visit) const;
+
+    // Waits until every write so far is on disk
+    void sync();
+
+    // Rewrites the file with only the live records
+    void compact();
+
+    const std::string &getPath() const { return path_; }
+    std::size_t size() const;
+    std::uint64_t getLiveBytes() const;
+    std::uint64_t getDeadBytes() const;
+
+    // What opening the store found
+    std::size_t getReplayedCount() const { return replayed_; }
+    std::uint64_t getTruncatedBytes() const { return truncated_; }
+
+private:
+    static constexpr char MAGIC[4] = {'M', 'L', 'S', 'T'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::size_t HEADER_SIZE = 8;
+    static constexpr std::size_t RECORD_HEADER_SIZE = 8;
+    static constexpr std::uint8_t PUT = 0;
+    static constexpr std::uint8_t REMOVE = 1;
+
+    // Where the latest record for a key sits
+    struct Location
+    {
+        std::uint64_t record;     // File offset of the record
+        std::uint32_t recordSize; // Header included
+        std::uint32_t valueSize;  // Value is the last valueSize bytes
+    };
+
+    LocalStore(const std::string &path, int fd, const LocalStoreOptions &options);
+
+    // Rebuilds the index from a size-byte file, returning the offset just
+    // past the last complete record. Throws std::runtime_error for damage
+    // before the last record.
+    std::uint64_t replay(std::uint64_t size);
+
+    static void encode(std::uint8_t kind, std::string_view key, std::string_view value, std::vector<char> &out);
+
+    // Callers hold mutex_ exclusively
+    void append(const std::vector<char> &record);
+    void drop(const Location &location);
+    void maybeCompact();
+    void rewrite();
+    void readAt(std::uint64_t offset, char *out, std::size_t size) const;
+
+    std::string path_;
+    int fd_;
+    LocalStoreOptions options_;
+    std::size_t replayed_;
+    std::uint64_t truncated_;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, Location> index_;
+    std::uint64_t end_;       // File size; the next record goes here
+    std::uint64_t liveBytes_; // Records the index points at
+};
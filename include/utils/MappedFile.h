@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Read-only memory mapping of a whole file. The pages are shared with the
+// page cache, so opening costs nothing until they are touched and several
+// processes mapping the same file share one copy.
+class MappedFile
+{
+public:
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    static std::shared_ptr<MappedFile> open(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Page-aligned start of the file, or null for an empty file
+    const char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string &getPath() const { return path_; }
+
+private:
+    MappedFile(const std::string &path, const char *data, std::size_t size)
+        : path_(path), data_(data), size_(size) {}
+
+    std::string path_;
+    const char *data_;
+    std::size_t size_;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Non-owning view of a contiguous sequence; a stand-in for C++20 std::span.
+// Converts implicitly from any container with data() and size(), so APIs can
+// take a Span and still be called with a std::vector.
+template <typename T>
+class Span
+{
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T *;
+
+    constexpr Span() = default;
+    constexpr Span(T *data, std::size_t size) : data_(data), size_(size) {}
+
+    template <typename Container,
+              typename = std::enable_if_t<
+                  !std::is_same_v<std::decay_t<Container>, Span> &&
+                  std::is_convertible_v<decltype(std::declval<Container &>().data()), T *>>>
+    constexpr Span(Container &&container) : data_(container.data()), size_(container.size())
+    {
+    }
+
+    constexpr T *data() const { return data_; }
+    constexpr std::size_t size() const { return size_; }
+    constexpr bool empty() const { return size_ == 0; }
+
+    constexpr T *begin() const { return data_; }
+    constexpr T *end() const { return data_ + size_; }
+
+    constexpr T &operator[](std::size_t index) const { return data_[index]; }
+    constexpr T &front() const { return data_[0]; }
+    constexpr T &back() const { return data_[size_ - 1]; }
+
+    // Elements [offset, offset + count), clamped to the end of the view
+    constexpr Span subspan(std::size_t offset, std::size_t count) const
+    {
+        if (offset > size_)
+        {
+            offset = size_;
+        }
+        if (count > size_ - offset)
+        {
+            count = size_ - offset;
+        }
+        return Span(data_ + offset, count);
+    }
+
+private:
+    T *data_ = nullptr;
+    std::size_t size_ = 0;
+};
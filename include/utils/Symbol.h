@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Process-wide interning table mapping identifier strings to dense 32-bit
+// handles. Handles are never reused, so the strings they name stay valid for
+// the lifetime of the process. Handle 0 is the empty string.
+class SymbolTable
+{
+public:
+    static constexpr std::uint32_t NOT_FOUND = 0xFFFFFFFFu;
+
+    static SymbolTable &instance();
+
+    std::uint32_t intern(std::string_view name);
+    std::uint32_t find(std::string_view name) const;
+    const std::string &name(std::uint32_t id) const;
+    std::size_t size() const;
+
+private:
+    SymbolTable();
+    SymbolTable(const SymbolTable &) = delete;
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, std::uint32_t> ids_;
+};
+
+// Interned identifier, a 32-bit handle that compares and hashes as an
+// integer. Constructing one from a string interns it, so this is explicit
+// and meant for names being written; lookups use find(), which never adds
+// to the table. Converts implicitly back to a string.
+class Symbol
+{
+public:
+    Symbol() : id_(0) {}
+    explicit Symbol(const std::string &name) : id_(SymbolTable::instance().intern(name)) {}
+    explicit Symbol(const char *name) : id_(SymbolTable::instance().intern(name)) {}
+
+    static Symbol fromId(std::uint32_t id)
+    {
+        Symbol symbol;
+        symbol.id_ = id;
+        return symbol;
+    }
+
+    // Interns name, which need not be null-terminated; for names read
+    // straight out of a buffer
+    static Symbol intern(std::string_view name)
+    {
+        return fromId(SymbolTable::instance().intern(name));
+    }
+
+    // The symbol already interned for name, or one that no map holds (and
+    // that has no string) if name was never interned
+    static Symbol find(std::string_view name)
+    {
+        return fromId(SymbolTable::instance().find(name));
+    }
+
+    std::uint32_t getId() const { return id_; }
+    const std::string &str() const { return SymbolTable::instance().name(id_); }
+    operator const std::string &() const { return str(); }
+    bool empty() const { return id_ == 0; }
+
+    bool operator==(const Symbol &other) const { return id_ == other.id_; }
+    bool operator!=(const Symbol &other) const { return id_ != other.id_; }
+    bool operator<(const Symbol &other) const { return id_ < other.id_; }
+
+private:
+    std::uint32_t id_;
+};
+
+inline std::ostream &operator<<(std::ostream &out, const Symbol &symbol)
+{
+    return out << symbol.str();
+}
+
+namespace std
+{
+    template <>
+    struct hash<Symbol>
+    {
+        std::size_t operator()(const Symbol &symbol) const noexcept { return symbol.getId(); }
+    };
+}
+
+// Map keyed by Symbol. Values live contiguously in insertion order; a small
+// hash index from symbol to slot, sized by this map's own keys rather than
+// by the symbol table, makes a lookup one integer hash instead of a string
+// hash.
+template <typename T>
+class SymbolMap
+{
+public:
+    T *find(Symbol key)
+    {
+        std::uint32_t slot = slotOf(key);
+        return slot == NO_SLOT ? nullptr : &values_[slot];
+    }
+
+    const T *find(Symbol key) const
+    {
+        std::uint32_t slot = slotOf(key);
+        return slot == NO_SLOT ? nullptr : &values_[slot];
+    }
+
+    T &operator[](Symbol key)
+    {
+        std::uint32_t slot = slotOf(key);
+        if (slot == NO_SLOT)
+        {
+            slot = static_cast<std::uint32_t>(values_.size());
+            slots_.emplace(key, slot);
+            keys_.push_back(key);
+            values_.emplace_back();
+        }
+        return values_[slot];
+    }
+
+    std::size_t size() const { return values_.size(); }
+    const std::vector<Symbol> &keys() const { return keys_; }
+    std::vector<T> &values() { return values_; }
+    const std::vector<T> &values() const { return values_; }
+
+private:
+    static constexpr std::uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+    std::uint32_t slotOf(Symbol key) const
+    {
+        auto it = slots_.find(key);
+        return it != slots_.end() ? it->second : NO_SLOT;
+    }
+
+    std::unordered_map<Symbol, std::uint32_t> slots_;
+    std::vector<Symbol> keys_;
+    std::vector<T> values_;
+};
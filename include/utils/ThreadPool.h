@@ -0,0 +1,56 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. Work is split into
+// chunks whose boundaries depend only on the count and grain, never on the
+// number of threads, so per-chunk results reduced in chunk order are the same
+// on every machine.
+class ThreadPool
+{
+public:
+    // fn(chunk, begin, end) processes elements [begin, end) of chunk
+    using ChunkFn = std::function<void(std::size_t chunk, std::size_t begin, std::size_t end)>;
+
+    // threads == 0 uses one thread per hardware core
+    static std::shared_ptr<ThreadPool> create(std::size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t getThreadCount() const { return workers_.size(); }
+
+    // Grain for loops over accounts: the reports, their sections and the
+    // balance cache all chunk by this. Fixed, so totals reduce the same way
+    // whatever the pool size.
+    static constexpr std::size_t ACCOUNT_GRAIN = 4096;
+
+    // Number of chunks parallelFor splits count elements into
+    static std::size_t chunkCount(std::size_t count, std::size_t grain);
+
+    // Runs fn over [0, count) in chunks of grain elements. The calling
+    // thread works too, so nested calls from a worker cannot deadlock.
+    // Returns once every chunk has finished, rethrowing the first exception
+    // a chunk threw.
+    void parallelFor(std::size_t count, std::size_t grain, const ChunkFn &fn);
+
+    // As above on pool, or inline on the calling thread when pool is null
+    static void parallelFor(ThreadPool *pool, std::size_t count, std::size_t grain, const ChunkFn &fn);
+
+private:
+    explicit ThreadPool(std::size_t threads);
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    bool stopping_;
+};
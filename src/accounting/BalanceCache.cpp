@@ -0,0 +1,90 @@
+#include "accounting/BalanceCache.h"
+#include <stdexcept>
+
+namespace market
+{
+    namespace accounting
+    {
+
+        void BalanceCache::request(Symbol accountId, const TimePoint &asOf)
+        {
+            for (auto &group : groups_)
+            {
+                if (group.asOf == asOf)
+                {
+                    if (!group.balances.find(accountId))
+                    {
+                        group.balances[accountId] = 0;
+                        resolved_ = false;
+                    }
+                    return;
+                }
+            }
+            groups_.push_back(Group{asOf, {}});
+            groups_.back().balances[accountId] = 0;
+            resolved_ = false;
+        }
+
+        void BalanceCache::resolve(const Ledger &ledger, ThreadPool *pool)
+        {
+            resolve(ledger.snapshot(), pool);
+        }
+
+        void BalanceCache::resolve(const Ledger::Snapshot &snapshot, ThreadPool *pool)
+        {
+            for (auto &group : groups_)
+            {
+                const auto &accountIds = group.balances.keys();
+                auto &balances = group.balances.values();
+                bool current = group.asOf == CURRENT;
+                ThreadPool::parallelFor(pool, accountIds.size(), ThreadPool::ACCOUNT_GRAIN, [&](std::size_t, std::size_t begin, std::size_t end)
+                                        {
+                    for (std::size_t i = begin; i < end; ++i)
+                    {
+                        // The running totals answer CURRENT without a search
+                        balances[i] = (current ? snapshot.getBalance(accountIds[i])
+                                               : snapshot.getBalance(accountIds[i], group.asOf))
+                                          .toRaw();
+                    } });
+            }
+            sequence_ = snapshot.getSequence();
+            resolved_ = true;
+        }
+
+        Decimal BalanceCache::getBalance(Symbol accountId, const TimePoint &asOf) const
+        {
+            return Decimal::fromRaw(getRawBalance(accountId, asOf));
+        }
+
+        std::int64_t BalanceCache::getRawBalance(Symbol accountId, const TimePoint &asOf) const
+        {
+            if (!resolved_)
+            {
+                throw std::logic_error("Balances have not been resolved");
+            }
+            for (const auto &group : groups_)
+            {
+                if (group.asOf == asOf)
+                {
+                    if (const auto *balance = group.balances.find(accountId))
+                    {
+                        return *balance;
+                    }
+                    break;
+                }
+            }
+            throw std::out_of_range("Balance was not requested: " + accountId.str());
+        }
+
+        std::size_t BalanceCache::size() const
+        {
+            std::size_t count = 0;
+            for (const auto &group : groups_)
+            {
+                count += group.balances.size();
+            }
+            return count;
+        }
+
+    } // namespace accounting
+} // namespace market
@@ -0,0 +1,251 @@
+#include "accounting/BalanceKernel.h"
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MARKET_BALANCE_KERNEL_X86 1
+#include <immintrin.h>
+#else
+#define MARKET_BALANCE_KERNEL_X86 0
+#endif
+
+namespace market::accounting
+{
+
+    namespace
+    {
+        struct Kernels
+        {
+            BalanceKernel::Isa isa;
+            std::int64_t (*sum)(const std::int64_t *, std::size_t);
+            std::int64_t (*sumUntil)(const std::int64_t *, const std::int64_t *, std::size_t, std::int64_t);
+            void (*sumBySign)(const std::int64_t *, std::size_t, std::int64_t &, std::int64_t &);
+        };
+
+        // The vector adds wrap around on overflow. Signed overflow is
+        // undefined in C++, so every scalar add goes through uint64_t to
+        // wrap the same way and keep the results identical on every ISA.
+        std::int64_t add(std::int64_t a, std::int64_t b)
+        {
+            return static_cast<std::int64_t>(static_cast<std::uint64_t>(a) + static_cast<std::uint64_t>(b));
+        }
+
+        // Scalar reference implementations; also handle the tails left over
+        // by the vector loops.
+
+        std::int64_t sumScalar(const std::int64_t *amounts, std::size_t count)
+        {
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                total += static_cast<std::uint64_t>(amounts[i]);
+            }
+            return static_cast<std::int64_t>(total);
+        }
+
+        std::int64_t sumUntilScalar(const std::int64_t *amounts, const std::int64_t *timestamps,
+                                    std::size_t count, std::int64_t cutoff)
+        {
+            std::uint64_t total = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                total += timestamps[i] <= cutoff ? static_cast<std::uint64_t>(amounts[i]) : 0;
+            }
+            return static_cast<std::int64_t>(total);
+        }
+
+        void sumBySignScalar(const std::int64_t *values, std::size_t count,
+                             std::int64_t &positive, std::int64_t &negative)
+        {
+            std::uint64_t pos = 0;
+            std::uint64_t neg = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                std::uint64_t value = static_cast<std::uint64_t>(values[i]);
+                pos += values[i] > 0 ? value : 0;
+                neg += values[i] < 0 ? value : 0;
+            }
+            positive = static_cast<std::int64_t>(pos);
+            negative = static_cast<std::int64_t>(neg);
+        }
+
+        const Kernels SCALAR_KERNELS{BalanceKernel::Isa::SCALAR, sumScalar, sumUntilScalar, sumBySignScalar};
+
+#if MARKET_BALANCE_KERNEL_X86
+
+        __attribute__((target("sse4.2"))) std::int64_t horizontalSum(__m128i value)
+        {
+            return add(_mm_cvtsi128_si64(value), _mm_extract_epi64(value, 1));
+        }
+
+        __attribute__((target("sse4.2"))) std::int64_t sumSse42(const std::int64_t *amounts, std::size_t count)
+        {
+            __m128i acc0 = _mm_setzero_si128();
+            __m128i acc1 = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                acc0 = _mm_add_epi64(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(amounts + i)));
+                acc1 = _mm_add_epi64(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(amounts + i + 2)));
+            }
+            return add(horizontalSum(_mm_add_epi64(acc0, acc1)), sumScalar(amounts + i, count - i));
+        }
+
+        __attribute__((target("sse4.2"))) std::int64_t sumUntilSse42(const std::int64_t *amounts, const std::int64_t *timestamps,
+                                                                     std::size_t count, std::int64_t cutoff)
+        {
+            const __m128i limit = _mm_set1_epi64x(cutoff);
+            __m128i acc = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                __m128i after = _mm_cmpgt_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(timestamps + i)), limit);
+                __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(amounts + i));
+                acc = _mm_add_epi64(acc, _mm_andnot_si128(after, values));
+            }
+            return add(horizontalSum(acc), sumUntilScalar(amounts + i, timestamps + i, count - i, cutoff));
+        }
+
+        __attribute__((target("sse4.2"))) void sumBySignSse42(const std::int64_t *values, std::size_t count,
+                                                              std::int64_t &positive, std::int64_t &negative)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i pos = _mm_setzero_si128();
+            __m128i neg = _mm_setzero_si128();
+            std::size_t i = 0;
+            for (; i + 2 <= count; i += 2)
+            {
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+                __m128i isNegative = _mm_cmpgt_epi64(zero, value);
+                pos = _mm_add_epi64(pos, _mm_andnot_si128(isNegative, value));
+                neg = _mm_add_epi64(neg, _mm_and_si128(isNegative, value));
+            }
+            sumBySignScalar(values + i, count - i, positive, negative);
+            positive = add(positive, horizontalSum(pos));
+            negative = add(negative, horizontalSum(neg));
+        }
+
+        __attribute__((target("avx2"))) std::int64_t horizontalSum(__m256i value)
+        {
+            __m128i folded = _mm_add_epi64(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+            return add(_mm_cvtsi128_si64(folded), _mm_extract_epi64(folded, 1));
+        }
+
+        __attribute__((target("avx2"))) std::int64_t sumAvx2(const std::int64_t *amounts, std::size_t count)
+        {
+            __m256i acc0 = _mm256_setzero_si256();
+            __m256i acc1 = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i)));
+                acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i + 4)));
+            }
+            return add(horizontalSum(_mm256_add_epi64(acc0, acc1)), sumScalar(amounts + i, count - i));
+        }
+
+        __attribute__((target("avx2"))) std::int64_t sumUntilAvx2(const std::int64_t *amounts, const std::int64_t *timestamps,
+                                                                  std::size_t count, std::int64_t cutoff)
+        {
+            const __m256i limit = _mm256_set1_epi64x(cutoff);
+            __m256i acc = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i after = _mm256_cmpgt_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(timestamps + i)), limit);
+                __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(amounts + i));
+                acc = _mm256_add_epi64(acc, _mm256_andnot_si256(after, values));
+            }
+            return add(horizontalSum(acc), sumUntilScalar(amounts + i, timestamps + i, count - i, cutoff));
+        }
+
+        __attribute__((target("avx2"))) void sumBySignAvx2(const std::int64_t *values, std::size_t count,
+                                                           std::int64_t &positive, std::int64_t &negative)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i pos = _mm256_setzero_si256();
+            __m256i neg = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+                __m256i isNegative = _mm256_cmpgt_epi64(zero, value);
+                pos = _mm256_add_epi64(pos, _mm256_andnot_si256(isNegative, value));
+                neg = _mm256_add_epi64(neg, _mm256_and_si256(isNegative, value));
+            }
+            sumBySignScalar(values + i, count - i, positive, negative);
+            positive = add(positive, horizontalSum(pos));
+            negative = add(negative, horizontalSum(neg));
+        }
+
+        const Kernels SSE42_KERNELS{BalanceKernel::Isa::SSE42, sumSse42, sumUntilSse42, sumBySignSse42};
+        const Kernels AVX2_KERNELS{BalanceKernel::Isa::AVX2, sumAvx2, sumUntilAvx2, sumBySignAvx2};
+
+#endif
+
+        const Kernels *select(BalanceKernel::Isa requested)
+        {
+#if MARKET_BALANCE_KERNEL_X86
+            __builtin_cpu_init();
+            if (requested == BalanceKernel::Isa::AVX2 && __builtin_cpu_supports("avx2"))
+            {
+                return &AVX2_KERNELS;
+            }
+            if (requested != BalanceKernel::Isa::SCALAR && __builtin_cpu_supports("sse4.2"))
+            {
+                return &SSE42_KERNELS;
+            }
+#else
+            (void)requested;
+#endif
+            return &SCALAR_KERNELS;
+        }
+
+        std::atomic<const Kernels *> &active()
+        {
+            static std::atomic<const Kernels *> kernels{select(BalanceKernel::Isa::AVX2)};
+            return kernels;
+        }
+    }
+
+    std::int64_t BalanceKernel::sum(const std::int64_t *amounts, std::size_t count)
+    {
+        return active().load(std::memory_order_relaxed)->sum(amounts, count);
+    }
+
+    std::int64_t BalanceKernel::sumUntil(const std::int64_t *amounts, const std::int64_t *timestamps,
+                                         std::size_t count, std::int64_t cutoff)
+    {
+        return active().load(std::memory_order_relaxed)->sumUntil(amounts, timestamps, count, cutoff);
+    }
+
+    void BalanceKernel::sumBySign(const std::int64_t *values, std::size_t count,
+                                  std::int64_t &positive, std::int64_t &negative)
+    {
+        active().load(std::memory_order_relaxed)->sumBySign(values, count, positive, negative);
+    }
+
+    BalanceKernel::Isa BalanceKernel::getIsa()
+    {
+        return active().load(std::memory_order_relaxed)->isa;
+    }
+
+    const char *BalanceKernel::getIsaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::SSE42:
+            return "sse4.2";
+        case Isa::SCALAR:
+            break;
+        }
+        return "scalar";
+    }
+
+    void BalanceKernel::setIsa(Isa isa)
+    {
+        active().store(select(isa), std::memory_order_relaxed);
+    }
+
+} // namespace market::accounting
@@ -2,6 +2,9 @@
 #include "utils/IDGenerator.h"
 #include <memory>
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <initializer_list>
 
 namespace market
 {
@@ -13,65 +16,115 @@ namespace market
         std::shared_ptr<BalanceSheet> BalanceSheet::create(
             const std::string &name,
             std::shared_ptr<Ledger> ledger,
-            const std::chrono::system_clock::time_point &asOf)
+            const std::chrono::system_clock::time_point &asOf,
+            std::shared_ptr<ThreadPool> pool)
         {
             if (name.empty())
                 throw std::invalid_argument("BalanceSheet name cannot be empty");
             if (!ledger)
                 throw std::invalid_argument("Ledger cannot be null");
-            return std::shared_ptr<BalanceSheet>(new BalanceSheet(idGen_.next(), name, ledger, asOf));
+            return std::shared_ptr<BalanceSheet>(new BalanceSheet(idGen_.next(), name, ledger, asOf, pool));
         }
 
         BalanceSheet::BalanceSheet(
             const std::string &id,
             const std::string &name,
             std::shared_ptr<Ledger> ledger,
-            const std::chrono::system_clock::time_point &asOf) : id_(id), name_(name), ledger_(ledger), asOf_(asOf) {}
+            const std::chrono::system_clock::time_point &asOf,
+            std::shared_ptr<ThreadPool> pool) : id_(id), name_(name), ledger_(ledger), asOf_(asOf), pool_(pool) {}
 
-        void BalanceSheet::addAssetAccount(const std::string &accountId, const std::string &accountName, bool isDebit)
+        void BalanceSheet::addAssetAccount(Symbol accountId, const std::string &accountName, bool isDebit)
         {
             updateSection(assets_, accountId, accountName, isDebit);
             accountTypes_[accountId] = isDebit;
-            calculateTotals();
         }
 
-        void BalanceSheet::addLiabilityAccount(const std::string &accountId, const std::string &accountName, bool isDebit)
+        void BalanceSheet::addLiabilityAccount(Symbol accountId, const std::string &accountName, bool isDebit)
         {
             updateSection(liabilities_, accountId, accountName, isDebit);
             accountTypes_[accountId] = isDebit;
-            calculateTotals();
         }
 
-        void BalanceSheet::addEquityAccount(const std::string &accountId, const std::string &accountName, bool isDebit)
+        void BalanceSheet::addEquityAccount(Symbol accountId, const std::string &accountName, bool isDebit)
         {
             updateSection(equity_, accountId, accountName, isDebit);
             accountTypes_[accountId] = isDebit;
-            calculateTotals();
         }
 
-        void BalanceSheet::updateSection(Section &section, const std::string &accountId, const std::string &accountName, bool isDebit)
+        void BalanceSheet::updateSection(Section &section, Symbol accountId, const std::string &accountName, bool isDebit)
         {
             Decimal balance = ledger_->getBalance(accountId, asOf_);
             section.accounts.push_back({accountId, accountName, balance, isDebit});
+            section.total = section.total + balance;
         }
 
-        void BalanceSheet::calculateTotals()
+        void BalanceSheet::refresh()
         {
-            assets_.total = Decimal(0);
-            for (const auto &acc : assets_.accounts)
+            BalanceCache balances;
+            collectBalanceRequests(balances);
+            balances.resolve(*ledger_, pool_.get());
+            compute(balances);
+        }
+
+        void BalanceSheet::collectBalanceRequests(BalanceCache &balances) const
+        {
+            for (const Section *section : {&assets_, &liabilities_, &equity_})
             {
-                assets_.total = assets_.total + acc.balance;
+                for (const auto &acc : section->accounts)
+                {
+                    balances.request(acc.accountId, asOf_);
+                }
             }
-            liabilities_.total = Decimal(0);
-            for (const auto &acc : liabilities_.accounts)
+        }
+
+        void BalanceSheet::compute(const BalanceCache &balances)
+        {
+            computeSection(balances, assets_);
+            computeSection(balances, liabilities_);
+            computeSection(balances, equity_);
+        }
+
+        void BalanceSheet::computeSection(const BalanceCache &balances, Section &section)
+        {
+            std::size_t chunks = ThreadPool::chunkCount(section.accounts.size(), ThreadPool::ACCOUNT_GRAIN);
+            std::vector<std::int64_t> chunkTotals(chunks, 0);
+            ThreadPool::parallelFor(pool_.get(), section.accounts.size(), ThreadPool::ACCOUNT_GRAIN, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                                    {
+                std::int64_t total = 0;
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    auto &account = section.accounts[i];
+                    account.balance = balances.getBalance(account.accountId, asOf_);
+                    total += account.balance.toRaw();
+                }
+                chunkTotals[chunk] = total; });
+
+            // Reduce in chunk order so the total does not depend on scheduling
+            std::int64_t total = 0;
+            for (std::int64_t chunkTotal : chunkTotals)
             {
-                liabilities_.total = liabilities_.total + acc.balance;
+                total += chunkTotal;
             }
-            equity_.total = Decimal(0);
-            for (const auto &acc : equity_.accounts)
+            section.total = Decimal::fromRaw(total);
+        }
+
+        void BalanceSheet::write(ReportWriter &writer) const
+        {
+            writer.beginReport("BALANCE SHEET", {"Balance"});
+            for (const Section *section : {&assets_, &liabilities_, &equity_})
             {
-                equity_.total = equity_.total + acc.balance;
+                std::string name = section->name;
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c)
+                               { return static_cast<char>(std::toupper(c)); });
+                writer.beginSection(name);
+                for (const auto &acc : section->accounts)
+                {
+                    writer.row(acc.accountId, acc.accountName, {acc.balance});
+                }
+                writer.endSection("Total " + section->name, {section->total});
             }
+            writer.status(isBalanced() ? "BALANCED" : "NOT BALANCED");
+            writer.endReport();
         }
 
     } // namespace accounting
@@ -0,0 +1,172 @@
+#include "accounting/EntryCodec.h"
+#include <stdexcept>
+
+namespace market
+{
+    namespace accounting
+    {
+        namespace
+        {
+            std::int64_t toNanoseconds(const std::chrono::system_clock::time_point &timestamp)
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+            }
+
+            std::chrono::system_clock::time_point fromNanoseconds(std::int64_t nanoseconds)
+            {
+                return std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+            }
+
+            EntryType toEntryType(std::uint64_t type)
+            {
+                if (type > 1)
+                {
+                    throw std::runtime_error("Unknown entry type in binary record");
+                }
+                return type == 0 ? EntryType::DEBIT : EntryType::CREDIT;
+            }
+        }
+
+        void EntryCodec::encode(const JournalEntry &entry, BinaryWriter &out)
+        {
+            out.writeUint(6, entry.getNumericId());
+            out.writeBytes(2, entry.getTransactionId());
+            out.writeInt(3, toNanoseconds(entry.getTimestamp()));
+            if (!entry.getDescription().empty())
+            {
+                out.writeBytes(4, entry.getDescription());
+            }
+            for (const auto &line : entry.getEntries())
+            {
+                out.writeMessage(5, [&](BinaryWriter &fields)
+                                 {
+                                     fields.writeBytes(1, line.accountId.str());
+                                     fields.writeUint(2, line.type == EntryType::DEBIT ? 0 : 1);
+                                     fields.writeInt(3, line.amount.toRaw());
+                                     if (!line.description.empty())
+                                     {
+                                         fields.writeBytes(4, line.description);
+                                     } });
+            }
+        }
+
+        void EntryCodec::encode(const LedgerEntry &entry, BinaryWriter &out)
+        {
+            out.writeUint(1, entry.getNumericId());
+            out.writeBytes(2, entry.getAccountId().str());
+            out.writeUint(7, entry.getJournalEntryId());
+            out.writeUint(4, entry.getType() == EntryType::DEBIT ? 0 : 1);
+            out.writeInt(5, entry.getAmount().toRaw());
+            out.writeInt(6, toNanoseconds(entry.getTimestamp()));
+        }
+
+        std::shared_ptr<JournalEntry> EntryCodec::decodeJournalEntry(std::string_view data, const std::shared_ptr<Arena> &arena)
+        {
+            std::uint64_t id = 0;
+            std::string transactionId;
+            std::int64_t timestamp = 0;
+            std::string description;
+            std::vector<JournalEntry::Entry> lines;
+
+            BinaryReader reader(data);
+            while (reader.next())
+            {
+                switch (reader.field())
+                {
+                case 2:
+                    transactionId = reader.getBytes();
+                    break;
+                case 3:
+                    timestamp = reader.getInt();
+                    break;
+                case 4:
+                    description = reader.getBytes();
+                    break;
+                case 5:
+                {
+                    JournalEntry::Entry &line = lines.emplace_back();
+                    line.type = EntryType::DEBIT;
+                    BinaryReader fields = reader.getMessage();
+                    while (fields.next())
+                    {
+                        switch (fields.field())
+                        {
+                        case 1:
+                            line.accountId = Symbol::intern(fields.getBytes());
+                            break;
+                        case 2:
+                            line.type = toEntryType(fields.getUint());
+                            break;
+                        case 3:
+                            line.amount = Decimal::fromRaw(fields.getInt());
+                            break;
+                        case 4:
+                            line.description = fields.getBytes();
+                            break;
+                        default:
+                            break;
+                        }
+                    }
+                    break;
+                }
+                case 6:
+                    id = reader.getUint();
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (id == 0 || transactionId.empty())
+            {
+                throw std::runtime_error("Journal entry record has no ID");
+            }
+            return JournalEntry::restore(id, transactionId, lines, description, fromNanoseconds(timestamp), arena);
+        }
+
+        std::shared_ptr<LedgerEntry> EntryCodec::decodeLedgerEntry(std::string_view data, const std::shared_ptr<Arena> &arena)
+        {
+            std::uint64_t id = 0;
+            Symbol accountId;
+            std::uint64_t journalEntryId = 0;
+            EntryType type = EntryType::DEBIT;
+            Decimal amount;
+            std::int64_t timestamp = 0;
+
+            BinaryReader reader(data);
+            while (reader.next())
+            {
+                switch (reader.field())
+                {
+                case 1:
+                    id = reader.getUint();
+                    break;
+                case 2:
+                    accountId = Symbol::intern(reader.getBytes());
+                    break;
+                case 4:
+                    type = toEntryType(reader.getUint());
+                    break;
+                case 5:
+                    amount = Decimal::fromRaw(reader.getInt());
+                    break;
+                case 6:
+                    timestamp = reader.getInt();
+                    break;
+                case 7:
+                    journalEntryId = reader.getUint();
+                    break;
+                default:
+                    break;
+                }
+            }
+            if (id == 0)
+            {
+                throw std::runtime_error("Ledger entry record has no ID");
+            }
+            return LedgerEntry::restore(id, accountId, journalEntryId, type, amount, fromNanoseconds(timestamp), arena);
+        }
+
+    } // namespace accounting
+} // namespace market
@@ -1,6 +1,8 @@
 #include "accounting/Journal.h"
+#include "accounting/JournalLog.h"
 #include "utils/IDGenerator.h"
 #include <stdexcept>
+#include <algorithm>
 
 namespace market
 {
@@ -8,17 +10,17 @@ namespace market
     {
         IDGenerator Journal::idGen_{"JNL", 12};
 
-        std::shared_ptr<Journal> Journal::create(const std::string &name)
+        std::shared_ptr<Journal> Journal::create(const std::string &name, bool periodArena)
         {
             if (name.empty())
             {
                 throw std::invalid_argument("Journal name cannot be empty");
             }
-            return std::shared_ptr<Journal>(new Journal(idGen_.next(), name));
+            return std::shared_ptr<Journal>(new Journal(idGen_.next(), name, periodArena));
         }
 
-        Journal::Journal(const std::string &id, const std::string &name)
-            : id_(id), name_(name) {}
+        Journal::Journal(const std::string &id, const std::string &name, bool periodArena)
+            : id_(id), name_(name), arena_(periodArena ? Arena::create() : nullptr) {}
 
         void Journal::addEntry(std::shared_ptr<JournalEntry> entry)
         {
@@ -26,55 +28,114 @@ namespace market
             {
                 throw std::invalid_argument("Entry cannot be null");
             }
+            if (log_)
+            {
+                log_->write(*entry);
+            }
+            insert(std::move(entry));
+        }
 
-            entries_.push_back(entry);
-            size_t index = entries_.size() - 1;
+        void Journal::addEntries(Span<const std::shared_ptr<JournalEntry>> entries)
+        {
+            for (const auto &entry : entries)
+            {
+                if (!entry)
+                {
+                    throw std::invalid_argument("Entry cannot be null");
+                }
+            }
+            if (log_ && !entries.empty())
+            {
+                std::uint64_t lsn = 0;
+                for (const auto &entry : entries)
+                {
+                    lsn = log_->append(*entry);
+                }
+                log_->waitDurable(lsn);
+            }
+            for (const auto &entry : entries)
+            {
+                insert(entry);
+            }
+        }
+
+        void Journal::insert(std::shared_ptr<JournalEntry> entry)
+        {
+            size_t index = entries_.size();
+            if (timeOrdered_ && index != 0 && entry->getTimestamp() < entries_.back()->getTimestamp())
+            {
+                timeOrdered_ = false;
+                timeIndex_.resize(index);
+                for (size_t i = 0; i < index; ++i)
+                {
+                    timeIndex_[i] = i;
+                }
+            }
+            if (!timeOrdered_)
+            {
+                // Usually only a little late, so this lands near the end
+                auto position = std::upper_bound(timeIndex_.begin(), timeIndex_.end(), entry->getTimestamp(),
+                                                 [this](const std::chrono::system_clock::time_point &timestamp, size_t i)
+                                                 { return timestamp < entries_[i]->getTimestamp(); });
+                timeIndex_.insert(position, index);
+            }
 
             // Update indices
             for (const auto &e : entry->getEntries())
             {
                 accountIndex_[e.accountId].push_back(index);
             }
-            transactionIndex_[entry->getTransactionId()].push_back(index);
+            transactionIndex_[std::string_view(entry->getTransactionId())].push_back(index);
+            entries_.push_back(std::move(entry));
         }
 
-        std::vector<std::shared_ptr<JournalEntry>> Journal::getEntries() const
+        std::shared_ptr<JournalEntry> Journal::createEntry(
+            const std::string &transactionId,
+            const std::vector<JournalEntry::Entry> &entries,
+            const std::string &description)
         {
-            return entries_;
+            auto entry = JournalEntry::create(transactionId, entries, description, arena_);
+            addEntry(entry);
+            return entry;
         }
 
-        std::vector<std::shared_ptr<JournalEntry>> Journal::getEntriesByAccount(const std::string &accountId) const
+        std::vector<std::shared_ptr<JournalEntry>> Journal::closePeriod()
         {
-            std::vector<std::shared_ptr<JournalEntry>> result;
-            auto it = accountIndex_.find(accountId);
-            if (it != accountIndex_.end())
+            std::vector<std::shared_ptr<JournalEntry>> closed;
+            closed.swap(entries_);
+            accountIndex_ = SymbolMap<std::vector<size_t>>();
+            transactionIndex_.clear();
+            timeOrdered_ = true;
+            timeIndex_ = std::vector<size_t>();
+            if (arena_)
             {
-                for (size_t index : it->second)
-                {
-                    result.push_back(entries_[index]);
-                }
+                arena_ = Arena::create();
             }
-            return result;
+            return closed;
         }
 
-        std::vector<std::shared_ptr<JournalEntry>> Journal::getEntriesByTransaction(const std::string &transactionId) const
+        std::vector<std::shared_ptr<JournalEntry>> Journal::getEntriesByAccount(Symbol accountId) const
         {
-            std::vector<std::shared_ptr<JournalEntry>> result;
-            auto it = transactionIndex_.find(transactionId);
-            if (it != transactionIndex_.end())
-            {
-                for (size_t index : it->second)
-                {
-                    result.push_back(entries_[index]);
-                }
-            }
-            return result;
+            const auto *indices = accountIndex_.find(accountId);
+            return indices ? collect(*indices) : std::vector<std::shared_ptr<JournalEntry>>();
+        }
+
+        std::vector<std::shared_ptr<JournalEntry>> Journal::getEntriesByTransaction(std::string_view transactionId) const
+        {
+            auto found = transactionIndex_.find(transactionId);
+            return found != transactionIndex_.end() ? collect(found->second) : std::vector<std::shared_ptr<JournalEntry>>();
         }
 
         std::vector<std::shared_ptr<JournalEntry>> Journal::getEntriesByDateRange(
             const std::chrono::system_clock::time_point &start,
             const std::chrono::system_clock::time_point &end) const
         {
+            if (timeOrdered_)
+            {
+                auto range = timeOrderedRange(start, end);
+                return std::vector<std::shared_ptr<JournalEntry>>(range.begin(), range.end());
+            }
+
             std::vector<std::shared_ptr<JournalEntry>> result;
             for (const auto &entry : entries_)
             {
@@ -87,5 +148,66 @@ namespace market
             return result;
         }
 
+        Journal::EntryRange Journal::getEntryRangeByAccount(Symbol accountId) const
+        {
+            const auto *indices = accountIndex_.find(accountId);
+            return indices ? EntryRange(entries_, *indices) : EntryRange();
+        }
+
+        Journal::EntryRange Journal::getEntryRangeByTransaction(std::string_view transactionId) const
+        {
+            auto found = transactionIndex_.find(transactionId);
+            return found != transactionIndex_.end() ? EntryRange(entries_, found->second) : EntryRange();
+        }
+
+        Journal::EntryRange Journal::getEntryRangeByDateRange(
+            const std::chrono::system_clock::time_point &start,
+            const std::chrono::system_clock::time_point &end) const
+        {
+            if (timeOrdered_)
+            {
+                return EntryRange(timeOrderedRange(start, end));
+            }
+            if (end < start)
+            {
+                return EntryRange();
+            }
+            auto first = std::partition_point(timeIndex_.begin(), timeIndex_.end(), [&](size_t i)
+                                              { return entries_[i]->getTimestamp() < start; });
+            auto last = std::partition_point(first, timeIndex_.end(), [&](size_t i)
+                                             { return entries_[i]->getTimestamp() <= end; });
+            return EntryRange(entries_, Span<const size_t>(timeIndex_.data() + (first - timeIndex_.begin()),
+                                                           static_cast<std::size_t>(last - first)));
+        }
+
+        std::vector<std::shared_ptr<JournalEntry>> Journal::collect(const std::vector<size_t> &indices) const
+        {
+            std::vector<std::shared_ptr<JournalEntry>> result;
+            result.reserve(indices.size());
+            for (size_t index : indices)
+            {
+                result.push_back(entries_[index]);
+            }
+            return result;
+        }
+
+        Span<const std::shared_ptr<JournalEntry>> Journal::timeOrderedRange(
+            const std::chrono::system_clock::time_point &start,
+            const std::chrono::system_clock::time_point &end) const
+        {
+            if (end < start)
+            {
+                return {};
+            }
+            auto first = std::partition_point(entries_.begin(), entries_.end(),
+                                              [&](const std::shared_ptr<JournalEntry> &entry)
+                                              { return entry->getTimestamp() < start; });
+            auto last = std::partition_point(first, entries_.end(),
+                                             [&](const std::shared_ptr<JournalEntry> &entry)
+                                             { return entry->getTimestamp() <= end; });
+            return Span<const std::shared_ptr<JournalEntry>>(entries_.data() + (first - entries_.begin()),
+                                                             static_cast<std::size_t>(last - first));
+        }
+
     } // namespace accounting
 } // namespace market
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "accounting/JournalEntry.h"
+#include <new>
+#include <stdexcept>
 
 IDGenerator market::accounting::JournalEntry::idGen_{"JEN", 12};
 
@@ -8,7 +10,31 @@ namespace market::accounting
     std::shared_ptr<JournalEntry> JournalEntry::create(
         const std::string &transactionId,
         const std::vector<Entry> &entries,
-        const std::string &description)
+        const std::string &description,
+        const std::shared_ptr<Arena> &arena)
+    {
+        validate(entries);
+        return make(idGen_.nextValue(), transactionId, entries, description, std::chrono::system_clock::now(), arena);
+    }
+
+    std::shared_ptr<JournalEntry> JournalEntry::restore(
+        std::uint64_t id,
+        const std::string &transactionId,
+        const std::vector<Entry> &entries,
+        const std::string &description,
+        const std::chrono::system_clock::time_point &timestamp,
+        const std::shared_ptr<Arena> &arena)
+    {
+        if (id == 0)
+        {
+            throw std::invalid_argument("Journal entry ID cannot be zero");
+        }
+        validate(entries);
+        idGen_.advancePast(id);
+        return make(id, transactionId, entries, description, timestamp, arena);
+    }
+
+    void JournalEntry::validate(const std::vector<Entry> &entries)
     {
         if (entries.empty())
         {
@@ -38,15 +64,42 @@ namespace market::accounting
         {
             throw std::invalid_argument("Debits and credits must be equal");
         }
+    }
+
+    std::shared_ptr<JournalEntry> JournalEntry::make(
+        std::uint64_t id,
+        const std::string &transactionId,
+        const std::vector<Entry> &entries,
+        const std::string &description,
+        const std::chrono::system_clock::time_point &timestamp,
+        const std::shared_ptr<Arena> &arena)
+    {
+        if (!arena)
+        {
+            return std::shared_ptr<JournalEntry>(new JournalEntry(
+                id, transactionId, entries, description, timestamp, std::pmr::get_default_resource()));
+        }
 
-        return std::shared_ptr<JournalEntry>(new JournalEntry(idGen_.next(), transactionId, entries, description));
+        void *memory = arena->allocate(sizeof(JournalEntry), alignof(JournalEntry));
+        return Arena::adopt(arena, new (memory) JournalEntry(id, transactionId, entries, description, timestamp, arena.get()));
     }
 
     JournalEntry::JournalEntry(
-        const std::string &id,
+        std::uint64_t id,
         const std::string &transactionId,
         const std::vector<Entry> &entries,
-        const std::string &description)
-        : id_(id), transactionId_(transactionId), entries_(entries), description_(description), timestamp_(std::chrono::system_clock::now()) {}
+        const std::string &description,
+        const std::chrono::system_clock::time_point &timestamp,
+        std::pmr::memory_resource *resource)
+        : id_(id), transactionId_(transactionId, resource), entries_(resource), description_(description, resource), timestamp_(timestamp)
+    {
+        // Copy the descriptions into this entry's resource too; a plain copy
+        // of the lines would leave them on the default heap.
+        entries_.reserve(entries.size());
+        for (const auto &entry : entries)
+        {
+            entries_.push_back(Entry{entry.accountId, entry.type, entry.amount, std::pmr::string(entry.description, resource)});
+        }
+    }
 
 } // namespace market::accounting
\ No newline at end of file
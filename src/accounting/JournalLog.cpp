@@ -0,0 +1,396 @@
+#include "accounting/JournalLog.h"
+#include "accounting/EntryCodec.h"
+#include "accounting/Journal.h"
+#include "accounting/Ledger.h"
+#include "utils/Crc32.h"
+#include "utils/FileIo.h"
+#include "utils/MappedFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace market
+{
+    namespace accounting
+    {
+        namespace
+        {
+            // Replay reads the file in blocks of this size
+            constexpr std::size_t READ_BLOCK = 4 << 20;
+        }
+
+        std::shared_ptr<JournalLog> JournalLog::create(
+            const std::string &path,
+            const Replayer &replay,
+            const JournalLogOptions &options,
+            const std::shared_ptr<Arena> &arena)
+        {
+            // Whether this call made the file, whose directory entry then
+            // has to be synced too
+            bool created = false;
+            int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+            if (fd < 0 && errno == ENOENT)
+            {
+                fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+                created = fd >= 0;
+                if (fd < 0 && errno == EEXIST)
+                {
+                    fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+                }
+            }
+            if (fd < 0)
+            {
+                throw ioError("Cannot open journal log", path);
+            }
+            std::shared_ptr<JournalLog> log(new JournalLog(path, fd, options));
+
+            struct stat info;
+            if (::fstat(fd, &info) != 0)
+            {
+                throw ioError("Cannot stat journal log", path);
+            }
+            std::uint64_t size = static_cast<std::uint64_t>(info.st_size);
+
+            std::uint64_t end = 0;
+            if (size >= HEADER_SIZE)
+            {
+                char header[HEADER_SIZE];
+                if (::pread(fd, header, HEADER_SIZE, 0) != static_cast<ssize_t>(HEADER_SIZE))
+                {
+                    throw ioError("Cannot read journal log", path);
+                }
+                if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0)
+                {
+                    throw std::runtime_error("Not a journal log: " + path);
+                }
+                if (loadUint32(header + sizeof(MAGIC)) != VERSION)
+                {
+                    throw std::runtime_error("Unsupported journal log version in " + path);
+                }
+                end = log->replay(replay, arena, size);
+            }
+            else
+            {
+                // New, or a crash cut the header short; either way it is empty
+                char header[HEADER_SIZE];
+                std::memcpy(header, MAGIC, sizeof(MAGIC));
+                storeUint32(header + sizeof(MAGIC), VERSION);
+                if (::ftruncate(fd, 0) != 0 || ::pwrite(fd, header, HEADER_SIZE, 0) != static_cast<ssize_t>(HEADER_SIZE))
+                {
+                    throw ioError("Cannot write journal log", path);
+                }
+                end = HEADER_SIZE;
+                size = 0;
+            }
+
+            if (end < size)
+            {
+                log->truncated_ = size - end;
+                if (::ftruncate(fd, static_cast<off_t>(end)) != 0)
+                {
+                    throw ioError("Cannot truncate journal log", path);
+                }
+            }
+            if (::fdatasync(fd) != 0)
+            {
+                throw ioError("Cannot sync journal log", path);
+            }
+            if (created)
+            {
+                syncDirectory(path);
+            }
+            if (::lseek(fd, static_cast<off_t>(end), SEEK_SET) < 0)
+            {
+                throw ioError("Cannot seek journal log", path);
+            }
+
+            log->flusher_ = std::thread([raw = log.get()]
+                                        { raw->flusherLoop(); });
+            return log;
+        }
+
+        std::shared_ptr<JournalLog> JournalLog::recover(
+            const std::string &path,
+            Journal &journal,
+            Ledger *ledger,
+            const JournalLogOptions &options)
+        {
+            if (journal.getLog())
+            {
+                throw std::logic_error("Journal already has a log");
+            }
+
+            std::size_t first = journal.getEntries().size();
+            auto log = create(
+                path, [&](std::shared_ptr<JournalEntry> entry)
+                { journal.addEntry(std::move(entry)); },
+                options, journal.getArena());
+
+            if (ledger)
+            {
+                Span<const std::shared_ptr<JournalEntry>> entries(journal.getEntries());
+                ledger->postBatch(entries.subspan(first, entries.size() - first));
+            }
+            journal.attachLog(log);
+            return log;
+        }
+
+        JournalLog::JournalLog(const std::string &path, int fd, const JournalLogOptions &options)
+            : path_(path), fd_(fd), options_(options), replayed_(0), truncated_(0),
+              bufferedRecords_(0), appendedLsn_(0), durableLsn_(0), syncRequested_(false), stopping_(false)
+        {
+        }
+
+        JournalLog::~JournalLog()
+        {
+            if (flusher_.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stopping_ = true;
+                }
+                pending_.notify_one();
+                flusher_.join();
+            }
+            ::close(fd_);
+        }
+
+        std::uint64_t JournalLog::replay(const Replayer &replay, const std::shared_ptr<Arena> &arena, std::uint64_t size)
+        {
+            std::vector<char> block(READ_BLOCK);
+            std::size_t begin = 0;              // First unparsed byte in block
+            std::size_t filled = 0;             // Bytes read into block
+            std::uint64_t offset = HEADER_SIZE; // File offset of block[0]
+            bool eof = false;
+
+            for (;;)
+            {
+                std::size_t available = filled - begin;
+                std::size_t needed = RECORD_HEADER_SIZE;
+                if (available >= RECORD_HEADER_SIZE)
+                {
+                    needed += loadUint32(block.data() + begin);
+                }
+
+                // A length running past the end of the file is a torn write,
+                // unless it is the length that is damaged
+                std::uint64_t start = offset + begin;
+                if (start + needed > size)
+                {
+                    if (recordFollows(start, size))
+                    {
+                        throw corruptRecord(start);
+                    }
+                    break;
+                }
+                if (available < needed)
+                {
+                    if (eof)
+                    {
+                        break;
+                    }
+                    // Move the partial record to the front and read more
+                    std::memmove(block.data(), block.data() + begin, available);
+                    offset += begin;
+                    begin = 0;
+                    filled = available;
+                    if (block.size() < needed)
+                    {
+                        block.resize(needed);
+                    }
+                    ssize_t count = ::pread(fd_, block.data() + filled, block.size() - filled, static_cast<off_t>(offset + filled));
+                    if (count < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+                        throw ioError("Cannot read journal log", path_);
+                    }
+                    eof = count == 0;
+                    filled += static_cast<std::size_t>(count);
+                    continue;
+                }
+
+                const char *record = block.data() + begin;
+                const char *payload = record + RECORD_HEADER_SIZE;
+                std::size_t length = needed - RECORD_HEADER_SIZE;
+                // Only the last record can have been torn by a crash; damage
+                // anywhere else would lose the records after it
+                if (Crc32::compute(payload, length) != loadUint32(record + 4))
+                {
+                    if (recordFollows(start, size))
+                    {
+                        throw corruptRecord(start);
+                    }
+                    break;
+                }
+                std::shared_ptr<JournalEntry> entry;
+                try
+                {
+                    entry = EntryCodec::decodeJournalEntry(std::string_view(payload, length), arena);
+                }
+                catch (const std::exception &e)
+                {
+                    // A zero-filled tail passes as empty records whose
+                    // checksums match
+                    if (recordFollows(start, size))
+                    {
+                        throw std::runtime_error(corruptRecord(start).what() + std::string(": ") + e.what());
+                    }
+                    break;
+                }
+                if (replay)
+                {
+                    replay(std::move(entry));
+                }
+                ++replayed_;
+                begin += needed;
+            }
+            return offset + begin;
+        }
+
+        bool JournalLog::recordFollows(std::uint64_t start, std::uint64_t size) const
+        {
+            // Every entry encodes at least its ID, so no payload is empty
+            auto file = MappedFile::open(path_);
+            return ::recordFollows(file->data(), start, std::min<std::uint64_t>(size, file->size()), 1);
+        }
+
+        std::runtime_error JournalLog::corruptRecord(std::uint64_t start) const
+        {
+            return std::runtime_error("Corrupt journal log record at offset " + std::to_string(start) + " in " + path_);
+        }
+
+        void JournalLog::encode(const JournalEntry &entry, std::string &out)
+        {
+            out.assign(RECORD_HEADER_SIZE, '\0');
+            BinaryWriter writer(out);
+            EntryCodec::encode(entry, writer);
+
+            std::size_t length = out.size() - RECORD_HEADER_SIZE;
+            storeUint32(out.data(), static_cast<std::uint32_t>(length));
+            storeUint32(out.data() + 4, Crc32::compute(out.data() + RECORD_HEADER_SIZE, length));
+        }
+
+        std::uint64_t JournalLog::append(const JournalEntry &entry)
+        {
+            // Encoded before taking the lock, so appenders only contend on the copy
+            thread_local std::string record;
+            encode(entry, record);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            durable_.wait(lock, [this]
+                          { return buffer_.size() < options_.maxBytes || !error_.empty(); });
+            if (!error_.empty())
+            {
+                throw std::runtime_error(error_);
+            }
+            if (bufferedRecords_ == 0)
+            {
+                firstBuffered_ = std::chrono::steady_clock::now();
+            }
+            buffer_.insert(buffer_.end(), record.begin(), record.end());
+            ++bufferedRecords_;
+            std::uint64_t lsn = ++appendedLsn_;
+            lock.unlock();
+            pending_.notify_one();
+            return lsn;
+        }
+
+        void JournalLog::waitDurable(std::uint64_t lsn)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            durable_.wait(lock, [&]
+                          { return durableLsn_ >= lsn || !error_.empty(); });
+            if (durableLsn_ < lsn)
+            {
+                throw std::runtime_error(error_);
+            }
+        }
+
+        void JournalLog::sync()
+        {
+            std::uint64_t lsn;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                lsn = appendedLsn_;
+                syncRequested_ = true;
+            }
+            pending_.notify_one();
+            waitDurable(lsn);
+        }
+
+        std::uint64_t JournalLog::getDurableLsn() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return durableLsn_;
+        }
+
+        void JournalLog::flusherLoop()
+        {
+            std::vector<char> batch;
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (;;)
+            {
+                pending_.wait(lock, [this]
+                              { return stopping_ || !buffer_.empty(); });
+                if (buffer_.empty())
+                {
+                    return;
+                }
+                if (options_.maxDelay.count() > 0)
+                {
+                    pending_.wait_until(lock, firstBuffered_ + options_.maxDelay, [this]
+                                        { return stopping_ || syncRequested_ ||
+                                                 bufferedRecords_ >= options_.maxRecords ||
+                                                 buffer_.size() >= options_.maxBytes; });
+                }
+
+                // Take the whole group; appenders refill the other buffer
+                batch.clear();
+                batch.swap(buffer_);
+                bufferedRecords_ = 0;
+                syncRequested_ = false;
+                std::uint64_t lsn = appendedLsn_;
+                bool failed = !error_.empty();
+                lock.unlock();
+                durable_.notify_all();
+
+                std::string error;
+                if (!failed)
+                {
+                    try
+                    {
+                        writeAll(fd_, batch.data(), batch.size(), path_);
+                        if (::fdatasync(fd_) != 0)
+                        {
+                            throw ioError("Cannot sync journal log", path_);
+                        }
+                    }
+                    catch (const std::exception &e)
+                    {
+                        error = e.what();
+                    }
+                }
+
+                // Nothing after a failed write can be made durable
+                lock.lock();
+                if (!error.empty())
+                {
+                    error_ = error;
+                }
+                else if (!failed)
+                {
+                    durableLsn_ = lsn;
+                }
+                durable_.notify_all();
+            }
+        }
+
+    } // namespace accounting
+} // namespace market
@@ -1,6 +1,8 @@
 #include "accounting/Ledger.h"
 #include <stdexcept>
 #include <algorithm>
+#include <new>
+#include <mutex>
 
 namespace market
 {
@@ -10,47 +12,123 @@ namespace market
         IDGenerator LedgerEntry::idGen_{"LEN", 12};
         IDGenerator Ledger::idGen_{"LDG", 12};
 
+        namespace
+        {
+            using Clock = std::chrono::system_clock;
+
+            std::int64_t toTicks(const Clock::time_point &timestamp)
+            {
+                return timestamp.time_since_epoch().count();
+            }
+
+            Clock::time_point fromTicks(std::int64_t ticks)
+            {
+                return Clock::time_point(Clock::duration(ticks));
+            }
+        }
+
         std::shared_ptr<LedgerEntry> LedgerEntry::create(
-            const std::string &accountId,
-            const std::string &journalEntryId,
+            Symbol accountId,
+            std::uint64_t journalEntryId,
             EntryType type,
-            const Decimal &amount)
+            const Decimal &amount,
+            const std::shared_ptr<Arena> &arena)
+        {
+            validate(accountId, journalEntryId, amount);
+            return make(idGen_.nextValue(), accountId, journalEntryId, type, amount, Clock::now(), arena);
+        }
+
+        std::shared_ptr<LedgerEntry> LedgerEntry::restore(
+            std::uint64_t id,
+            Symbol accountId,
+            std::uint64_t journalEntryId,
+            EntryType type,
+            const Decimal &amount,
+            const std::chrono::system_clock::time_point &timestamp,
+            const std::shared_ptr<Arena> &arena)
+        {
+            validate(accountId, journalEntryId, amount);
+            idGen_.advancePast(id);
+            return make(id, accountId, journalEntryId, type, amount, timestamp, arena);
+        }
+
+        void LedgerEntry::validate(Symbol accountId, std::uint64_t journalEntryId, const Decimal &amount)
         {
             if (accountId.empty())
             {
                 throw std::invalid_argument("Account ID cannot be empty");
             }
-            if (journalEntryId.empty())
+            if (journalEntryId == 0)
             {
-                throw std::invalid_argument("Journal entry ID cannot be empty");
+                throw std::invalid_argument("Journal entry ID cannot be zero");
             }
             if (amount <= Decimal(0))
             {
                 throw std::invalid_argument("Amount must be positive");
             }
+        }
+
+        std::shared_ptr<LedgerEntry> LedgerEntry::make(
+            std::uint64_t id,
+            Symbol accountId,
+            std::uint64_t journalEntryId,
+            EntryType type,
+            const Decimal &amount,
+            const std::chrono::system_clock::time_point &timestamp,
+            const std::shared_ptr<Arena> &arena)
+        {
+            if (!arena)
+            {
+                return std::shared_ptr<LedgerEntry>(new LedgerEntry(
+                    id, accountId, journalEntryId, type, amount, timestamp));
+            }
 
-            return std::shared_ptr<LedgerEntry>(new LedgerEntry(
-                idGen_.next(),
-                accountId,
-                journalEntryId,
-                type,
-                amount));
+            void *memory = arena->allocate(sizeof(LedgerEntry), alignof(LedgerEntry));
+            return Arena::adopt(arena, new (memory) LedgerEntry(
+                                           id, accountId, journalEntryId, type, amount, timestamp));
         }
 
         LedgerEntry::LedgerEntry(
-            const std::string &id,
-            const std::string &accountId,
-            const std::string &journalEntryId,
+            std::uint64_t id,
+            Symbol accountId,
+            std::uint64_t journalEntryId,
             EntryType type,
-            const Decimal &amount) : id_(id),
-                                     accountId_(accountId),
-                                     journalEntryId_(journalEntryId),
-                                     type_(type),
-                                     amount_(amount),
-                                     timestamp_(std::chrono::system_clock::now())
+            const Decimal &amount,
+            const std::chrono::system_clock::time_point &timestamp) : id_(id),
+                                                                      accountId_(accountId),
+                                                                      journalEntryId_(journalEntryId),
+                                                                      type_(type),
+                                                                      amount_(amount),
+                                                                      timestamp_(timestamp)
         {
         }
 
+        LedgerEntry Ledger::EntryRange::const_iterator::operator*() const
+        {
+            std::int64_t amount = columns_->amounts[index_];
+            return LedgerEntry(
+                columns_->ids[index_],
+                accountId_,
+                columns_->journalEntries[index_],
+                amount >= 0 ? EntryType::DEBIT : EntryType::CREDIT,
+                Decimal::fromRaw(amount >= 0 ? amount : -amount),
+                fromTicks(columns_->timestamps[index_]));
+        }
+
+        Ledger::ColumnView Ledger::EntryRange::columns() const
+        {
+            if (!columns_)
+            {
+                return {};
+            }
+            std::size_t count = last_ - first_;
+            return ColumnView{
+                Span<const std::uint64_t>(columns_->ids.data() + first_, count),
+                Span<const std::int64_t>(columns_->amounts.data() + first_, count),
+                Span<const std::int64_t>(columns_->timestamps.data() + first_, count),
+                Span<const std::uint64_t>(columns_->journalEntries.data() + first_, count)};
+        }
+
         std::shared_ptr<Ledger> Ledger::create(const std::string &name)
         {
             if (name.empty())
@@ -60,6 +138,54 @@ namespace market
             return std::shared_ptr<Ledger>(new Ledger(idGen_.next(), name));
         }
 
+        std::shared_ptr<Ledger> Ledger::openSnapshot(const std::string &path)
+        {
+            auto file = LedgerSnapshotFile::open(path);
+            auto ledger = create(std::string(file->getLedgerName()));
+            ledger->snapshotFile_ = file;
+
+            // Nothing else reaches the ledger yet, so no shard is locked
+            for (std::size_t i = 0; i < file->getAccountCount(); ++i)
+            {
+                auto mapped = file->getAccount(i);
+                Symbol accountId = Symbol::intern(mapped.accountId);
+                AccountColumns &account = ledger->account(accountId);
+                account.ids.map(mapped.ids);
+                account.amounts.map(mapped.amounts);
+                account.timestamps.map(mapped.timestamps);
+                account.cumulative.map(mapped.cumulative);
+                account.journalEntries.map(mapped.journalEntries);
+                account.debits = mapped.debits;
+                account.credits = mapped.credits;
+            }
+
+            ledger->sequence_.store(file->getSequence(), std::memory_order_relaxed);
+            LedgerEntry::idGen_.advancePast(file->getMaxEntryId());
+            return ledger;
+        }
+
+        void Ledger::writeSnapshot(const std::string &path) const
+        {
+            Snapshot snapshot(*this);
+            LedgerSnapshotFile::Writer writer(path, name_, snapshot.getSequence());
+            for (const auto &shard : shards_)
+            {
+                const auto &accountIds = shard.accounts.keys();
+                const auto &accounts = shard.accounts.values();
+                for (std::size_t i = 0; i < accounts.size(); ++i)
+                {
+                    const AccountColumns &account = accounts[i];
+                    writer.addAccount(accountIds[i], account.debits, account.credits,
+                                      Span<const std::uint64_t>(account.ids.data(), account.ids.size()),
+                                      Span<const std::int64_t>(account.amounts.data(), account.amounts.size()),
+                                      Span<const std::int64_t>(account.timestamps.data(), account.timestamps.size()),
+                                      Span<const std::int64_t>(account.cumulative.data(), account.cumulative.size()),
+                                      Span<const std::uint64_t>(account.journalEntries.data(), account.journalEntries.size()));
+                }
+            }
+            writer.commit();
+        }
+
         Ledger::Ledger(const std::string &id, const std::string &name)
             : id_(id), name_(name) {}
 
@@ -69,67 +195,453 @@ namespace market
             {
                 throw std::invalid_argument("Entry cannot be null");
             }
-            accountEntries_[entry->getAccountId()].push_back(entry);
+            addEntry(*entry);
         }
 
-        Decimal Ledger::getBalance(const std::string &accountId) const
+        void Ledger::addEntry(const LedgerEntry &entry)
         {
-            return getBalance(accountId, std::chrono::system_clock::now());
+            std::uint64_t sequence;
+            {
+                std::unique_lock<std::shared_mutex> lock(shards_[shardOf(entry.getAccountId())].mutex);
+                append(account(entry.getAccountId()),
+                       entry.getNumericId(),
+                       entry.getJournalEntryId(),
+                       entry.getType(),
+                       entry.getAmount(),
+                       toTicks(entry.getTimestamp()));
+                sequence = nextSequence();
+            }
+
+            if (hasListeners_.load(std::memory_order_acquire))
+            {
+                std::int64_t amount = entry.getAmount().toRaw();
+                Posting posting{entry.getAccountId(), entry.getType() == EntryType::DEBIT ? amount : -amount, entry.getTimestamp()};
+                notify(PostingEvent{sequence, Span<const Posting>(&posting, 1)});
+            }
         }
 
-        Decimal Ledger::getBalance(const std::string &accountId, const std::chrono::system_clock::time_point &asOf) const
+        void Ledger::post(const JournalEntry &entry)
         {
-            auto it = accountEntries_.find(accountId);
-            if (it == accountEntries_.end())
+            validate(entry);
+            std::uint64_t sequence;
             {
-                return Decimal(0);
+                ShardGuard guard(*this, shardsOf(entry));
+                appendLines(entry);
+                sequence = nextSequence();
+            }
+            notify(sequence, entry);
+        }
+
+        void Ledger::postBatch(Span<const std::shared_ptr<JournalEntry>> entries)
+        {
+            for (const auto &entry : entries)
+            {
+                if (!entry)
+                {
+                    throw std::invalid_argument("Journal entry cannot be null");
+                }
+                validate(*entry);
             }
 
-            Decimal balance(0);
-            for (const auto &entry : it->second)
+            SymbolMap<std::size_t> lineCounts;
+            std::uint32_t shards = 0;
+            for (const auto &entry : entries)
             {
-                if (entry->getTimestamp() <= asOf)
+                for (const auto &line : entry->getEntries())
                 {
-                    if (entry->getType() == market::accounting::EntryType::DEBIT)
-                    {
-                        balance = balance + entry->getAmount();
-                    }
-                    else
-                    {
-                        balance = balance - entry->getAmount();
-                    }
+                    ++lineCounts[line.accountId];
                 }
+                shards |= shardsOf(*entry);
+            }
+            {
+                ShardGuard guard(*this, shards);
+                const auto &accountIds = lineCounts.keys();
+                const auto &counts = lineCounts.values();
+                for (std::size_t i = 0; i < accountIds.size(); ++i)
+                {
+                    reserve(account(accountIds[i]), counts[i]);
+                }
+            }
+
+            // Lock per journal entry rather than for the whole batch so that
+            // other posting threads can interleave
+            for (const auto &entry : entries)
+            {
+                std::uint64_t sequence;
+                {
+                    ShardGuard guard(*this, shardsOf(*entry));
+                    appendLines(*entry);
+                    sequence = nextSequence();
+                }
+                notify(sequence, *entry);
             }
-            return balance;
         }
 
-        std::vector<std::shared_ptr<LedgerEntry>> Ledger::getEntries(const std::string &accountId) const
+        Ledger::Subscription Ledger::subscribe(Listener listener)
         {
-            auto it = accountEntries_.find(accountId);
-            if (it == accountEntries_.end())
+            if (!listener)
             {
-                return {};
+                throw std::invalid_argument("Listener cannot be empty");
             }
-            return it->second;
+
+            std::lock_guard<std::mutex> lock(listenersMutex_);
+            auto listeners = listeners_ ? std::make_shared<ListenerList>(*listeners_) : std::make_shared<ListenerList>();
+            std::uint64_t id = ++nextListenerId_;
+            listeners->emplace_back(id, std::make_shared<const Listener>(std::move(listener)));
+            listeners_ = std::move(listeners);
+            hasListeners_.store(true, std::memory_order_release);
+            return Subscription(weak_from_this(), id);
         }
 
-        std::vector<std::shared_ptr<LedgerEntry>> Ledger::getEntries(
-            const std::string &accountId,
+        void Ledger::unsubscribe(std::uint64_t id)
+        {
+            std::lock_guard<std::mutex> lock(listenersMutex_);
+            if (!listeners_)
+            {
+                return;
+            }
+            auto listeners = std::make_shared<ListenerList>();
+            for (const auto &listener : *listeners_)
+            {
+                if (listener.first != id)
+                {
+                    listeners->push_back(listener);
+                }
+            }
+            hasListeners_.store(!listeners->empty(), std::memory_order_release);
+            listeners_ = std::move(listeners);
+        }
+
+        void Ledger::notify(std::uint64_t sequence, const JournalEntry &entry) const
+        {
+            if (!hasListeners_.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            std::vector<Posting> postings;
+            postings.reserve(entry.getEntries().size());
+            for (const auto &line : entry.getEntries())
+            {
+                std::int64_t amount = line.amount.toRaw();
+                postings.push_back(Posting{line.accountId, line.type == EntryType::DEBIT ? amount : -amount, entry.getTimestamp()});
+            }
+            notify(PostingEvent{sequence, postings});
+        }
+
+        void Ledger::notify(const PostingEvent &event) const
+        {
+            std::shared_ptr<const ListenerList> listeners;
+            {
+                std::lock_guard<std::mutex> lock(listenersMutex_);
+                listeners = listeners_;
+            }
+            if (!listeners)
+            {
+                return;
+            }
+            for (const auto &listener : *listeners)
+            {
+                (*listener.second)(event);
+            }
+        }
+
+        Ledger::Subscription::Subscription(Subscription &&other) noexcept
+            : ledger_(std::move(other.ledger_)), id_(other.id_)
+        {
+            other.id_ = 0;
+        }
+
+        Ledger::Subscription &Ledger::Subscription::operator=(Subscription &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                ledger_ = std::move(other.ledger_);
+                id_ = other.id_;
+                other.id_ = 0;
+            }
+            return *this;
+        }
+
+        void Ledger::Subscription::reset()
+        {
+            if (id_ == 0)
+            {
+                return;
+            }
+            if (auto ledger = ledger_.lock())
+            {
+                ledger->unsubscribe(id_);
+            }
+            ledger_.reset();
+            id_ = 0;
+        }
+
+        Ledger::ShardGuard::ShardGuard(const Ledger &ledger, std::uint32_t shards)
+            : ledger_(ledger), shards_(0)
+        {
+            for (std::size_t i = 0; i < SHARD_COUNT; ++i)
+            {
+                if (shards & (1u << i))
+                {
+                    ledger_.shards_[i].mutex.lock();
+                    shards_ |= 1u << i;
+                }
+            }
+        }
+
+        Ledger::ShardGuard::~ShardGuard()
+        {
+            for (std::size_t i = 0; i < SHARD_COUNT; ++i)
+            {
+                if (shards_ & (1u << i))
+                {
+                    ledger_.shards_[i].mutex.unlock();
+                }
+            }
+        }
+
+        std::uint32_t Ledger::shardsOf(const JournalEntry &entry)
+        {
+            std::uint32_t shards = 0;
+            for (const auto &line : entry.getEntries())
+            {
+                shards |= 1u << shardOf(line.accountId);
+            }
+            return shards;
+        }
+
+        void Ledger::validate(const JournalEntry &entry)
+        {
+            for (const auto &line : entry.getEntries())
+            {
+                if (line.accountId.empty())
+                {
+                    throw std::invalid_argument("Account ID cannot be empty");
+                }
+                if (line.amount <= Decimal(0))
+                {
+                    throw std::invalid_argument("Amount must be positive");
+                }
+            }
+        }
+
+        void Ledger::reserve(AccountColumns &account, std::size_t additional)
+        {
+            std::size_t capacity = account.ids.size() + additional;
+            account.ids.own().reserve(capacity);
+            account.amounts.own().reserve(capacity);
+            account.timestamps.own().reserve(capacity);
+            account.journalEntries.own().reserve(capacity);
+            account.cumulative.own().reserve(capacity);
+        }
+
+        void Ledger::appendLines(const JournalEntry &entry)
+        {
+            // Every line shares the journal entry's ID and timestamp
+            std::uint64_t journalEntryId = entry.getNumericId();
+            std::int64_t timestamp = toTicks(entry.getTimestamp());
+            for (const auto &line : entry.getEntries())
+            {
+                append(account(line.accountId),
+                       LedgerEntry::idGen_.nextValue(),
+                       journalEntryId,
+                       line.type,
+                       line.amount,
+                       timestamp);
+            }
+        }
+
+        void Ledger::append(
+            AccountColumns &account,
+            std::uint64_t id,
+            std::uint64_t journalEntryId,
+            EntryType type,
+            const Decimal &amount,
+            std::int64_t timestamp)
+        {
+            std::int64_t raw = amount.toRaw();
+            if (type == EntryType::DEBIT)
+            {
+                account.debits = account.debits + amount;
+            }
+            else
+            {
+                account.credits = account.credits + amount;
+                raw = -raw;
+            }
+
+            // Copies the columns out of a mapped snapshot on the first posting
+            auto &ids = account.ids.own();
+            auto &amounts = account.amounts.own();
+            auto &timestamps = account.timestamps.own();
+            auto &journalEntries = account.journalEntries.own();
+            auto &cumulative = account.cumulative.own();
+
+            if (timestamps.empty() || timestamp >= timestamps.back())
+            {
+                // Common case: entries arrive in time order
+                std::int64_t previous = cumulative.empty() ? 0 : cumulative.back();
+                ids.push_back(id);
+                amounts.push_back(raw);
+                timestamps.push_back(timestamp);
+                journalEntries.push_back(journalEntryId);
+                cumulative.push_back(previous + raw);
+                return;
+            }
+
+            // Late entry: insert after entries with the same or earlier
+            // timestamp and shift the cumulative balances that follow it.
+            auto position = std::upper_bound(timestamps.begin(), timestamps.end(), timestamp);
+            auto index = position - timestamps.begin();
+            std::int64_t previous = index == 0 ? 0 : cumulative[index - 1];
+            ids.insert(ids.begin() + index, id);
+            amounts.insert(amounts.begin() + index, raw);
+            timestamps.insert(position, timestamp);
+            journalEntries.insert(journalEntries.begin() + index, journalEntryId);
+            cumulative.insert(cumulative.begin() + index, previous + raw);
+            for (auto it = cumulative.begin() + index + 1; it != cumulative.end(); ++it)
+            {
+                *it += raw;
+            }
+        }
+
+        Decimal Ledger::getBalance(Symbol accountId) const
+        {
+            std::shared_lock<std::shared_mutex> lock(shards_[shardOf(accountId)].mutex);
+            return balanceOf(findAccount(accountId));
+        }
+
+        Decimal Ledger::getBalance(Symbol accountId, const std::chrono::system_clock::time_point &asOf) const
+        {
+            std::shared_lock<std::shared_mutex> lock(shards_[shardOf(accountId)].mutex);
+            return balanceOf(findAccount(accountId), asOf);
+        }
+
+        std::vector<LedgerEntry> Ledger::getEntries(Symbol accountId) const
+        {
+            std::shared_lock<std::shared_mutex> lock(shards_[shardOf(accountId)].mutex);
+            return collect(rangeOf(accountId, findAccount(accountId)));
+        }
+
+        std::vector<LedgerEntry> Ledger::getEntries(
+            Symbol accountId,
             const std::chrono::system_clock::time_point &start,
             const std::chrono::system_clock::time_point &end) const
         {
-            auto entries = getEntries(accountId);
-            std::vector<std::shared_ptr<LedgerEntry>> result;
-
-            std::copy_if(entries.begin(), entries.end(), std::back_inserter(result),
-                         [&](const std::shared_ptr<LedgerEntry> &entry)
-                         {
-                             auto timestamp = entry->getTimestamp();
-                             return timestamp >= start && timestamp <= end;
-                         });
+            std::shared_lock<std::shared_mutex> lock(shards_[shardOf(accountId)].mutex);
+            return collect(rangeOf(accountId, findAccount(accountId), start, end));
+        }
 
+        std::vector<LedgerEntry> Ledger::collect(const EntryRange &range)
+        {
+            std::vector<LedgerEntry> result;
+            result.reserve(range.size());
+            for (const LedgerEntry &entry : range)
+            {
+                result.push_back(entry);
+            }
             return result;
         }
 
+        Decimal Ledger::balanceOf(const AccountColumns *account)
+        {
+            // Entries are timestamped on creation, so the running totals are
+            // the balance as of now.
+            if (!account)
+            {
+                return Decimal(0);
+            }
+            return account->debits - account->credits;
+        }
+
+        Decimal Ledger::balanceOf(const AccountColumns *account, const std::chrono::system_clock::time_point &asOf)
+        {
+            if (!account)
+            {
+                return Decimal(0);
+            }
+
+            auto position = std::upper_bound(account->timestamps.begin(), account->timestamps.end(), toTicks(asOf));
+            if (position == account->timestamps.begin())
+            {
+                return Decimal(0);
+            }
+            return Decimal::fromRaw(account->cumulative[position - account->timestamps.begin() - 1]);
+        }
+
+        Ledger::EntryRange Ledger::rangeOf(Symbol accountId, const AccountColumns *account)
+        {
+            if (!account)
+            {
+                return {};
+            }
+            return EntryRange(accountId, account, 0, account->ids.size());
+        }
+
+        Ledger::EntryRange Ledger::rangeOf(
+            Symbol accountId,
+            const AccountColumns *account,
+            const std::chrono::system_clock::time_point &start,
+            const std::chrono::system_clock::time_point &end)
+        {
+            if (!account || end < start)
+            {
+                return {};
+            }
+
+            auto first = std::lower_bound(account->timestamps.begin(), account->timestamps.end(), toTicks(start));
+            auto last = std::upper_bound(first, account->timestamps.end(), toTicks(end));
+            return EntryRange(accountId, account,
+                              static_cast<std::size_t>(first - account->timestamps.begin()),
+                              static_cast<std::size_t>(last - account->timestamps.begin()));
+        }
+
+        Ledger::Snapshot::Snapshot(const Ledger &ledger) : ledger_(&ledger)
+        {
+            // Same order as ShardGuard, so a snapshot cannot deadlock with a
+            // posting that spans several shards
+            for (std::size_t i = 0; i < SHARD_COUNT; ++i)
+            {
+                locks_[i] = std::shared_lock<std::shared_mutex>(ledger.shards_[i].mutex);
+            }
+            sequence_ = ledger.sequence_.load(std::memory_order_relaxed);
+        }
+
+        std::vector<Symbol> Ledger::Snapshot::getAccountIds() const
+        {
+            std::vector<Symbol> accountIds;
+            for (const auto &shard : ledger_->shards_)
+            {
+                const auto &keys = shard.accounts.keys();
+                accountIds.insert(accountIds.end(), keys.begin(), keys.end());
+            }
+            return accountIds;
+        }
+
+        Decimal Ledger::Snapshot::getBalance(Symbol accountId) const
+        {
+            return balanceOf(ledger_->findAccount(accountId));
+        }
+
+        Decimal Ledger::Snapshot::getBalance(Symbol accountId, const std::chrono::system_clock::time_point &asOf) const
+        {
+            return balanceOf(ledger_->findAccount(accountId), asOf);
+        }
+
+        Ledger::EntryRange Ledger::Snapshot::getEntryRange(Symbol accountId) const
+        {
+            return rangeOf(accountId, ledger_->findAccount(accountId));
+        }
+
+        Ledger::EntryRange Ledger::Snapshot::getEntryRange(
+            Symbol accountId,
+            const std::chrono::system_clock::time_point &start,
+            const std::chrono::system_clock::time_point &end) const
+        {
+            return rangeOf(accountId, ledger_->findAccount(accountId), start, end);
+        }
+
     } // namespace accounting
 } // namespace market
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "accounting/LedgerSnapshotFile.h"
+#include "utils/FileIo.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace market
+{
+    namespace accounting
+    {
+        namespace
+        {
+            constexpr char MAGIC[4] = {'M', 'L', 'S', 'N'};
+            constexpr std::uint32_t VERSION = 2;
+            constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+            constexpr std::size_t ALIGNMENT = 8;
+
+            using Clock = std::chrono::system_clock;
+
+            struct Header
+            {
+                char magic[4];
+                std::uint32_t version;
+                std::uint32_t byteOrder;
+                std::uint32_t accountCount;
+                // Clock::period, so ticks are not misread by a build with a
+                // different clock resolution
+                std::int64_t tickNum;
+                std::int64_t tickDen;
+                std::uint64_t sequence;
+                std::uint64_t maxEntryId;
+                std::uint64_t accountsOffset;
+                std::uint64_t stringCount;
+                std::uint64_t stringOffsetsOffset;
+                std::uint64_t stringDataOffset;
+                std::uint64_t fileSize;
+                std::uint32_t nameString;
+                std::uint32_t reserved;
+            };
+            static_assert(sizeof(Header) == 96, "snapshot header layout");
+
+            struct AccountRecord
+            {
+                std::uint32_t idString;
+                std::uint32_t reserved;
+                std::uint64_t count;
+                std::int64_t debits;
+                std::int64_t credits;
+                std::uint64_t idsOffset;
+                std::uint64_t amountsOffset;
+                std::uint64_t timestampsOffset;
+                std::uint64_t cumulativeOffset;
+                std::uint64_t journalEntriesOffset;
+            };
+            static_assert(sizeof(AccountRecord) == 72, "snapshot account layout");
+
+            std::runtime_error corrupt(const std::string &path)
+            {
+                return std::runtime_error("Corrupt ledger snapshot: " + path);
+            }
+        }
+
+        // Buffered sequential writes that track the file offset
+        struct LedgerSnapshotFile::Writer::Output
+        {
+            static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+            explicit Output(const std::string &path) : path(path), offset(0)
+            {
+                fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (fd < 0)
+                {
+                    throw ioError("Cannot create ledger snapshot", path);
+                }
+                buffer.reserve(BUFFER_SIZE);
+            }
+
+            ~Output()
+            {
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+            }
+
+            void write(const void *data, std::size_t size)
+            {
+                const char *bytes = static_cast<const char *>(data);
+                offset += size;
+                if (buffer.size() + size > BUFFER_SIZE)
+                {
+                    flush();
+                    if (size > BUFFER_SIZE)
+                    {
+                        writeAll(fd, bytes, size, path);
+                        return;
+                    }
+                }
+                buffer.insert(buffer.end(), bytes, bytes + size);
+            }
+
+            void flush()
+            {
+                writeAll(fd, buffer.data(), buffer.size(), path);
+                buffer.clear();
+            }
+
+            std::string path;
+            int fd;
+            std::uint64_t offset;
+            std::vector<char> buffer;
+        };
+
+        LedgerSnapshotFile::Writer::Writer(const std::string &path, const std::string &ledgerName, std::uint64_t sequence)
+            : path_(path), ledgerName_(ledgerName), out_(new Output(path + ".tmp")), sequence_(sequence), maxEntryId_(0)
+        {
+            // Room for the header, which is filled in by commit()
+            Header header{};
+            out_->write(&header, sizeof(header));
+            nameString_ = addString(ledgerName_);
+        }
+
+        LedgerSnapshotFile::Writer::~Writer()
+        {
+            // Not committed: leave no temporary file behind
+            if (out_)
+            {
+                ::unlink(out_->path.c_str());
+            }
+        }
+
+        std::uint32_t LedgerSnapshotFile::Writer::addString(std::string_view text)
+        {
+            auto index = static_cast<std::uint32_t>(strings_.size());
+            strings_.push_back(text);
+            return index;
+        }
+
+        void LedgerSnapshotFile::Writer::addAccount(
+            Symbol accountId,
+            Decimal debits,
+            Decimal credits,
+            Span<const std::uint64_t> ids,
+            Span<const std::int64_t> amounts,
+            Span<const std::int64_t> timestamps,
+            Span<const std::int64_t> cumulative,
+            Span<const std::uint64_t> journalEntries)
+        {
+            std::size_t count = ids.size();
+            if (amounts.size() != count || timestamps.size() != count || cumulative.size() != count || journalEntries.size() != count)
+            {
+                throw std::invalid_argument("Snapshot columns must have the same length");
+            }
+
+            AccountRecord record{};
+            record.idString = addString(accountId.str());
+            record.count = count;
+            record.debits = debits.toRaw();
+            record.credits = credits.toRaw();
+
+            // Every column is a multiple of 8 bytes, so each stays aligned
+            record.idsOffset = out_->offset;
+            out_->write(ids.data(), count * sizeof(std::uint64_t));
+            record.amountsOffset = out_->offset;
+            out_->write(amounts.data(), count * sizeof(std::int64_t));
+            record.timestampsOffset = out_->offset;
+            out_->write(timestamps.data(), count * sizeof(std::int64_t));
+            record.cumulativeOffset = out_->offset;
+            out_->write(cumulative.data(), count * sizeof(std::int64_t));
+            record.journalEntriesOffset = out_->offset;
+            out_->write(journalEntries.data(), count * sizeof(std::uint64_t));
+
+            for (std::uint64_t id : ids)
+            {
+                maxEntryId_ = std::max(maxEntryId_, id);
+            }
+            const char *bytes = reinterpret_cast<const char *>(&record);
+            accounts_.insert(accounts_.end(), bytes, bytes + sizeof(record));
+        }
+
+        void LedgerSnapshotFile::Writer::commit()
+        {
+            if (!out_)
+            {
+                throw std::logic_error("Ledger snapshot already committed");
+            }
+
+            Header header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.byteOrder = BYTE_ORDER_MARK;
+            header.accountCount = static_cast<std::uint32_t>(accounts_.size() / sizeof(AccountRecord));
+            header.tickNum = Clock::period::num;
+            header.tickDen = Clock::period::den;
+            header.sequence = sequence_;
+            header.maxEntryId = maxEntryId_;
+            header.nameString = nameString_;
+
+            header.accountsOffset = out_->offset;
+            out_->write(accounts_.data(), accounts_.size());
+
+            header.stringCount = strings_.size();
+            header.stringOffsetsOffset = out_->offset;
+            std::uint64_t stringOffset = 0;
+            out_->write(&stringOffset, sizeof(stringOffset));
+            for (std::string_view text : strings_)
+            {
+                stringOffset += text.size();
+                out_->write(&stringOffset, sizeof(stringOffset));
+            }
+            header.stringDataOffset = out_->offset;
+            for (std::string_view text : strings_)
+            {
+                out_->write(text.data(), text.size());
+            }
+            header.fileSize = out_->offset;
+            out_->flush();
+
+            if (::pwrite(out_->fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+                ::fdatasync(out_->fd) != 0)
+            {
+                throw ioError("Cannot write ledger snapshot", out_->path);
+            }
+            if (::rename(out_->path.c_str(), path_.c_str()) != 0)
+            {
+                throw ioError("Cannot rename ledger snapshot to", path_);
+            }
+            out_.reset();
+
+            // Make the rename itself durable
+            syncDirectory(path_);
+        }
+
+        std::shared_ptr<LedgerSnapshotFile> LedgerSnapshotFile::open(const std::string &path)
+        {
+            auto file = MappedFile::open(path);
+            if (file->size() < sizeof(Header))
+            {
+                throw corrupt(path);
+            }
+
+            const auto *header = reinterpret_cast<const Header *>(file->data());
+            if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+            {
+                throw std::runtime_error("Not a ledger snapshot: " + path);
+            }
+            if (header->version != VERSION)
+            {
+                throw std::runtime_error("Unsupported ledger snapshot version in " + path);
+            }
+            if (header->byteOrder != BYTE_ORDER_MARK)
+            {
+                throw std::runtime_error("Ledger snapshot has a different byte order: " + path);
+            }
+            if (header->tickNum != Clock::period::num || header->tickDen != Clock::period::den)
+            {
+                throw std::runtime_error("Ledger snapshot has a different clock resolution: " + path);
+            }
+
+            // Checks that [offset, offset + count * width) lies in the file
+            // and is aligned for elements of that width (at most ALIGNMENT)
+            std::uint64_t size = file->size();
+            auto within = [size](std::uint64_t offset, std::uint64_t count, std::uint64_t width)
+            {
+                return offset % std::min<std::uint64_t>(width, ALIGNMENT) == 0 &&
+                       offset <= size && count <= (size - offset) / width;
+            };
+
+            if (header->fileSize != size ||
+                !within(header->accountsOffset, header->accountCount, sizeof(AccountRecord)) ||
+                header->stringCount >= UINT32_MAX ||
+                !within(header->stringOffsetsOffset, header->stringCount + 1, sizeof(std::uint64_t)) ||
+                header->nameString >= header->stringCount)
+            {
+                throw corrupt(path);
+            }
+
+            std::shared_ptr<LedgerSnapshotFile> snapshot(new LedgerSnapshotFile(file));
+            snapshot->version_ = header->version;
+            snapshot->sequence_ = header->sequence;
+            snapshot->maxEntryId_ = header->maxEntryId;
+            snapshot->accountCount_ = header->accountCount;
+            snapshot->nameString_ = header->nameString;
+            snapshot->accounts_ = file->data() + header->accountsOffset;
+            snapshot->stringCount_ = header->stringCount;
+            snapshot->stringOffsets_ = reinterpret_cast<const std::uint64_t *>(file->data() + header->stringOffsetsOffset);
+            snapshot->stringData_ = file->data() + header->stringDataOffset;
+
+            // Offsets must not decrease or run past the end of the file, so
+            // getString needs no checks
+            const std::uint64_t *offsets = snapshot->stringOffsets_;
+            if (offsets[0] != 0 || header->stringDataOffset > size ||
+                offsets[header->stringCount] > size - header->stringDataOffset)
+            {
+                throw corrupt(path);
+            }
+            for (std::uint64_t i = 0; i < header->stringCount; ++i)
+            {
+                if (offsets[i] > offsets[i + 1])
+                {
+                    throw corrupt(path);
+                }
+            }
+
+            // Bounds only; the columns themselves are not read
+            for (std::size_t i = 0; i < snapshot->accountCount_; ++i)
+            {
+                const auto *record = reinterpret_cast<const AccountRecord *>(snapshot->accounts_) + i;
+                if (record->idString >= header->stringCount ||
+                    !within(record->idsOffset, record->count, sizeof(std::uint64_t)) ||
+                    !within(record->amountsOffset, record->count, sizeof(std::int64_t)) ||
+                    !within(record->timestampsOffset, record->count, sizeof(std::int64_t)) ||
+                    !within(record->cumulativeOffset, record->count, sizeof(std::int64_t)) ||
+                    !within(record->journalEntriesOffset, record->count, sizeof(std::uint64_t)))
+                {
+                    throw corrupt(path);
+                }
+            }
+            return snapshot;
+        }
+
+        LedgerSnapshotFile::LedgerSnapshotFile(std::shared_ptr<MappedFile> file) : file_(std::move(file))
+        {
+        }
+
+        LedgerSnapshotFile::Account LedgerSnapshotFile::getAccount(std::size_t index) const
+        {
+            if (index >= accountCount_)
+            {
+                throw std::out_of_range("Snapshot account index out of range");
+            }
+            const auto *record = reinterpret_cast<const AccountRecord *>(accounts_) + index;
+            const char *base = file_->data();
+            std::size_t count = record->count;
+            return Account{
+                getString(record->idString),
+                Decimal::fromRaw(record->debits),
+                Decimal::fromRaw(record->credits),
+                Span<const std::uint64_t>(reinterpret_cast<const std::uint64_t *>(base + record->idsOffset), count),
+                Span<const std::int64_t>(reinterpret_cast<const std::int64_t *>(base + record->amountsOffset), count),
+                Span<const std::int64_t>(reinterpret_cast<const std::int64_t *>(base + record->timestampsOffset), count),
+                Span<const std::int64_t>(reinterpret_cast<const std::int64_t *>(base + record->cumulativeOffset), count),
+                Span<const std::uint64_t>(reinterpret_cast<const std::uint64_t *>(base + record->journalEntriesOffset), count)};
+        }
+
+        std::string_view LedgerSnapshotFile::getString(std::uint32_t index) const
+        {
+            if (index >= stringCount_)
+            {
+                throw std::out_of_range("Snapshot string index out of range");
+            }
+            return std::string_view(stringData_ + stringOffsets_[index], stringOffsets_[index + 1] - stringOffsets_[index]);
+        }
+
+    } // namespace accounting
+} // namespace market
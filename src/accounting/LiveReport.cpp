@@ -0,0 +1,219 @@
+#include "accounting/LiveReport.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        LiveReport::LiveReport(std::shared_ptr<Ledger> ledger, std::shared_ptr<ThreadPool> pool)
+            : ledger_(ledger), pool_(pool), linesStale_(false), sequence_(0)
+        {
+        }
+
+        void LiveReport::compute()
+        {
+            // Resolved from one snapshot, so every section reflects the same
+            // postings
+            BalanceCache balances;
+            collectBalanceRequests(balances);
+            balances.resolve(*ledger_, pool_.get());
+            compute(balances);
+        }
+
+        void LiveReport::compute(const BalanceCache &balances)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!subscription_)
+            {
+                load(balances);
+            }
+        }
+
+        void LiveReport::enableLiveUpdates()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (subscription_)
+            {
+                return;
+            }
+
+            // Subscribe before taking the snapshot: postings it already
+            // includes are then skipped by sequence number, later ones applied
+            std::weak_ptr<LiveReport> self = weak_from_this();
+            subscription_ = ledger_->subscribe([self](const Ledger::PostingEvent &event)
+                                               {
+                if (auto report = self.lock())
+                {
+                    report->apply(event);
+                } });
+
+            BalanceCache balances;
+            collectBalanceRequests(balances);
+            balances.resolve(*ledger_, pool_.get());
+            load(balances);
+        }
+
+        void LiveReport::disableLiveUpdates()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            subscription_.reset();
+        }
+
+        bool LiveReport::isLive() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return static_cast<bool>(subscription_);
+        }
+
+        void LiveReport::load(const BalanceCache &balances)
+        {
+            loadSections(balances);
+            sequence_ = balances.getSequence();
+            linesStale_ = true;
+        }
+
+        void LiveReport::apply(const Ledger::PostingEvent &event)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (event.sequence <= sequence_)
+            {
+                return;
+            }
+            for (const auto &line : event.lines)
+            {
+                if (applyLine(line.accountId, line.amount))
+                {
+                    linesStale_ = true;
+                }
+            }
+        }
+
+        SignedStatement::SignedStatement(
+            std::shared_ptr<Ledger> ledger,
+            const std::vector<std::pair<std::string, std::string>> &positiveAccounts,
+            const std::vector<std::pair<std::string, std::string>> &negativeAccounts,
+            const Titles &titles,
+            std::shared_ptr<ThreadPool> pool)
+            : LiveReport(ledger, pool), positiveAccounts_(positiveAccounts), negativeAccounts_(negativeAccounts), titles_(titles)
+        {
+        }
+
+        void SignedStatement::collectBalanceRequests(BalanceCache &balances) const
+        {
+            positiveAccounts_.request(balances);
+            negativeAccounts_.request(balances);
+        }
+
+        Decimal SignedStatement::getPositiveTotal() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return Decimal::fromRaw(positiveAccounts_.getPositiveTotal());
+        }
+
+        Decimal SignedStatement::getNegativeTotal() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return Decimal::fromRaw(-negativeAccounts_.getNegativeTotal());
+        }
+
+        Decimal SignedStatement::getNet() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return Decimal::fromRaw(positiveAccounts_.getPositiveTotal() + negativeAccounts_.getNegativeTotal());
+        }
+
+        std::vector<SignedStatement::AccountLine> SignedStatement::getPositiveLines() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buildLines();
+            return positiveLines_;
+        }
+
+        std::vector<SignedStatement::AccountLine> SignedStatement::getNegativeLines() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buildLines();
+            return negativeLines_;
+        }
+
+        void SignedStatement::loadSections(const BalanceCache &balances)
+        {
+            positiveAccounts_.load(balances, pool_.get());
+            negativeAccounts_.load(balances, pool_.get());
+        }
+
+        bool SignedStatement::applyLine(Symbol accountId, std::int64_t delta)
+        {
+            // An account may be listed in both sections
+            bool listed = positiveAccounts_.apply(accountId, delta);
+            return negativeAccounts_.apply(accountId, delta) || listed;
+        }
+
+        void SignedStatement::buildLines() const
+        {
+            if (!linesStale_)
+            {
+                return;
+            }
+            positiveLines_ = buildLines(positiveAccounts_, true);
+            negativeLines_ = buildLines(negativeAccounts_, false);
+            linesStale_ = false;
+        }
+
+        std::vector<SignedStatement::AccountLine> SignedStatement::buildLines(const ReportSection &section, bool positive) const
+        {
+            const auto &accounts = section.getAccounts();
+            return section.buildLines<AccountLine>(pool_.get(), [&](std::vector<AccountLine> &lines, std::size_t i, std::int64_t balance)
+                                                   {
+                if (positive ? balance > 0 : balance < 0)
+                {
+                    AccountLine line;
+                    line.accountId = accounts[i].first;
+                    line.accountName = accounts[i].second;
+                    line.amount = Decimal::fromRaw(positive ? balance : -balance);
+                    lines.push_back(line);
+                } });
+        }
+
+        void SignedStatement::write(ReportWriter &writer) const
+        {
+            // Formatted from copies of the balances, taken under the lock so
+            // that postings are not held up while the writer formats
+            std::vector<std::int64_t> positiveBalances;
+            std::vector<std::int64_t> negativeBalances;
+            Decimal positiveTotal;
+            Decimal negativeTotal;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                positiveBalances = positiveAccounts_.getBalances();
+                negativeBalances = negativeAccounts_.getBalances();
+                positiveTotal = Decimal::fromRaw(positiveAccounts_.getPositiveTotal());
+                negativeTotal = Decimal::fromRaw(-negativeAccounts_.getNegativeTotal());
+            }
+
+            writer.beginReport(titles_.report, {"Amount"});
+            writer.beginSection(titles_.positiveSection);
+            writeSection(writer, positiveAccounts_, positiveBalances, true);
+            writer.endSection(titles_.positiveTotal, {positiveTotal});
+            writer.beginSection(titles_.negativeSection);
+            writeSection(writer, negativeAccounts_, negativeBalances, false);
+            writer.endSection(titles_.negativeTotal, {negativeTotal});
+            writer.total(titles_.net, {positiveTotal - negativeTotal});
+            writer.endReport();
+        }
+
+        void SignedStatement::writeSection(ReportWriter &writer, const ReportSection &section, const std::vector<std::int64_t> &balances, bool positive)
+        {
+            const auto &accounts = section.getAccounts();
+            for (std::size_t i = 0; i < balances.size(); ++i)
+            {
+                std::int64_t balance = balances[i];
+                if (positive ? balance > 0 : balance < 0)
+                {
+                    writer.row(accounts[i].first, accounts[i].second, {Decimal::fromRaw(positive ? balance : -balance)});
+                }
+            }
+        }
+
+    } // namespace accounting
+} // namespace market
@@ -0,0 +1,78 @@
+#include "accounting/ReportEngine.h"
+#include <stdexcept>
+
+namespace market
+{
+    namespace accounting
+    {
+
+        std::shared_ptr<ReportEngine> ReportEngine::create(
+            std::shared_ptr<Ledger> ledger,
+            std::shared_ptr<ThreadPool> pool)
+        {
+            if (!ledger)
+            {
+                throw std::invalid_argument("Ledger cannot be null");
+            }
+            return std::shared_ptr<ReportEngine>(new ReportEngine(ledger, pool));
+        }
+
+        ReportEngine::ReportEngine(std::shared_ptr<Ledger> ledger, std::shared_ptr<ThreadPool> pool)
+            : ledger_(ledger), pool_(pool), balanceCount_(0) {}
+
+        std::shared_ptr<TrialBalance> ReportEngine::addTrialBalance(
+            const std::vector<std::pair<std::string, std::string>> &accountNames,
+            bool showEmptyAccounts)
+        {
+            std::shared_ptr<TrialBalance> report(new TrialBalance(ledger_, accountNames, showEmptyAccounts, pool_));
+            reports_.push_back(report);
+            return report;
+        }
+
+        std::shared_ptr<IncomeStatement> ReportEngine::addIncomeStatement(
+            const std::vector<std::pair<std::string, std::string>> &revenueAccounts,
+            const std::vector<std::pair<std::string, std::string>> &expenseAccounts,
+            bool)
+        {
+            std::shared_ptr<IncomeStatement> report(new IncomeStatement(ledger_, revenueAccounts, expenseAccounts, pool_));
+            reports_.push_back(report);
+            return report;
+        }
+
+        std::shared_ptr<CashFlowStatement> ReportEngine::addCashFlowStatement(
+            const std::vector<std::pair<std::string, std::string>> &inflowAccounts,
+            const std::vector<std::pair<std::string, std::string>> &outflowAccounts,
+            bool)
+        {
+            std::shared_ptr<CashFlowStatement> report(new CashFlowStatement(ledger_, inflowAccounts, outflowAccounts, pool_));
+            reports_.push_back(report);
+            return report;
+        }
+
+        void ReportEngine::addReport(IReportPtr report)
+        {
+            if (!report)
+            {
+                throw std::invalid_argument("Report cannot be null");
+            }
+            reports_.push_back(report);
+        }
+
+        void ReportEngine::run()
+        {
+            BalanceCache balances;
+            for (const auto &report : reports_)
+            {
+                report->collectBalanceRequests(balances);
+            }
+            balances.resolve(*ledger_, pool_.get());
+            balanceCount_ = balances.size();
+
+            for (const auto &report : reports_)
+            {
+                report->compute(balances);
+            }
+        }
+
+    } // namespace accounting
+} // namespace market
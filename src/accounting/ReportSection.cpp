@@ -0,0 +1,68 @@
+#include "accounting/ReportSection.h"
+#include "accounting/BalanceKernel.h"
+
+namespace market
+{
+    namespace accounting
+    {
+
+        ReportSection::ReportSection(const std::vector<std::pair<std::string, std::string>> &accounts)
+            : accounts_(accounts.begin(), accounts.end()), balances_(accounts.size(), 0)
+        {
+            for (std::size_t i = 0; i < accounts_.size(); ++i)
+            {
+                positions_[accounts_[i].first].push_back(i);
+            }
+        }
+
+        void ReportSection::request(BalanceCache &balances) const
+        {
+            for (const auto &acc : accounts_)
+            {
+                balances.request(acc.first);
+            }
+        }
+
+        void ReportSection::load(const BalanceCache &balances, ThreadPool *pool)
+        {
+            std::size_t chunks = ThreadPool::chunkCount(accounts_.size(), ThreadPool::ACCOUNT_GRAIN);
+            std::vector<std::int64_t> chunkPositive(chunks, 0);
+            std::vector<std::int64_t> chunkNegative(chunks, 0);
+            ThreadPool::parallelFor(pool, accounts_.size(), ThreadPool::ACCOUNT_GRAIN, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                                    {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    balances_[i] = balances.getRawBalance(accounts_[i].first);
+                }
+                BalanceKernel::sumBySign(balances_.data() + begin, end - begin, chunkPositive[chunk], chunkNegative[chunk]); });
+
+            // Reduce in chunk order so the totals do not depend on scheduling
+            positive_ = 0;
+            negative_ = 0;
+            for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                positive_ += chunkPositive[chunk];
+                negative_ += chunkNegative[chunk];
+            }
+        }
+
+        bool ReportSection::apply(Symbol accountId, std::int64_t delta)
+        {
+            const auto *positions = positions_.find(accountId);
+            if (!positions)
+            {
+                return false;
+            }
+            for (std::size_t i : *positions)
+            {
+                std::int64_t before = balances_[i];
+                std::int64_t after = before + delta;
+                balances_[i] = after;
+                positive_ += (after > 0 ? after : 0) - (before > 0 ? before : 0);
+                negative_ += (after < 0 ? after : 0) - (before < 0 ? before : 0);
+            }
+            return true;
+        }
+
+    } // namespace accounting
+} // namespace market
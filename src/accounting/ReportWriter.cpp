@@ -0,0 +1,569 @@
+#include "accounting/ReportWriter.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace market
+{
+    namespace accounting
+    {
+        namespace
+        {
+            // Same layout as the std::setw tables the reports used to print:
+            // a 16-wide ID, 24-wide name and 16-wide amount columns. Text
+            // longer than its column is written in full, as setw does.
+            class TextReportWriter : public ReportWriter
+            {
+            public:
+                explicit TextReportWriter(std::ostream &out) : ReportWriter(out), width_(0), afterSection_(false) {}
+
+            private:
+                static constexpr std::size_t ID_WIDTH = 16;
+                static constexpr std::size_t NAME_WIDTH = 24;
+                static constexpr std::size_t AMOUNT_WIDTH = 16;
+
+                void writeBeginReport(std::string_view title, std::initializer_list<std::string_view> columns) override
+                {
+                    width_ = ID_WIDTH + NAME_WIDTH + AMOUNT_WIDTH * columns.size();
+                    put('\n');
+                    put(title);
+                    put('\n');
+                    putLeft("Account ID", ID_WIDTH);
+                    putLeft("Account Name", NAME_WIDTH);
+                    for (std::string_view column : columns)
+                    {
+                        putRight(column, AMOUNT_WIDTH);
+                    }
+                    put('\n');
+                    putRule();
+                    afterSection_ = false;
+                }
+
+                void writeRow(Symbol accountId, std::string_view accountName, std::initializer_list<Decimal> amounts) override
+                {
+                    putLeft(accountId.str(), ID_WIDTH);
+                    putLeft(accountName, NAME_WIDTH);
+                    putAmounts(amounts);
+                    afterSection_ = false;
+                }
+
+                void writeBeginSection(std::string_view name) override
+                {
+                    put(name);
+                    put('\n');
+                    afterSection_ = false;
+                }
+
+                void writeEndSection(std::string_view label, std::initializer_list<Decimal> totals) override
+                {
+                    putRule();
+                    putLeft(label, ID_WIDTH + NAME_WIDTH);
+                    putAmounts(totals);
+                    putRule();
+                    afterSection_ = true;
+                }
+
+                void writeTotal(std::string_view label, std::initializer_list<Decimal> amounts) override
+                {
+                    // A section already closed with a rule
+                    if (!afterSection_)
+                    {
+                        putRule();
+                    }
+                    putLeft(label, ID_WIDTH + NAME_WIDTH);
+                    putAmounts(amounts);
+                    afterSection_ = false;
+                }
+
+                void writeStatus(std::string_view text) override
+                {
+                    put(text);
+                    put('\n');
+                }
+
+                void writeEndReport() override {}
+
+                void putLeft(std::string_view text, std::size_t width)
+                {
+                    put(text);
+                    if (text.size() < width)
+                    {
+                        putSpaces(width - text.size());
+                    }
+                }
+
+                void putRight(std::string_view text, std::size_t width)
+                {
+                    if (text.size() < width)
+                    {
+                        putSpaces(width - text.size());
+                    }
+                    put(text);
+                }
+
+                void putAmounts(std::initializer_list<Decimal> amounts)
+                {
+                    char text[Decimal::MAX_CHARS];
+                    for (const Decimal &amount : amounts)
+                    {
+                        auto result = amount.toChars(text, text + sizeof(text));
+                        putRight(std::string_view(text, static_cast<std::size_t>(result.ptr - text)), AMOUNT_WIDTH);
+                    }
+                    put('\n');
+                }
+
+                void putRule()
+                {
+                    for (std::size_t i = 0; i < width_; ++i)
+                    {
+                        put('-');
+                    }
+                    put('\n');
+                }
+
+                std::size_t width_;
+                bool afterSection_;
+            };
+
+            // RFC 4180: a header line of column names, then one line per row
+            // or total. Totals leave the account ID empty and carry their
+            // label in the name column.
+            class CsvReportWriter : public ReportWriter
+            {
+            public:
+                explicit CsvReportWriter(std::ostream &out) : ReportWriter(out) {}
+
+            private:
+                void writeBeginReport(std::string_view, std::initializer_list<std::string_view> columns) override
+                {
+                    put("Section,Account ID,Account Name");
+                    for (std::string_view column : columns)
+                    {
+                        put(',');
+                        putField(column);
+                    }
+                    put('\n');
+                }
+
+                void writeRow(Symbol accountId, std::string_view accountName, std::initializer_list<Decimal> amounts) override
+                {
+                    putLine(accountId.str(), accountName, amounts);
+                }
+
+                void writeBeginSection(std::string_view) override {}
+
+                void writeEndSection(std::string_view label, std::initializer_list<Decimal> totals) override
+                {
+                    putLine({}, label, totals);
+                }
+
+                void writeTotal(std::string_view label, std::initializer_list<Decimal> amounts) override
+                {
+                    putLine({}, label, amounts);
+                }
+
+                void writeStatus(std::string_view text) override
+                {
+                    put(",,");
+                    putField(text);
+                    for (std::size_t i = 0; i < getColumnCount(); ++i)
+                    {
+                        put(',');
+                    }
+                    put('\n');
+                }
+
+                void writeEndReport() override {}
+
+                void putLine(std::string_view accountId, std::string_view name, std::initializer_list<Decimal> amounts)
+                {
+                    putField(getSection());
+                    put(',');
+                    putField(accountId);
+                    put(',');
+                    putField(name);
+                    for (const Decimal &amount : amounts)
+                    {
+                        put(',');
+                        put(amount);
+                    }
+                    put('\n');
+                }
+
+                // Quoted, with quotes doubled, only when it has to be
+                void putField(std::string_view text)
+                {
+                    if (text.find_first_of(",\"\r\n") == std::string_view::npos)
+                    {
+                        put(text);
+                        return;
+                    }
+                    put('"');
+                    for (char c : text)
+                    {
+                        if (c == '"')
+                        {
+                            put('"');
+                        }
+                        put(c);
+                    }
+                    put('"');
+                }
+            };
+
+            // One object per line. The first names the report; rows and totals
+            // key their amounts by column name and carry the section, if any.
+            // Amounts are JSON numbers holding the exact decimal text.
+            class JsonLinesReportWriter : public ReportWriter
+            {
+            public:
+                explicit JsonLinesReportWriter(std::ostream &out) : ReportWriter(out) {}
+
+            private:
+                void writeBeginReport(std::string_view title, std::initializer_list<std::string_view> columns) override
+                {
+                    columns_.assign(columns.begin(), columns.end());
+                    put("{\"report\":");
+                    putString(title);
+                    put(",\"columns\":[");
+                    for (std::size_t i = 0; i < columns_.size(); ++i)
+                    {
+                        if (i != 0)
+                        {
+                            put(',');
+                        }
+                        putString(columns_[i]);
+                    }
+                    put("]}\n");
+                }
+
+                void writeRow(Symbol accountId, std::string_view accountName, std::initializer_list<Decimal> amounts) override
+                {
+                    put('{');
+                    putSection();
+                    put("\"account\":");
+                    putString(accountId.str());
+                    put(",\"name\":");
+                    putString(accountName);
+                    putAmounts(amounts);
+                }
+
+                void writeBeginSection(std::string_view) override {}
+
+                void writeEndSection(std::string_view label, std::initializer_list<Decimal> totals) override
+                {
+                    writeTotal(label, totals);
+                }
+
+                void writeTotal(std::string_view label, std::initializer_list<Decimal> amounts) override
+                {
+                    put('{');
+                    putSection();
+                    put("\"total\":");
+                    putString(label);
+                    putAmounts(amounts);
+                }
+
+                void writeStatus(std::string_view text) override
+                {
+                    put("{\"status\":");
+                    putString(text);
+                    put("}\n");
+                }
+
+                void writeEndReport() override {}
+
+                void putSection()
+                {
+                    if (!getSection().empty())
+                    {
+                        put("\"section\":");
+                        putString(getSection());
+                        put(',');
+                    }
+                }
+
+                // Closes the object begun by the caller
+                void putAmounts(std::initializer_list<Decimal> amounts)
+                {
+                    std::size_t column = 0;
+                    for (const Decimal &amount : amounts)
+                    {
+                        put(',');
+                        putString(columns_[column++]);
+                        put(':');
+                        put(amount);
+                    }
+                    put("}\n");
+                }
+
+                void putString(std::string_view text)
+                {
+                    static const char HEX[] = "0123456789abcdef";
+                    put('"');
+                    for (char c : text)
+                    {
+                        unsigned char byte = static_cast<unsigned char>(c);
+                        if (c == '"' || c == '\\')
+                        {
+                            put('\\');
+                            put(c);
+                        }
+                        else if (byte < 0x20)
+                        {
+                            put("\\u00");
+                            put(HEX[byte >> 4]);
+                            put(HEX[byte & 0xF]);
+                        }
+                        else
+                        {
+                            put(c);
+                        }
+                    }
+                    put('"');
+                }
+
+                std::vector<std::string> columns_;
+            };
+
+            // Little-endian records, each a one-byte tag then its fields.
+            // Strings are a u32 length and the bytes; amounts are the raw
+            // i64 Decimal values at the scale given in the report header.
+            class BinaryReportWriter : public ReportWriter
+            {
+            public:
+                explicit BinaryReportWriter(std::ostream &out) : ReportWriter(out) {}
+
+            private:
+                static constexpr char MAGIC[4] = {'M', 'R', 'P', 'T'};
+                static constexpr std::uint8_t VERSION = 1;
+
+                enum Tag : std::uint8_t
+                {
+                    BEGIN_REPORT = 1, // magic, version, scale, title, u8 column count, column names
+                    ROW = 2,          // account ID, name, amounts
+                    BEGIN_SECTION = 3, // name
+                    END_SECTION = 4,  // label, totals
+                    TOTAL = 5,        // label, amounts
+                    STATUS = 6,       // text
+                    END_REPORT = 7
+                };
+
+                void writeBeginReport(std::string_view title, std::initializer_list<std::string_view> columns) override
+                {
+                    if (columns.size() > 0xFF)
+                    {
+                        throw std::invalid_argument("Binary reports hold at most 255 columns");
+                    }
+                    put(static_cast<char>(BEGIN_REPORT));
+                    put(std::string_view(MAGIC, sizeof(MAGIC)));
+                    put(static_cast<char>(VERSION));
+                    put(static_cast<char>(Decimal::SCALE));
+                    putString(title);
+                    put(static_cast<char>(columns.size()));
+                    for (std::string_view column : columns)
+                    {
+                        putString(column);
+                    }
+                }
+
+                void writeRow(Symbol accountId, std::string_view accountName, std::initializer_list<Decimal> amounts) override
+                {
+                    put(static_cast<char>(ROW));
+                    putString(accountId.str());
+                    putString(accountName);
+                    putAmounts(amounts);
+                }
+
+                void writeBeginSection(std::string_view name) override
+                {
+                    put(static_cast<char>(BEGIN_SECTION));
+                    putString(name);
+                }
+
+                void writeEndSection(std::string_view label, std::initializer_list<Decimal> totals) override
+                {
+                    put(static_cast<char>(END_SECTION));
+                    putString(label);
+                    putAmounts(totals);
+                }
+
+                void writeTotal(std::string_view label, std::initializer_list<Decimal> amounts) override
+                {
+                    put(static_cast<char>(TOTAL));
+                    putString(label);
+                    putAmounts(amounts);
+                }
+
+                void writeStatus(std::string_view text) override
+                {
+                    put(static_cast<char>(STATUS));
+                    putString(text);
+                }
+
+                void writeEndReport() override
+                {
+                    put(static_cast<char>(END_REPORT));
+                }
+
+                void putString(std::string_view text)
+                {
+                    putUint32(static_cast<std::uint32_t>(text.size()));
+                    put(text);
+                }
+
+                void putAmounts(std::initializer_list<Decimal> amounts)
+                {
+                    for (const Decimal &amount : amounts)
+                    {
+                        putInt64(amount.toRaw());
+                    }
+                }
+            };
+        }
+
+        std::shared_ptr<ReportWriter> ReportWriter::create(ReportFormat format, std::ostream &out)
+        {
+            switch (format)
+            {
+            case ReportFormat::TEXT:
+                return std::shared_ptr<ReportWriter>(new TextReportWriter(out));
+            case ReportFormat::CSV:
+                return std::shared_ptr<ReportWriter>(new CsvReportWriter(out));
+            case ReportFormat::JSON_LINES:
+                return std::shared_ptr<ReportWriter>(new JsonLinesReportWriter(out));
+            case ReportFormat::BINARY:
+                return std::shared_ptr<ReportWriter>(new BinaryReportWriter(out));
+            }
+            throw std::invalid_argument("Unknown report format");
+        }
+
+        ReportWriter::ReportWriter(std::ostream &out) : out_(out), columns_(0), used_(0)
+        {
+        }
+
+        ReportWriter::~ReportWriter()
+        {
+            try
+            {
+                flush();
+            }
+            catch (...)
+            {
+                // A stream set to throw must not take the program down from
+                // a destructor
+            }
+        }
+
+        void ReportWriter::beginReport(std::string_view title, std::initializer_list<std::string_view> columns)
+        {
+            columns_ = columns.size();
+            section_.clear();
+            writeBeginReport(title, columns);
+        }
+
+        void ReportWriter::row(Symbol accountId, std::string_view accountName, std::initializer_list<Decimal> amounts)
+        {
+            checkAmounts(amounts.size());
+            writeRow(accountId, accountName, amounts);
+        }
+
+        void ReportWriter::beginSection(std::string_view name)
+        {
+            section_.assign(name.data(), name.size());
+            writeBeginSection(name);
+        }
+
+        void ReportWriter::endSection(std::string_view label, std::initializer_list<Decimal> totals)
+        {
+            checkAmounts(totals.size());
+            writeEndSection(label, totals);
+            section_.clear();
+        }
+
+        void ReportWriter::total(std::string_view label, std::initializer_list<Decimal> amounts)
+        {
+            checkAmounts(amounts.size());
+            writeTotal(label, amounts);
+        }
+
+        void ReportWriter::status(std::string_view text)
+        {
+            writeStatus(text);
+        }
+
+        void ReportWriter::endReport()
+        {
+            writeEndReport();
+        }
+
+        void ReportWriter::flush()
+        {
+            spill();
+            out_.flush();
+        }
+
+        void ReportWriter::spill()
+        {
+            if (used_ > 0)
+            {
+                // Cleared first, so a stream that throws does not get the
+                // same bytes again from the destructor
+                std::size_t used = used_;
+                used_ = 0;
+                out_.write(buffer_, static_cast<std::streamsize>(used));
+            }
+        }
+
+        void ReportWriter::putSlow(std::string_view text)
+        {
+            while (!text.empty())
+            {
+                if (used_ == BUFFER_SIZE)
+                {
+                    spill();
+                }
+                std::size_t count = std::min(text.size(), BUFFER_SIZE - used_);
+                text.copy(buffer_ + used_, count);
+                used_ += count;
+                text.remove_prefix(count);
+            }
+        }
+
+        void ReportWriter::put(Decimal value)
+        {
+            if (BUFFER_SIZE - used_ < Decimal::MAX_CHARS)
+            {
+                spill();
+            }
+            auto result = value.toChars(buffer_ + used_, buffer_ + BUFFER_SIZE);
+            used_ = static_cast<std::size_t>(result.ptr - buffer_);
+        }
+
+        void ReportWriter::putUint32(std::uint32_t value)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                put(static_cast<char>((value >> shift) & 0xFF));
+            }
+        }
+
+        void ReportWriter::putInt64(std::int64_t value)
+        {
+            std::uint64_t bits = static_cast<std::uint64_t>(value);
+            for (int shift = 0; shift < 64; shift += 8)
+            {
+                put(static_cast<char>((bits >> shift) & 0xFF));
+            }
+        }
+
+        void ReportWriter::checkAmounts(std::size_t count) const
+        {
+            if (count != columns_)
+            {
+                throw std::invalid_argument("Expected " + std::to_string(columns_) + " amounts, got " + std::to_string(count));
+            }
+        }
+
+    } // namespace accounting
+} // namespace market
@@ -1,71 +1,138 @@
 #include "accounting/TrialBalance.h"
-#include <iomanip>
-#include <iostream>
 
 namespace market
 {
     namespace accounting
     {
 
-        std::shared_ptr<TrialBalance> TrialBalance::create(std::shared_ptr<Ledger> ledger, const std::vector<std::pair<std::string, std::string>> &accountNames, bool showEmptyAccounts)
+        std::shared_ptr<TrialBalance> TrialBalance::create(
+            std::shared_ptr<Ledger> ledger,
+            const std::vector<std::pair<std::string, std::string>> &accountNames,
+            bool showEmptyAccounts,
+            std::shared_ptr<ThreadPool> pool)
         {
-            return std::shared_ptr<TrialBalance>(new TrialBalance(ledger, accountNames, showEmptyAccounts));
+            std::shared_ptr<TrialBalance> report(new TrialBalance(ledger, accountNames, showEmptyAccounts, pool));
+            report->compute();
+            return report;
         }
 
-        TrialBalance::TrialBalance(std::shared_ptr<Ledger> ledger, const std::vector<std::pair<std::string, std::string>> &accountNames, bool showEmptyAccounts)
-            : ledger_(ledger), accountNames_(accountNames), totalDebits_(0), totalCredits_(0), showEmptyAccounts_(showEmptyAccounts)
+        TrialBalance::TrialBalance(
+            std::shared_ptr<Ledger> ledger,
+            const std::vector<std::pair<std::string, std::string>> &accountNames,
+            bool showEmptyAccounts,
+            std::shared_ptr<ThreadPool> pool)
+            : LiveReport(ledger, pool), accounts_(accountNames), showEmptyAccounts_(showEmptyAccounts)
         {
-            compute();
         }
 
-        void TrialBalance::compute()
+        void TrialBalance::collectBalanceRequests(BalanceCache &balances) const
         {
-            lines_.clear();
-            totalDebits_ = Decimal(0);
-            totalCredits_ = Decimal(0);
-            for (const auto &acc : accountNames_)
+            accounts_.request(balances);
+        }
+
+        bool TrialBalance::isBalanced() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return accounts_.getPositiveTotal() == -accounts_.getNegativeTotal();
+        }
+
+        Decimal TrialBalance::getTotalDebits() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return Decimal::fromRaw(accounts_.getPositiveTotal());
+        }
+
+        Decimal TrialBalance::getTotalCredits() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return Decimal::fromRaw(-accounts_.getNegativeTotal());
+        }
+
+        std::vector<TrialBalance::AccountLine> TrialBalance::getLines() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buildLines();
+            return lines_;
+        }
+
+        void TrialBalance::loadSections(const BalanceCache &balances)
+        {
+            // Debit balances add up to total debits, credit balances to total credits
+            accounts_.load(balances, pool_.get());
+        }
+
+        bool TrialBalance::applyLine(Symbol accountId, std::int64_t delta)
+        {
+            return accounts_.apply(accountId, delta);
+        }
+
+        void TrialBalance::buildLines() const
+        {
+            if (!linesStale_)
             {
-                Decimal balance = ledger_->getBalance(acc.first);
+                return;
+            }
+            const auto &accountNames = accounts_.getAccounts();
+            lines_ = accounts_.buildLines<AccountLine>(pool_.get(), [&](std::vector<AccountLine> &lines, std::size_t i, std::int64_t raw)
+                                                       {
+                Decimal balance = Decimal::fromRaw(raw);
                 if (!showEmptyAccounts_ && balance == Decimal(0))
                 {
-                    continue;
+                    return;
                 }
                 AccountLine line;
-                line.accountId = acc.first;
-                line.accountName = acc.second;
+                line.accountId = accountNames[i].first;
+                line.accountName = accountNames[i].second;
                 if (balance >= Decimal(0))
                 {
                     line.debit = balance;
                     line.credit = Decimal(0);
-                    totalDebits_ = totalDebits_ + balance;
                 }
                 else
                 {
                     line.debit = Decimal(0);
                     line.credit = -balance;
-                    totalCredits_ = totalCredits_ + (-balance);
                 }
-                lines_.push_back(line);
-            }
+                lines.push_back(line); });
+            linesStale_ = false;
         }
 
-        void TrialBalance::generate(std::ostream &out) const
+        void TrialBalance::write(ReportWriter &writer) const
         {
-            out << "\nTRIAL BALANCE\n";
-            out << std::left << std::setw(16) << "Account ID" << std::setw(24) << "Account Name" << std::right << std::setw(16) << "Debit" << std::setw(16) << "Credit" << "\n";
-            out << std::string(72, '-') << "\n";
-            for (const auto &line : lines_)
+            // Rows come straight from a copy of the balances, taken under the
+            // lock so that postings are not held up while the writer formats
+            std::vector<std::int64_t> balances;
+            Decimal totalDebits;
+            Decimal totalCredits;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                balances = accounts_.getBalances();
+                totalDebits = Decimal::fromRaw(accounts_.getPositiveTotal());
+                totalCredits = Decimal::fromRaw(-accounts_.getNegativeTotal());
+            }
+            const auto &accountNames = accounts_.getAccounts();
+
+            writer.beginReport("TRIAL BALANCE", {"Debit", "Credit"});
+            for (std::size_t i = 0; i < balances.size(); ++i)
             {
-                out << std::left << std::setw(16) << line.accountId
-                    << std::setw(24) << line.accountName
-                    << std::right << std::setw(16) << line.debit.toString()
-                    << std::setw(16) << line.credit.toString() << "\n";
+                std::int64_t raw = balances[i];
+                if (!showEmptyAccounts_ && raw == 0)
+                {
+                    continue;
+                }
+                Decimal balance = Decimal::fromRaw(raw);
+                if (raw >= 0)
+                {
+                    writer.row(accountNames[i].first, accountNames[i].second, {balance, Decimal(0)});
+                }
+                else
+                {
+                    writer.row(accountNames[i].first, accountNames[i].second, {Decimal(0), -balance});
+                }
             }
-            out << std::string(72, '-') << "\n";
-            out << std::left << std::setw(40) << "TOTALS"
-                << std::right << std::setw(16) << totalDebits_.toString()
-                << std::setw(16) << totalCredits_.toString() << "\n";
-            out << (isBalanced() ? "BALANCED" : "NOT BALANCED") << "\n";
+            writer.total("TOTALS", {totalDebits, totalCredits});
+            writer.status(totalDebits == totalCredits ? "BALANCED" : "NOT BALANCED");
+            writer.endReport();
         }
 
     } // namespace accounting
@@ -18,36 +18,19 @@ namespace market::contracts
         return std::shared_ptr<Contract>(new Contract(idGen_.next(), type, party1, party2));
     }
 
-    Contract::Contract(const std::string &id, const std::string &type, std::shared_ptr<market::core::Account> party1, std::shared_ptr<market::core::Account> party2)
-        : id_(id), type_(type), party1_(party1), party2_(party2), state_(State::DRAFT)
-    {
-        if (id.empty())
-            throw std::invalid_argument("Contract ID cannot be empty");
-    }
-
-    bool Contract::hasRequiredTerms() const
+    std::shared_ptr<Contract> Contract::restore(const std::string &id, const std::string &type, std::shared_ptr<market::core::Account> party1, std::shared_ptr<market::core::Account> party2)
     {
-        return !terms_.empty() && terms_.count("amount") > 0 && terms_.count("currency") > 0;
+        if (!party1 || !party2)
+            throw std::invalid_argument("Both parties must be valid");
+        idGen_.observe(id);
+        return std::shared_ptr<Contract>(new Contract(id, type, party1, party2));
     }
 
-    bool Contract::validateTermValues() const
+    Contract::Contract(const std::string &id, const std::string &type, std::shared_ptr<market::core::Account> party1, std::shared_ptr<market::core::Account> party2)
+        : id_(id), type_(type), state_(State::DRAFT), party1_(party1), party2_(party2)
     {
-        try
-        {
-            if (terms_.count("amount") > 0)
-            {
-                Decimal amount(terms_.at("amount"));
-                if (amount <= Decimal(0))
-                {
-                    return false;
-                }
-            }
-            return true;
-        }
-        catch (const std::exception &)
-        {
-            return false;
-        }
+        if (id.empty())
+            throw std::invalid_argument("Contract ID cannot be empty");
     }
 
 } // namespace market::contracts
\ No newline at end of file
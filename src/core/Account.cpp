@@ -1,5 +1,7 @@
 #include "core/Account.h"
 #include "financial/Wallet.h"
+#include "financial/Asset.h"
+#include "financial/Liability.h"
 #include "contracts/Contract.h"
 #include <stdexcept>
 
@@ -17,6 +19,12 @@ namespace market::core
         return std::shared_ptr<Account>(new Account(idGen_.next(), name, type));
     }
 
+    std::shared_ptr<Account> Account::restore(const std::string &id, const std::string &name, AccountType type)
+    {
+        idGen_.observe(id);
+        return std::shared_ptr<Account>(new Account(id, name, type));
+    }
+
     Account::Account(const std::string &id, const std::string &name, AccountType type)
         : id_(id), name_(name), type_(type)
     {
@@ -36,17 +44,59 @@ namespace market::core
         {
             throw std::invalid_argument("Wallet cannot be null");
         }
-        if (wallets_.find(wallet->getId()) != wallets_.end())
+        if (!wallets_.insert(wallet))
         {
             throw std::runtime_error("Wallet with ID " + wallet->getId() + " already exists");
         }
-        wallets_[wallet->getId()] = wallet;
     }
 
     std::shared_ptr<market::financial::Wallet> Account::getWallet(const std::string &walletId) const
     {
-        auto it = wallets_.find(walletId);
-        return it != wallets_.end() ? it->second : nullptr;
+        return wallets_.get(walletId);
+    }
+
+    void Account::addAsset(std::shared_ptr<market::financial::Asset> asset)
+    {
+        if (!asset)
+        {
+            throw std::invalid_argument("Asset cannot be null");
+        }
+        if (!assets_.insert(asset))
+        {
+            throw std::runtime_error("Asset with ID " + asset->getId() + " already exists");
+        }
+    }
+
+    void Account::removeAsset(const std::string &assetId)
+    {
+        assets_.erase(assetId);
+    }
+
+    std::shared_ptr<market::financial::Asset> Account::getAsset(const std::string &assetId) const
+    {
+        return assets_.get(assetId);
+    }
+
+    void Account::addLiability(std::shared_ptr<market::financial::Liability> liability)
+    {
+        if (!liability)
+        {
+            throw std::invalid_argument("Liability cannot be null");
+        }
+        if (!liabilities_.insert(liability))
+        {
+            throw std::runtime_error("Liability with ID " + liability->getId() + " already exists");
+        }
+    }
+
+    void Account::removeLiability(const std::string &liabilityId)
+    {
+        liabilities_.erase(liabilityId);
+    }
+
+    std::shared_ptr<market::financial::Liability> Account::getLiability(const std::string &liabilityId) const
+    {
+        return liabilities_.get(liabilityId);
     }
 
     void Account::addContract(std::shared_ptr<market::contracts::Contract> contract)
@@ -55,17 +105,15 @@ namespace market::core
         {
             throw std::invalid_argument("Contract cannot be null");
         }
-        if (contracts_.find(contract->getId()) != contracts_.end())
+        if (!contracts_.insert(contract))
         {
             throw std::runtime_error("Contract with ID " + contract->getId() + " already exists");
         }
-        contracts_[contract->getId()] = contract;
     }
 
     std::shared_ptr<market::contracts::Contract> Account::getContract(const std::string &contractId) const
     {
-        auto it = contracts_.find(contractId);
-        return it != contracts_.end() ? it->second : nullptr;
+        return contracts_.get(contractId);
     }
 
     Decimal Account::getBalance() const
@@ -73,7 +121,7 @@ namespace market::core
         Decimal balance(0);
         for (const auto &wallet : wallets_)
         {
-            balance = balance + wallet.second->getNetWorth();
+            balance = balance + wallet->getNetWorth();
         }
         switch (type_)
         {
@@ -0,0 +1,349 @@
+#include "database/AccountRepository.h"
+#include "database/ConnectionPool.h"
+#include <algorithm>
+#include <stdexcept>
+
+using market::core::Account;
+
+namespace
+{
+    class PooledAccountStore : public AccountStore
+    {
+    public:
+        explicit PooledAccountStore(std::shared_ptr<ConnectionPool> pool) : pool_(std::move(pool)) {}
+
+        AccountPtr load(const std::string &id) override
+        {
+            return pool_->acquire()->loadAccount(id);
+        }
+
+        void loadAll(const std::function<void(AccountPtr)> &visit) override
+        {
+            pool_->acquire()->loadAccounts(visit);
+        }
+
+        void write(const std::vector<AccountPtr> &saved, const std::vector<std::string> &removed) override
+        {
+            // The lease rolls back a transaction left open by a failure
+            ConnectionPool::Lease db = pool_->acquire();
+            db->beginTransaction();
+            if (!saved.empty())
+            {
+                db->saveAccounts(saved);
+            }
+            for (const auto &id : removed)
+            {
+                db->deleteAccount(id);
+            }
+            db->commitTransaction();
+        }
+
+    private:
+        std::shared_ptr<ConnectionPool> pool_;
+    };
+}
+
+std::shared_ptr<AccountRepository> AccountRepository::create(
+    std::shared_ptr<ConnectionPool> pool,
+    const AccountRepositoryOptions &options)
+{
+    if (!pool)
+    {
+        throw std::invalid_argument("Connection pool cannot be null");
+    }
+    return create(std::make_shared<PooledAccountStore>(std::move(pool)), options);
+}
+
+std::shared_ptr<AccountRepository> AccountRepository::create(
+    std::shared_ptr<AccountStore> store,
+    const AccountRepositoryOptions &options)
+{
+    if (!store)
+    {
+        throw std::invalid_argument("Account store cannot be null");
+    }
+    if (options.cacheCapacity == 0 || options.flushBatchSize == 0)
+    {
+        throw std::invalid_argument("Cache capacity and flush batch size must be positive");
+    }
+    return std::shared_ptr<AccountRepository>(new AccountRepository(std::move(store), options));
+}
+
+AccountRepository::AccountRepository(std::shared_ptr<AccountStore> store, const AccountRepositoryOptions &options)
+    : store_(std::move(store)), options_(options), changeCount_(0), stopping_(false)
+{
+    flusher_ = std::thread(&AccountRepository::flusherLoop, this);
+}
+
+AccountRepository::~AccountRepository()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    flusher_.join();
+
+    try
+    {
+        flush();
+    }
+    catch (const std::exception &)
+    {
+        // Nowhere left to report it; see the header
+    }
+}
+
+void AccountRepository::save(std::shared_ptr<Account> account)
+{
+    if (!account)
+    {
+        throw std::invalid_argument("Account cannot be null");
+    }
+    std::string id = account->getId();
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache(id, account);
+    recordChange(id, std::move(account));
+}
+
+std::shared_ptr<Account> AccountRepository::findById(const std::string &id)
+{
+    if (id.empty())
+    {
+        throw std::invalid_argument("Account ID cannot be empty");
+    }
+
+    std::uint64_t changes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (const AccountPtr *pending = findPending(id))
+        {
+            return *pending;
+        }
+        auto it = cached_.find(id);
+        if (it != cached_.end())
+        {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->second;
+        }
+        changes = changeCount_;
+    }
+
+    AccountPtr account = store_->load(id);
+
+    // A change recorded during the load may already have been flushed, so
+    // only cache the row if nothing changed meanwhile
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const AccountPtr *pending = findPending(id))
+    {
+        return *pending;
+    }
+    if (account && changes == changeCount_)
+    {
+        cache(id, account);
+    }
+    return account;
+}
+
+std::vector<std::shared_ptr<Account>> AccountRepository::findAll()
+{
+    // Stored accounts overlaid with pending changes, taken before the
+    // read so that a batch flushed meanwhile is not missed
+    Changes pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending = flushing_;
+        for (const auto &change : dirty_)
+        {
+            pending[change.first] = change.second;
+        }
+    }
+
+    std::vector<AccountPtr> accounts;
+    store_->loadAll([&](AccountPtr account)
+                    {
+        auto it = pending.find(account->getId());
+        if (it == pending.end())
+        {
+            accounts.push_back(std::move(account));
+        } });
+    for (const auto &change : pending)
+    {
+        if (change.second)
+        {
+            accounts.push_back(change.second);
+        }
+    }
+    return accounts;
+}
+
+void AccountRepository::remove(const std::string &id)
+{
+    if (id.empty())
+    {
+        throw std::invalid_argument("Account ID cannot be empty");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    uncache(id);
+    recordChange(id, nullptr);
+}
+
+void AccountRepository::flush()
+{
+    std::lock_guard<std::mutex> flushLock(flushMutex_);
+    std::size_t remaining;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        remaining = dirty_.size();
+    }
+
+    // Changes recorded meanwhile wait for the next flush, so a steady
+    // stream of saves cannot keep this going
+    while (remaining > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (std::size_t i = 0; i < options_.flushBatchSize && !dirty_.empty(); ++i)
+            {
+                flushing_.insert(dirty_.extract(dirty_.begin()));
+            }
+            if (flushing_.empty())
+            {
+                return;
+            }
+        }
+
+        try
+        {
+            write(flushing_);
+        }
+        catch (...)
+        {
+            // Keep the batch pending, except where a newer change replaced it
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &change : flushing_)
+            {
+                dirty_.emplace(change.first, std::move(change.second));
+            }
+            flushing_.clear();
+            throw;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        remaining -= std::min(remaining, flushing_.size());
+        flushing_.clear();
+    }
+}
+
+std::size_t AccountRepository::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirty_.size() + flushing_.size();
+}
+
+std::size_t AccountRepository::getCachedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_.size();
+}
+
+const AccountRepository::AccountPtr *AccountRepository::findPending(const std::string &id) const
+{
+    auto it = dirty_.find(id);
+    if (it != dirty_.end())
+    {
+        return &it->second;
+    }
+    it = flushing_.find(id);
+    if (it != flushing_.end())
+    {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+void AccountRepository::cache(const std::string &id, const AccountPtr &account)
+{
+    auto it = cached_.find(id);
+    if (it != cached_.end())
+    {
+        it->second->second = account;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.emplace_front(id, account);
+    cached_.emplace(id, lru_.begin());
+    if (lru_.size() > options_.cacheCapacity)
+    {
+        cached_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+void AccountRepository::uncache(const std::string &id)
+{
+    auto it = cached_.find(id);
+    if (it != cached_.end())
+    {
+        lru_.erase(it->second);
+        cached_.erase(it);
+    }
+}
+
+void AccountRepository::recordChange(const std::string &id, AccountPtr account)
+{
+    dirty_[id] = std::move(account);
+    ++changeCount_;
+    if (dirty_.size() >= options_.flushBatchSize)
+    {
+        wake_.notify_one();
+    }
+}
+
+void AccountRepository::write(const Changes &changes)
+{
+    std::vector<AccountPtr> saved;
+    std::vector<std::string> removed;
+    for (const auto &change : changes)
+    {
+        if (change.second)
+        {
+            saved.push_back(change.second);
+        }
+        else
+        {
+            removed.push_back(change.first);
+        }
+    }
+    store_->write(saved, removed);
+}
+
+void AccountRepository::flusherLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool failed = false;
+    while (!stopping_)
+    {
+        // After a failure, wait out the interval rather than retrying at once
+        wake_.wait_for(lock, options_.flushInterval, [this, failed]
+                       { return stopping_ || (!failed && dirty_.size() >= options_.flushBatchSize); });
+        if (stopping_ || dirty_.empty())
+        {
+            continue;
+        }
+
+        lock.unlock();
+        try
+        {
+            flush();
+            failed = false;
+        }
+        catch (const std::exception &)
+        {
+            // The batch stays pending and is retried on the next round
+            failed = true;
+        }
+        lock.lock();
+    }
+}
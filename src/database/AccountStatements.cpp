@@ -0,0 +1,109 @@
+#include "database/AccountStatements.h"
+#include <arpa/inet.h>
+#include <cstring>
+#include <stdexcept>
+
+using market::core::Account;
+
+namespace
+{
+    // Type OIDs from pg_type, fixed since they are built in
+    constexpr Oid INT2OID = 21;
+    constexpr Oid VARCHAROID = 1043;
+
+    struct Statement
+    {
+        const char *name;
+        const char *sql;
+        int paramCount;
+        Oid paramTypes[3];
+    };
+
+    const Statement STATEMENTS[AccountStatements::COUNT] = {
+        {AccountStatements::SAVE,
+         "INSERT INTO accounts (id, name, type) VALUES ($1, $2, $3)"
+         " ON CONFLICT (id) DO UPDATE SET name = EXCLUDED.name, type = EXCLUDED.type",
+         3,
+         {VARCHAROID, VARCHAROID, INT2OID}},
+        {AccountStatements::LOAD, "SELECT name, type FROM accounts WHERE id = $1", 1, {VARCHAROID}},
+        {AccountStatements::REMOVE, "DELETE FROM accounts WHERE id = $1", 1, {VARCHAROID}},
+    };
+
+    int length(const std::string &str)
+    {
+        if (str.size() > static_cast<std::size_t>(INT32_MAX))
+        {
+            throw std::invalid_argument("Parameter too long");
+        }
+        return static_cast<int>(str.size());
+    }
+}
+
+const int AccountStatements::Params::FORMATS[3] = {1, 1, 1};
+
+int AccountStatements::sendPrepare(PGconn *conn, int index)
+{
+    const Statement &statement = STATEMENTS[index];
+    return PQsendPrepare(conn, statement.name, statement.sql, statement.paramCount, statement.paramTypes);
+}
+
+void AccountStatements::prepare(PGconn *conn)
+{
+    for (const Statement &statement : STATEMENTS)
+    {
+        PGresult *res = PQprepare(conn, statement.name, statement.sql, statement.paramCount, statement.paramTypes);
+        bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+        if (!ok)
+        {
+            throw std::runtime_error("Failed to prepare " + std::string(statement.name) + ": " + PQerrorMessage(conn));
+        }
+    }
+}
+
+AccountStatements::Params::Params(const Account &account) : count_(3)
+{
+    // Binary int2 is two bytes in network order
+    std::uint16_t type = htons(static_cast<std::uint16_t>(account.getType()));
+    std::memcpy(type_, &type, sizeof(type));
+    values_[0] = account.getId().data();
+    values_[1] = account.getName().data();
+    values_[2] = type_;
+    lengths_[0] = length(account.getId());
+    lengths_[1] = length(account.getName());
+    lengths_[2] = sizeof(type_);
+}
+
+AccountStatements::Params::Params(const std::string &accountId) : count_(1)
+{
+    values_[0] = accountId.data();
+    lengths_[0] = length(accountId);
+}
+
+std::shared_ptr<Account> AccountStatements::readAccount(
+    const PGresult *res, int row, const std::string &accountId, int nameColumn, int typeColumn)
+{
+    std::int16_t type = readInt16(res, row, typeColumn);
+    if (type < static_cast<std::int16_t>(Account::AccountType::ASSET) ||
+        type > static_cast<std::int16_t>(Account::AccountType::EXPENSE))
+    {
+        throw std::runtime_error("Unknown account type for " + accountId);
+    }
+    return Account::restore(accountId, readText(res, row, nameColumn), static_cast<Account::AccountType>(type));
+}
+
+std::int16_t AccountStatements::readInt16(const PGresult *res, int row, int column)
+{
+    if (PQgetlength(res, row, column) != 2)
+    {
+        throw std::runtime_error("Unexpected int2 value from database");
+    }
+    std::uint16_t network;
+    std::memcpy(&network, PQgetvalue(res, row, column), sizeof(network));
+    return static_cast<std::int16_t>(ntohs(network));
+}
+
+std::string AccountStatements::readText(const PGresult *res, int row, int column)
+{
+    return std::string(PQgetvalue(res, row, column), PQgetlength(res, row, column));
+}
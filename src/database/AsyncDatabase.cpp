@@ -0,0 +1,426 @@
+#include "database/AsyncDatabase.h"
+#include "database/AccountStatements.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+using market::core::Account;
+
+namespace
+{
+    int sendPrepared(PGconn *conn, const char *statement, const AccountStatements::Params &params)
+    {
+        return PQsendQueryPrepared(conn, statement, params.count(), params.values(), params.lengths(), params.formats(), 1);
+    }
+
+    std::exception_ptr failure(const std::string &what, const std::string &error)
+    {
+        return std::make_exception_ptr(std::runtime_error(what + ": " + error));
+    }
+}
+
+std::shared_ptr<AsyncDatabase> AsyncDatabase::create(const std::string &host,
+                                                     const std::string &port,
+                                                     const std::string &dbname,
+                                                     const std::string &user,
+                                                     const std::string &password,
+                                                     const AsyncDatabaseOptions &options)
+{
+    if (options.maxInFlight == 0)
+    {
+        throw std::invalid_argument("maxInFlight must be positive");
+    }
+
+    std::string conninfo = "host=" + host + " port=" + port +
+                           " dbname=" + dbname + " user=" + user +
+                           " password=" + password;
+    PGconn *conn = connect(conninfo);
+    try
+    {
+        return std::shared_ptr<AsyncDatabase>(new AsyncDatabase(conn, std::move(conninfo), options));
+    }
+    catch (...)
+    {
+        PQfinish(conn);
+        throw;
+    }
+}
+
+PGconn *AsyncDatabase::connect(const std::string &conninfo)
+{
+    PGconn *conn = PQconnectdb(conninfo.c_str());
+    if (PQstatus(conn) != CONNECTION_OK)
+    {
+        std::string error = PQerrorMessage(conn);
+        PQfinish(conn);
+        throw std::runtime_error("Failed to connect to database: " + error);
+    }
+
+    try
+    {
+        // Prepared before pipeline mode, while results can still be awaited
+        AccountStatements::prepare(conn);
+        if (PQsetnonblocking(conn, 1) != 0 || PQenterPipelineMode(conn) != 1)
+        {
+            throw std::runtime_error("Failed to enter pipeline mode: " + std::string(PQerrorMessage(conn)));
+        }
+        return conn;
+    }
+    catch (...)
+    {
+        PQfinish(conn);
+        throw;
+    }
+}
+
+AsyncDatabase::AsyncDatabase(PGconn *conn, std::string conninfo, const AsyncDatabaseOptions &options)
+    : conn_(conn), conninfo_(std::move(conninfo)), options_(options), outstanding_(0), broken_(false), stopping_(false)
+{
+    // Self-pipe so submitters can wake the loop out of poll()
+    int fds[2];
+    if (::pipe(fds) != 0)
+    {
+        throw std::runtime_error("Cannot create wakeup pipe: " + std::string(std::strerror(errno)));
+    }
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    wakeRead_ = fds[0];
+    wakeWrite_ = fds[1];
+    loop_ = std::thread(&AsyncDatabase::loop, this);
+}
+
+AsyncDatabase::~AsyncDatabase()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    char byte = 0;
+    (void)::write(wakeWrite_, &byte, 1);
+    loop_.join();
+
+    PQfinish(conn_);
+    ::close(wakeRead_);
+    ::close(wakeWrite_);
+}
+
+std::future<void> AsyncDatabase::saveAccount(const std::shared_ptr<Account> &account)
+{
+    if (!account)
+    {
+        throw std::invalid_argument("Account cannot be null");
+    }
+
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> future = promise->get_future();
+    submit(Request{
+        [account](PGconn *conn)
+        { return sendPrepared(conn, AccountStatements::SAVE, AccountStatements::Params(*account)); },
+        [promise](const PGresult *, const std::string &error)
+        {
+            if (!error.empty())
+            {
+                promise->set_exception(failure("Failed to save account", error));
+                return;
+            }
+            promise->set_value();
+        }});
+    return future;
+}
+
+std::future<std::shared_ptr<Account>> AsyncDatabase::loadAccount(const std::string &accountId)
+{
+    if (accountId.empty())
+    {
+        throw std::invalid_argument("Account ID cannot be empty");
+    }
+
+    auto promise = std::make_shared<std::promise<std::shared_ptr<Account>>>();
+    std::future<std::shared_ptr<Account>> future = promise->get_future();
+    submit(Request{
+        [accountId](PGconn *conn)
+        { return sendPrepared(conn, AccountStatements::LOAD, AccountStatements::Params(accountId)); },
+        [promise, accountId](const PGresult *result, const std::string &error)
+        {
+            if (!error.empty())
+            {
+                promise->set_exception(failure("Failed to load account", error));
+                return;
+            }
+            try
+            {
+                promise->set_value(result && PQntuples(result) > 0
+                                       ? AccountStatements::readAccount(result, 0, accountId)
+                                       : nullptr);
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        }});
+    return future;
+}
+
+std::future<void> AsyncDatabase::deleteAccount(const std::string &accountId)
+{
+    if (accountId.empty())
+    {
+        throw std::invalid_argument("Account ID cannot be empty");
+    }
+
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> future = promise->get_future();
+    submit(Request{
+        [accountId](PGconn *conn)
+        { return sendPrepared(conn, AccountStatements::REMOVE, AccountStatements::Params(accountId)); },
+        [promise](const PGresult *, const std::string &error)
+        {
+            if (!error.empty())
+            {
+                promise->set_exception(failure("Failed to delete account", error));
+                return;
+            }
+            promise->set_value();
+        }});
+    return future;
+}
+
+void AsyncDatabase::drain()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_.wait(lock, [this]
+                { return outstanding_ == 0; });
+}
+
+std::size_t AsyncDatabase::getInFlightCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outstanding_;
+}
+
+bool AsyncDatabase::isConnected() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !broken_;
+}
+
+void AsyncDatabase::submit(Request request)
+{
+    bool wake;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [this]
+                    { return outstanding_ < options_.maxInFlight; });
+        wake = queued_.empty();
+        queued_.push_back(std::move(request));
+        ++outstanding_;
+    }
+
+    // One byte per batch is enough; the loop takes the whole queue
+    if (wake)
+    {
+        char byte = 0;
+        (void)::write(wakeWrite_, &byte, 1);
+    }
+}
+
+void AsyncDatabase::loop()
+{
+    std::vector<Request> batch;
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ && queued_.empty() && inFlight_.empty())
+            {
+                return;
+            }
+            batch.swap(queued_);
+        }
+        // Only this thread sets broken_, so it is read here unlocked
+        if (broken_ && !batch.empty())
+        {
+            reconnect();
+        }
+        sendQueued(batch);
+
+        // PQflush returns 1 while data is still waiting to go out. It may
+        // read input to make room, which the socket will not signal again,
+        // so results are collected after every flush.
+        int flushed = broken_ ? 0 : PQflush(conn_);
+        if (flushed < 0)
+        {
+            failAll(PQerrorMessage(conn_));
+        }
+        else if (!broken_)
+        {
+            readResults();
+        }
+
+        pollfd fds[2] = {{PQsocket(conn_), POLLIN, 0}, {wakeRead_, POLLIN, 0}};
+        if (flushed == 1)
+        {
+            fds[0].events |= POLLOUT;
+        }
+        bool watchSocket = !broken_ && fds[0].fd >= 0;
+        if (::poll(watchSocket ? fds : fds + 1, watchSocket ? 2 : 1, -1) < 0 && errno != EINTR)
+        {
+            failAll(std::strerror(errno));
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            char buffer[64];
+            while (::read(wakeRead_, buffer, sizeof(buffer)) > 0)
+            {
+            }
+        }
+        if (watchSocket && (fds[0].revents & (POLLIN | POLLERR | POLLHUP)))
+        {
+            if (PQconsumeInput(conn_) != 1)
+            {
+                failAll(PQerrorMessage(conn_));
+                continue;
+            }
+            readResults();
+        }
+    }
+}
+
+void AsyncDatabase::sendQueued(std::vector<Request> &batch)
+{
+    for (Request &request : batch)
+    {
+        bool broken;
+        std::string error;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            broken = broken_;
+            error = brokenError_;
+        }
+        if (broken)
+        {
+            Pending pending(std::move(request));
+            pending.error = "Database connection lost: " + error;
+            finish(pending);
+            continue;
+        }
+
+        // Sync after every statement so each commits on its own
+        if (!request.send(conn_) || PQpipelineSync(conn_) != 1)
+        {
+            Pending pending(std::move(request));
+            pending.error = PQerrorMessage(conn_);
+            finish(pending);
+            failAll(pending.error);
+            continue;
+        }
+        inFlight_.emplace_back(std::move(request));
+    }
+    batch.clear();
+}
+
+void AsyncDatabase::readResults()
+{
+    // Each statement yields its results, a null result, then the result
+    // of the sync that follows it
+    while (!inFlight_.empty() && !PQisBusy(conn_))
+    {
+        Pending &front = inFlight_.front();
+        PGresult *res = PQgetResult(conn_);
+        if (front.awaitingSync)
+        {
+            if (res && PQresultStatus(res) != PGRES_PIPELINE_SYNC && front.error.empty())
+            {
+                front.error = PQresultErrorMessage(res);
+            }
+            PQclear(res);
+            finish(front);
+            inFlight_.pop_front();
+            continue;
+        }
+        if (!res)
+        {
+            front.awaitingSync = true;
+            continue;
+        }
+
+        ExecStatusType status = PQresultStatus(res);
+        if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK)
+        {
+            if (!front.result)
+            {
+                front.result.reset(res);
+                continue;
+            }
+        }
+        else if (front.error.empty())
+        {
+            front.error = status == PGRES_PIPELINE_ABORTED ? "aborted by an earlier error" : PQresultErrorMessage(res);
+        }
+        PQclear(res);
+    }
+}
+
+void AsyncDatabase::finish(Pending &pending)
+{
+    try
+    {
+        pending.request.complete(pending.error.empty() ? pending.result.get() : nullptr, pending.error);
+    }
+    catch (...)
+    {
+        // Completions set promises and do not throw; a broken one must not
+        // stop the loop
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --outstanding_;
+    }
+    space_.notify_all();
+}
+
+void AsyncDatabase::reconnect()
+{
+    // Nothing is in flight on a lost connection, so it can simply be
+    // replaced; this blocks the loop for as long as connecting takes
+    PGconn *conn;
+    try
+    {
+        conn = connect(conninfo_);
+    }
+    catch (const std::exception &e)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        brokenError_ = e.what();
+        return;
+    }
+    PQfinish(conn_);
+    conn_ = conn;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    broken_ = false;
+    brokenError_.clear();
+}
+
+void AsyncDatabase::failAll(const std::string &error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        broken_ = true;
+        brokenError_ = error;
+    }
+    space_.notify_all();
+
+    while (!inFlight_.empty())
+    {
+        inFlight_.front().error = "Database connection lost: " + error;
+        finish(inFlight_.front());
+        inFlight_.pop_front();
+    }
+}
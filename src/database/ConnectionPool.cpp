@@ -0,0 +1,116 @@
+#include "database/ConnectionPool.h"
+#include <stdexcept>
+
+ConnectionPool::Lease &ConnectionPool::Lease::operator=(Lease &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        pool_ = std::move(other.pool_);
+        connection_ = std::move(other.connection_);
+    }
+    return *this;
+}
+
+void ConnectionPool::Lease::release()
+{
+    if (connection_)
+    {
+        pool_->giveBack(std::move(connection_));
+        pool_.reset();
+    }
+}
+
+std::shared_ptr<ConnectionPool> ConnectionPool::create(const std::string &host,
+                                                       const std::string &port,
+                                                       const std::string &dbname,
+                                                       const std::string &user,
+                                                       const std::string &password,
+                                                       std::size_t size)
+{
+    if (size == 0)
+    {
+        throw std::invalid_argument("Connection pool size must be positive");
+    }
+
+    std::shared_ptr<ConnectionPool> pool(new ConnectionPool(size));
+    pool->idle_.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto connection = std::make_unique<Database>(host, port, dbname, user, password);
+        connection->connect();
+        pool->idle_.push_back(std::move(connection));
+    }
+    return pool;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [this]
+                    { return !idle_.empty(); });
+    return lease(lock);
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!available_.wait_for(lock, timeout, [this]
+                             { return !idle_.empty(); }))
+    {
+        throw std::runtime_error("Timed out waiting for a database connection");
+    }
+    return lease(lock);
+}
+
+std::size_t ConnectionPool::getAvailable() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+ConnectionPool::Lease ConnectionPool::lease(std::unique_lock<std::mutex> &lock)
+{
+    std::unique_ptr<Database> connection = std::move(idle_.back());
+    idle_.pop_back();
+    lock.unlock();
+
+    // Reconnecting happens outside the lock; on failure the connection goes
+    // back so the pool keeps its size and a later lease can retry
+    if (!connection->isConnected())
+    {
+        try
+        {
+            connection->disconnect();
+            connection->connect();
+        }
+        catch (...)
+        {
+            giveBack(std::move(connection));
+            throw;
+        }
+    }
+    return Lease(shared_from_this(), std::move(connection));
+}
+
+void ConnectionPool::giveBack(std::unique_ptr<Database> connection)
+{
+    if (connection->isInTransaction())
+    {
+        try
+        {
+            connection->rollbackTransaction();
+        }
+        catch (const std::exception &)
+        {
+            // Drop the session; the next lease reconnects
+            connection->disconnect();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(std::move(connection));
+    }
+    available_.notify_one();
+}
@@ -1,15 +1,175 @@
 #include "database/Database.h"
 #include "core/Account.h"
-#include <sstream>
+#include "database/AccountStatements.h"
+#include "database/PostgresCodec.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
+#include <string_view>
+
+using market::core::Account;
+using market::accounting::EntryType;
+using market::accounting::JournalEntry;
+using market::accounting::Ledger;
+using market::accounting::LedgerEntry;
+
+namespace
+{
+    std::int64_t readInt64(const PGresult *res, int row, int column)
+    {
+        std::uint32_t parts[2];
+        std::memcpy(parts, PQgetvalue(res, row, column), sizeof(parts));
+        return static_cast<std::int64_t>(static_cast<std::uint64_t>(ntohl(parts[0])) << 32 | ntohl(parts[1]));
+    }
+
+    int length(std::string_view str)
+    {
+        if (str.size() > static_cast<std::size_t>(INT32_MAX))
+        {
+            throw std::invalid_argument("Parameter too long");
+        }
+        return static_cast<int>(str.size());
+    }
+
+    // Binary COPY FROM STDIN: a fixed header, then rows of length-prefixed
+    // fields in network byte order, then a -1 field count
+    class CopyWriter
+    {
+    public:
+        static constexpr std::size_t BUFFER_SIZE = 1 << 16;
+
+        explicit CopyWriter(PGconn *conn) : conn_(conn)
+        {
+            static const char HEADER[] = "PGCOPY\n\377\r\n";
+            buffer_.reserve(BUFFER_SIZE + 256);
+            buffer_.append(HEADER, sizeof(HEADER)); // signature includes its trailing NUL
+            putInt32(0);                            // flags
+            putInt32(0);                            // header extension length
+        }
+
+        void beginRow(std::int16_t fields)
+        {
+            if (buffer_.size() >= BUFFER_SIZE)
+            {
+                flush();
+            }
+            putInt16(fields);
+        }
+
+        void text(std::string_view value)
+        {
+            putInt32(length(value));
+            buffer_.append(value.data(), value.size());
+        }
+
+        void int16(std::int16_t value)
+        {
+            putInt32(2);
+            putInt16(value);
+        }
+
+        void int64(std::int64_t value)
+        {
+            putInt32(8);
+            std::uint32_t high = htonl(static_cast<std::uint32_t>(static_cast<std::uint64_t>(value) >> 32));
+            std::uint32_t low = htonl(static_cast<std::uint32_t>(value));
+            buffer_.append(reinterpret_cast<const char *>(&high), 4);
+            buffer_.append(reinterpret_cast<const char *>(&low), 4);
+        }
+
+        void numeric(const Decimal &value)
+        {
+            PostgresNumeric encoded = toNumeric(value);
+            putInt32(encoded.byteSize());
+            buffer_.append(reinterpret_cast<const char *>(encoded.header), sizeof(encoded.header));
+            buffer_.append(reinterpret_cast<const char *>(encoded.digits), encoded.size * 2);
+        }
+
+        void timestamp(const std::chrono::system_clock::time_point &value) { int64(toPostgresTime(value)); }
+
+        // Sends the trailer, ends the copy and waits for its result
+        void finish()
+        {
+            putInt16(-1);
+            flush();
+            if (PQputCopyEnd(conn_, nullptr) != 1)
+            {
+                throw std::runtime_error("Failed to end COPY: " + std::string(PQerrorMessage(conn_)));
+            }
+            checkResult();
+        }
+
+        // Aborts the copy after a failure so the connection stays usable
+        void abort()
+        {
+            if (PQputCopyEnd(conn_, "aborted by client") == 1)
+            {
+                try
+                {
+                    checkResult();
+                }
+                catch (const std::exception &)
+                {
+                    // Expected: the server reports the abort as an error
+                }
+            }
+        }
+
+    private:
+        void putInt16(std::int16_t value)
+        {
+            std::uint16_t network = htons(static_cast<std::uint16_t>(value));
+            buffer_.append(reinterpret_cast<const char *>(&network), 2);
+        }
+
+        void putInt32(std::int32_t value)
+        {
+            std::uint32_t network = htonl(static_cast<std::uint32_t>(value));
+            buffer_.append(reinterpret_cast<const char *>(&network), 4);
+        }
+
+        void flush()
+        {
+            if (!buffer_.empty() && PQputCopyData(conn_, buffer_.data(), static_cast<int>(buffer_.size())) != 1)
+            {
+                throw std::runtime_error("Failed to send COPY data: " + std::string(PQerrorMessage(conn_)));
+            }
+            buffer_.clear();
+        }
+
+        void checkResult()
+        {
+            bool ok = true;
+            std::string error;
+            while (PGresult *res = PQgetResult(conn_))
+            {
+                if (PQresultStatus(res) != PGRES_COMMAND_OK)
+                {
+                    ok = false;
+                    error = PQresultErrorMessage(res);
+                }
+                PQclear(res);
+            }
+            if (!ok)
+            {
+                throw std::runtime_error("COPY failed: " + error);
+            }
+        }
+
+        PGconn *conn_;
+        std::string buffer_;
+    };
+}
 
 Database::Database(const std::string &host,
                    const std::string &port,
                    const std::string &dbname,
                    const std::string &user,
                    const std::string &password)
-    : host_(host), port_(port), dbname_(dbname), user_(user), password_(password),
-      conn_(nullptr)
+    : conn_(nullptr), host_(host), port_(port), dbname_(dbname), user_(user), password_(password)
 {
 }
 
@@ -40,6 +200,16 @@ void Database::connect()
         conn_ = nullptr;
         throw std::runtime_error("Failed to connect to database: " + error);
     }
+
+    try
+    {
+        prepareStatements();
+    }
+    catch (...)
+    {
+        disconnect();
+        throw;
+    }
 }
 
 void Database::disconnect()
@@ -58,104 +228,229 @@ bool Database::isConnected() const
 
 void Database::beginTransaction()
 {
-    if (!isConnected())
-    {
-        throw std::runtime_error("Not connected to database");
-    }
+    requireConnection();
     executeQuery("BEGIN");
 }
 
 void Database::commitTransaction()
 {
-    if (!isConnected())
-    {
-        throw std::runtime_error("Not connected to database");
-    }
+    requireConnection();
     executeQuery("COMMIT");
 }
 
 void Database::rollbackTransaction()
 {
-    if (!isConnected())
-    {
-        throw std::runtime_error("Not connected to database");
-    }
+    requireConnection();
     executeQuery("ROLLBACK");
 }
 
-void Database::saveAccount(const std::shared_ptr<Account> &account)
+bool Database::isInTransaction() const
 {
-    if (!isConnected())
+    if (!conn_)
     {
-        throw std::runtime_error("Not connected to database");
+        return false;
     }
+    PGTransactionStatusType status = PQtransactionStatus(conn_);
+    return status == PQTRANS_INTRANS || status == PQTRANS_INERROR;
+}
+
+void Database::saveAccount(const std::shared_ptr<Account> &account)
+{
+    requireConnection();
     if (!account)
     {
         throw std::invalid_argument("Account cannot be null");
     }
 
-    std::stringstream ss;
-    ss << "INSERT INTO accounts (id, name) VALUES ('"
-       << escapeString(account->getId()) << "', '"
-       << escapeString(account->getName()) << "')"
-       << " ON CONFLICT (id) DO UPDATE SET name = '"
-       << escapeString(account->getName()) << "'";
-
-    executeQuery(ss.str());
+    executePrepared(AccountStatements::SAVE, AccountStatements::Params(*account), PGRES_COMMAND_OK);
 }
 
 std::shared_ptr<Account> Database::loadAccount(const std::string &accountId)
 {
-    if (!isConnected())
+    requireConnection();
+    if (accountId.empty())
     {
-        throw std::runtime_error("Not connected to database");
+        throw std::invalid_argument("Account ID cannot be empty");
     }
+
+    Result res = executePrepared(AccountStatements::LOAD, AccountStatements::Params(accountId), PGRES_TUPLES_OK);
+    if (PQntuples(res.get()) == 0)
+    {
+        return nullptr;
+    }
+    return AccountStatements::readAccount(res.get(), 0, accountId);
+}
+
+void Database::deleteAccount(const std::string &accountId)
+{
+    requireConnection();
     if (accountId.empty())
     {
         throw std::invalid_argument("Account ID cannot be empty");
     }
 
-    std::stringstream ss;
-    ss << "SELECT id, name FROM accounts WHERE id = '"
-       << escapeString(accountId) << "'";
+    executePrepared(AccountStatements::REMOVE, AccountStatements::Params(accountId), PGRES_COMMAND_OK);
+}
 
-    PGresult *res = PQexec(conn_, ss.str().c_str());
-    if (PQresultStatus(res) != PGRES_TUPLES_OK)
+void Database::saveAccounts(const std::vector<std::shared_ptr<Account>> &accounts)
+{
+    requireConnection();
+    for (const auto &account : accounts)
     {
-        std::string error = PQerrorMessage(conn_);
-        PQclear(res);
-        throw std::runtime_error("Failed to load account: " + error);
+        if (!account)
+        {
+            throw std::invalid_argument("Account cannot be null");
+        }
     }
 
-    if (PQntuples(res) == 0)
+    inTransaction([&]
+                  {
+        executeQuery("TRUNCATE accounts_copy");
+        startCopy("COPY accounts_copy (id, name, type) FROM STDIN (FORMAT binary)");
+        CopyWriter copy(conn_);
+        try
+        {
+            for (const auto &account : accounts)
+            {
+                copy.beginRow(3);
+                copy.text(account->getId());
+                copy.text(account->getName());
+                copy.int16(static_cast<std::int16_t>(account->getType()));
+            }
+            copy.finish();
+        }
+        catch (...)
+        {
+            copy.abort();
+            throw;
+        }
+        executeQuery("INSERT INTO accounts (id, name, type) SELECT id, name, type FROM accounts_copy"
+                     " ON CONFLICT (id) DO UPDATE SET name = EXCLUDED.name, type = EXCLUDED.type"); });
+}
+
+void Database::saveLedgerEntries(const Ledger &ledger)
+{
+    requireConnection();
+
+    // Copied out of a snapshot first, so postings wait only for the copy
+    // and not for the round trips to the server
+    std::vector<LedgerEntry> entries;
     {
-        PQclear(res);
-        return nullptr;
+        Ledger::Snapshot snapshot = ledger.snapshot();
+        std::vector<Symbol> accountIds = snapshot.getAccountIds();
+        std::size_t count = 0;
+        for (Symbol accountId : accountIds)
+        {
+            count += snapshot.getEntryRange(accountId).size();
+        }
+        entries.reserve(count);
+        for (Symbol accountId : accountIds)
+        {
+            for (const LedgerEntry &entry : snapshot.getEntryRange(accountId))
+            {
+                entries.push_back(entry);
+            }
+        }
     }
 
-    std::string id = PQgetvalue(res, 0, 0);
-    std::string name = PQgetvalue(res, 0, 1);
-    PQclear(res);
+    inTransaction([&]
+                  {
+        executeQuery("TRUNCATE ledger_entries_copy");
+        startCopy("COPY ledger_entries_copy (id, account_id, journal_entry_id, type, amount, posted_at)"
+                  " FROM STDIN (FORMAT binary)");
+        CopyWriter copy(conn_);
+        try
+        {
+            for (const LedgerEntry &entry : entries)
+            {
+                copy.beginRow(6);
+                copy.int64(static_cast<std::int64_t>(entry.getNumericId()));
+                copy.text(entry.getAccountId().str());
+                copy.text(JournalEntry::formatId(entry.getJournalEntryId()));
+                copy.int16(static_cast<std::int16_t>(entry.getType()));
+                copy.numeric(entry.getAmount());
+                copy.timestamp(entry.getTimestamp());
+            }
+            copy.finish();
+        }
+        catch (...)
+        {
+            copy.abort();
+            throw;
+        }
+        // Entries never change once posted, so ones already stored are kept
+        executeQuery("INSERT INTO ledger_entries (id, account_id, journal_entry_id, type, amount, posted_at)"
+                     " SELECT id, account_id, journal_entry_id, type, amount, posted_at FROM ledger_entries_copy"
+                     " ON CONFLICT (id) DO NOTHING"); });
+}
 
-    return std::make_shared<Account>(id, name);
+void Database::loadAccounts(const AccountVisitor &visit)
+{
+    requireConnection();
+    streamQuery("SELECT id, name, type FROM accounts", [&](const PGresult *res)
+                {
+        visit(AccountStatements::readAccount(res, 0, AccountStatements::readText(res, 0, 0), 1, 2)); });
 }
 
-void Database::deleteAccount(const std::string &accountId)
+void Database::loadLedgerEntries(Ledger &ledger)
 {
-    if (!isConnected())
+    requireConnection();
+
+    // In timestamp order, so every posting takes the ledger's append path
+    streamQuery("SELECT id, account_id, journal_entry_id, type, amount, posted_at"
+                " FROM ledger_entries ORDER BY posted_at, id",
+                [&](const PGresult *res)
+                {
+        if (PQgetlength(res, 0, 0) != 8 || PQgetlength(res, 0, 5) != 8)
+        {
+            throw std::runtime_error("Unexpected ledger entry row from database");
+        }
+        std::int16_t type = AccountStatements::readInt16(res, 0, 3);
+        if (type != static_cast<std::int16_t>(EntryType::DEBIT) && type != static_cast<std::int16_t>(EntryType::CREDIT))
+        {
+            throw std::runtime_error("Unknown ledger entry type from database");
+        }
+        std::string_view accountId(PQgetvalue(res, 0, 1), PQgetlength(res, 0, 1));
+        std::uint64_t journalEntryId = 0;
+        if (!JournalEntry::parseId(std::string_view(PQgetvalue(res, 0, 2), PQgetlength(res, 0, 2)), journalEntryId))
+        {
+            throw std::runtime_error("Malformed journal entry ID from database");
+        }
+        ledger.addEntry(*LedgerEntry::restore(
+            static_cast<std::uint64_t>(readInt64(res, 0, 0)),
+            Symbol::intern(accountId),
+            journalEntryId,
+            static_cast<EntryType>(type),
+            fromNumeric(PQgetvalue(res, 0, 4), PQgetlength(res, 0, 4)),
+            fromPostgresTime(readInt64(res, 0, 5)))); });
+}
+
+void Database::loadAll(Ledger &ledger, const AccountVisitor &visit)
+{
+    if (visit)
     {
-        throw std::runtime_error("Not connected to database");
+        loadAccounts(visit);
     }
-    if (accountId.empty())
+    loadLedgerEntries(ledger);
+}
+
+void Database::requireConnection() const
+{
+    if (!isConnected())
     {
-        throw std::invalid_argument("Account ID cannot be empty");
+        throw std::runtime_error("Not connected to database");
     }
+}
 
-    std::stringstream ss;
-    ss << "DELETE FROM accounts WHERE id = '"
-       << escapeString(accountId) << "'";
+void Database::prepareStatements()
+{
+    // Staging tables for saveAccounts and saveLedgerEntries; they live as
+    // long as the session
+    executeQuery("CREATE TEMP TABLE accounts_copy (id VARCHAR(12), name VARCHAR(255), type SMALLINT)");
+    executeQuery("CREATE TEMP TABLE ledger_entries_copy (id BIGINT, account_id VARCHAR(32), journal_entry_id VARCHAR(16),"
+                 " type SMALLINT, amount DECIMAL(20,8), posted_at TIMESTAMPTZ)");
 
-    executeQuery(ss.str());
+    AccountStatements::prepare(conn_);
 }
 
 void Database::executeQuery(const std::string &query)
@@ -170,14 +465,96 @@ void Database::executeQuery(const std::string &query)
     PQclear(res);
 }
 
-std::string Database::escapeString(const std::string &str)
+void Database::inTransaction(const std::function<void()> &fn)
 {
-    char *escaped = PQescapeLiteral(conn_, str.c_str(), str.length());
-    if (!escaped)
+    if (isInTransaction())
+    {
+        fn();
+        return;
+    }
+
+    beginTransaction();
+    try
+    {
+        fn();
+        commitTransaction();
+    }
+    catch (...)
     {
-        throw std::runtime_error("Failed to escape string: " + std::string(PQerrorMessage(conn_)));
+        if (isConnected())
+        {
+            PQclear(PQexec(conn_, "ROLLBACK"));
+        }
+        throw;
     }
-    std::string result(escaped);
-    PQfreemem(escaped);
-    return result;
-}
\ No newline at end of file
+}
+
+void Database::startCopy(const char *query)
+{
+    Result res(PQexec(conn_, query), PQclear);
+    if (PQresultStatus(res.get()) != PGRES_COPY_IN)
+    {
+        throw std::runtime_error("Failed to start COPY: " + std::string(PQerrorMessage(conn_)));
+    }
+}
+
+void Database::streamQuery(const char *query, const std::function<void(const PGresult *)> &row)
+{
+    if (!PQsendQueryParams(conn_, query, 0, nullptr, nullptr, nullptr, nullptr, 1) || !PQsetSingleRowMode(conn_))
+    {
+        throw std::runtime_error("Failed to send query: " + std::string(PQerrorMessage(conn_)));
+    }
+
+    // Every result must be read, even after a failure, before the
+    // connection can run another command
+    std::string error;
+    bool cancelled = false;
+    while (PGresult *res = PQgetResult(conn_))
+    {
+        Result owned(res, PQclear);
+        ExecStatusType status = PQresultStatus(res);
+        if (status == PGRES_SINGLE_TUPLE && error.empty())
+        {
+            try
+            {
+                row(res);
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+            }
+        }
+        else if (status != PGRES_SINGLE_TUPLE && status != PGRES_TUPLES_OK && error.empty())
+        {
+            error = PQresultErrorMessage(res);
+        }
+
+        // Stop the server from sending rows nobody will read
+        if (!error.empty() && !cancelled)
+        {
+            cancelled = true;
+            if (PGcancel *cancel = PQgetCancel(conn_))
+            {
+                char buffer[256];
+                PQcancel(cancel, buffer, sizeof(buffer));
+                PQfreeCancel(cancel);
+            }
+        }
+    }
+    if (!error.empty())
+    {
+        throw std::runtime_error("Streaming query failed: " + error);
+    }
+}
+
+Database::Result Database::executePrepared(const char *statement,
+                                           const AccountStatements::Params &params,
+                                           ExecStatusType expected)
+{
+    Result res(PQexecPrepared(conn_, statement, params.count(), params.values(), params.lengths(), params.formats(), 1), PQclear);
+    if (PQresultStatus(res.get()) != expected)
+    {
+        throw std::runtime_error("Statement " + std::string(statement) + " failed: " + PQerrorMessage(conn_));
+    }
+    return res;
+}
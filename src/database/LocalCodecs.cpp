@@ -0,0 +1,326 @@
+#include "database/LocalCodecs.h"
+#include "utils/BinaryCodec.h"
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using market::contracts::Contract;
+using market::core::Account;
+using market::financial::Asset;
+using market::financial::Liability;
+using market::financial::Transaction;
+using market::financial::Wallet;
+
+namespace
+{
+    // Values past last are rejected, so a newer enumerator is not read as
+    // a wrong one
+    template <typename Enum>
+    Enum toEnum(std::uint64_t value, Enum last, const std::string &what, const std::string &id)
+    {
+        if (value > static_cast<std::uint64_t>(last))
+        {
+            throw std::runtime_error("Unknown " + what + " for " + id);
+        }
+        return static_cast<Enum>(value);
+    }
+
+    // Calls add with the object each repeated ID field number names
+    template <typename Codec, typename Add>
+    void linkEach(std::string_view data, std::uint32_t field, LocalLoader &loader, const std::string &owner, Add add)
+    {
+        BinaryReader reader(data);
+        while (reader.next())
+        {
+            if (reader.field() == field)
+            {
+                add(loader.require<Codec>(reader.getBytes(), owner));
+            }
+        }
+    }
+
+    // Wallets, assets and liabilities share one shape: a string and a raw
+    // amount
+    struct TypeAndValue
+    {
+        std::string type;
+        std::int64_t value = 0;
+    };
+
+    std::string encodeTypeAndValue(const std::string &type, const Decimal &value)
+    {
+        std::string out;
+        BinaryWriter writer(out);
+        writer.writeBytes(1, type);
+        writer.writeInt(2, value.toRaw());
+        return out;
+    }
+
+    TypeAndValue decodeTypeAndValue(std::string_view data)
+    {
+        TypeAndValue fields;
+        BinaryReader reader(data);
+        while (reader.next())
+        {
+            switch (reader.field())
+            {
+            case 1:
+                fields.type = reader.getBytes();
+                break;
+            case 2:
+                fields.value = reader.getInt();
+                break;
+            default:
+                break;
+            }
+        }
+        return fields;
+    }
+}
+
+std::string AccountCodec::encode(const Account &account) const
+{
+    std::string out;
+    BinaryWriter writer(out);
+    writer.writeBytes(1, account.getName());
+    writer.writeUint(2, static_cast<std::uint64_t>(account.getType()));
+    for (const auto &wallet : account.getWallets())
+    {
+        writer.writeBytes(3, wallet->getId());
+    }
+    for (const auto &asset : account.getAssets())
+    {
+        writer.writeBytes(4, asset->getId());
+    }
+    for (const auto &liability : account.getLiabilities())
+    {
+        writer.writeBytes(5, liability->getId());
+    }
+    for (const auto &contract : account.getContracts())
+    {
+        writer.writeBytes(6, contract->getId());
+    }
+    return out;
+}
+
+std::shared_ptr<Account> AccountCodec::decode(const std::string &id, std::string_view data, LocalLoader &) const
+{
+    std::string name;
+    Account::AccountType type = Account::AccountType::ASSET;
+    BinaryReader reader(data);
+    while (reader.next())
+    {
+        switch (reader.field())
+        {
+        case 1:
+            name = reader.getBytes();
+            break;
+        case 2:
+            type = toEnum(reader.getUint(), Account::AccountType::EXPENSE, "account type", id);
+            break;
+        default:
+            break;
+        }
+    }
+    return Account::restore(id, name, type);
+}
+
+void AccountCodec::link(Account &account, std::string_view data, LocalLoader &loader) const
+{
+    const std::string &id = account.getId();
+    linkEach<WalletCodec>(data, 3, loader, id, [&](std::shared_ptr<Wallet> wallet)
+                          { account.addWallet(std::move(wallet)); });
+    linkEach<AssetCodec>(data, 4, loader, id, [&](std::shared_ptr<Asset> asset)
+                         { account.addAsset(std::move(asset)); });
+    linkEach<LiabilityCodec>(data, 5, loader, id, [&](std::shared_ptr<Liability> liability)
+                             { account.addLiability(std::move(liability)); });
+    linkEach<ContractCodec>(data, 6, loader, id, [&](std::shared_ptr<Contract> contract)
+                            { account.addContract(std::move(contract)); });
+}
+
+std::string WalletCodec::encode(const Wallet &wallet) const
+{
+    std::string out = encodeTypeAndValue(wallet.getCurrency(), wallet.getNetWorth());
+    BinaryWriter writer(out);
+    for (const auto &transaction : wallet.getTransactions())
+    {
+        writer.writeBytes(3, transaction->getId());
+    }
+    return out;
+}
+
+std::shared_ptr<Wallet> WalletCodec::decode(const std::string &id, std::string_view data, LocalLoader &) const
+{
+    TypeAndValue fields = decodeTypeAndValue(data);
+    return Wallet::restore(id, fields.type, Decimal::fromRaw(fields.value));
+}
+
+void WalletCodec::link(Wallet &wallet, std::string_view data, LocalLoader &loader) const
+{
+    linkEach<TransactionCodec>(data, 3, loader, wallet.getId(), [&](std::shared_ptr<Transaction> transaction)
+                               { wallet.addTransaction(std::move(transaction)); });
+}
+
+std::string AssetCodec::encode(const Asset &asset) const
+{
+    return encodeTypeAndValue(asset.getType(), asset.getValue());
+}
+
+std::shared_ptr<Asset> AssetCodec::decode(const std::string &id, std::string_view data, LocalLoader &) const
+{
+    TypeAndValue fields = decodeTypeAndValue(data);
+    return Asset::restore(id, fields.type, Decimal::fromRaw(fields.value));
+}
+
+std::string LiabilityCodec::encode(const Liability &liability) const
+{
+    return encodeTypeAndValue(liability.getType(), liability.getValue());
+}
+
+std::shared_ptr<Liability> LiabilityCodec::decode(const std::string &id, std::string_view data, LocalLoader &) const
+{
+    TypeAndValue fields = decodeTypeAndValue(data);
+    return Liability::restore(id, fields.type, Decimal::fromRaw(fields.value));
+}
+
+std::string TransactionCodec::encode(const Transaction &transaction) const
+{
+    std::string out;
+    BinaryWriter writer(out);
+    writer.writeUint(1, static_cast<std::uint64_t>(transaction.getType()));
+    writer.writeInt(2, transaction.getAmount().toRaw());
+    writer.writeBytes(3, transaction.getAccount()->getId());
+    if (transaction.getAsset())
+    {
+        writer.writeBytes(4, transaction.getAsset()->getId());
+    }
+    if (transaction.getLiability())
+    {
+        writer.writeBytes(5, transaction.getLiability()->getId());
+    }
+    writer.writeInt(6, std::chrono::duration_cast<std::chrono::nanoseconds>(transaction.getTimestamp().time_since_epoch()).count());
+    writer.writeUint(7, static_cast<std::uint64_t>(transaction.getStatus()));
+    return out;
+}
+
+std::shared_ptr<Transaction> TransactionCodec::decode(const std::string &id, std::string_view data, LocalLoader &loader) const
+{
+    Transaction::Type type = Transaction::Type::DEPOSIT;
+    std::int64_t amount = 0;
+    std::shared_ptr<Account> account;
+    std::shared_ptr<Asset> asset;
+    std::shared_ptr<Liability> liability;
+    std::int64_t timestamp = 0;
+    Transaction::Status status = Transaction::Status::PENDING;
+
+    BinaryReader reader(data);
+    while (reader.next())
+    {
+        switch (reader.field())
+        {
+        case 1:
+            type = toEnum(reader.getUint(), Transaction::Type::TRADE, "transaction type", id);
+            break;
+        case 2:
+            amount = reader.getInt();
+            break;
+        case 3:
+            account = loader.require<AccountCodec>(reader.getBytes(), id);
+            break;
+        case 4:
+            asset = loader.require<AssetCodec>(reader.getBytes(), id);
+            break;
+        case 5:
+            liability = loader.require<LiabilityCodec>(reader.getBytes(), id);
+            break;
+        case 6:
+            timestamp = reader.getInt();
+            break;
+        case 7:
+            status = toEnum(reader.getUint(), Transaction::Status::FAILED, "transaction status", id);
+            break;
+        default:
+            break;
+        }
+    }
+
+    std::chrono::system_clock::time_point time(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp)));
+    return Transaction::restore(id, type, Decimal::fromRaw(amount), account, asset, liability, time, status);
+}
+
+std::string ContractCodec::encode(const Contract &contract) const
+{
+    std::string out;
+    BinaryWriter writer(out);
+    writer.writeBytes(1, contract.getType());
+    writer.writeUint(2, static_cast<std::uint64_t>(contract.getState()));
+    writer.writeBytes(3, contract.getParty1()->getId());
+    writer.writeBytes(4, contract.getParty2()->getId());
+    for (const auto &[key, value] : contract.getTerms())
+    {
+        writer.writeMessage(5, [&](BinaryWriter &term)
+                            {
+                                term.writeBytes(1, key);
+                                term.writeBytes(2, value); });
+    }
+    return out;
+}
+
+std::shared_ptr<Contract> ContractCodec::decode(const std::string &id, std::string_view data, LocalLoader &loader) const
+{
+    std::string type;
+    Contract::State state = Contract::State::DRAFT;
+    std::shared_ptr<Account> party1;
+    std::shared_ptr<Account> party2;
+    std::vector<std::pair<std::string, std::string>> terms;
+
+    BinaryReader reader(data);
+    while (reader.next())
+    {
+        switch (reader.field())
+        {
+        case 1:
+            type = reader.getBytes();
+            break;
+        case 2:
+            state = toEnum(reader.getUint(), Contract::State::DEFAULTED, "contract state", id);
+            break;
+        case 3:
+            party1 = loader.require<AccountCodec>(reader.getBytes(), id);
+            break;
+        case 4:
+            party2 = loader.require<AccountCodec>(reader.getBytes(), id);
+            break;
+        case 5:
+        {
+            auto &term = terms.emplace_back();
+            BinaryReader fields = reader.getMessage();
+            while (fields.next())
+            {
+                if (fields.field() == 1)
+                {
+                    term.first = fields.getBytes();
+                }
+                else if (fields.field() == 2)
+                {
+                    term.second = fields.getBytes();
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    auto contract = Contract::restore(id, type, party1, party2);
+    contract->setState(state);
+    for (const auto &[key, value] : terms)
+    {
+        contract->addTerm(key, value);
+    }
+    return contract;
+}
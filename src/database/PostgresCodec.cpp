@@ -0,0 +1,133 @@
+#include "database/PostgresCodec.h"
+#include <arpa/inet.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    constexpr std::int64_t POSTGRES_EPOCH_SECONDS = 946684800;
+}
+
+std::int64_t toPostgresTime(const std::chrono::system_clock::time_point &timestamp)
+{
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(timestamp.time_since_epoch()).count();
+    return micros - POSTGRES_EPOCH_SECONDS * 1000000;
+}
+
+std::chrono::system_clock::time_point fromPostgresTime(std::int64_t micros)
+{
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::microseconds(micros + POSTGRES_EPOCH_SECONDS * 1000000)));
+}
+
+PostgresNumeric toNumeric(const Decimal &value)
+{
+    std::int64_t raw = value.toRaw();
+    std::uint64_t magnitude = raw < 0 ? 0 - static_cast<std::uint64_t>(raw) : static_cast<std::uint64_t>(raw);
+    std::uint64_t integer = magnitude / static_cast<std::uint64_t>(Decimal::ONE);
+    std::uint64_t fraction = magnitude % static_cast<std::uint64_t>(Decimal::ONE);
+
+    std::uint16_t digits[PostgresNumeric::MAX_DIGITS];
+    int count = 0;
+    int integerDigits = 0;
+    for (std::uint64_t rest = integer; rest != 0; rest /= PostgresNumeric::BASE)
+    {
+        ++integerDigits;
+    }
+    std::uint64_t rest = integer;
+    for (int i = integerDigits - 1; i >= 0; --i)
+    {
+        digits[i] = static_cast<std::uint16_t>(rest % PostgresNumeric::BASE);
+        rest /= PostgresNumeric::BASE;
+    }
+    count = integerDigits;
+    for (int remaining = Decimal::SCALE; remaining > 0; remaining -= 4)
+    {
+        std::uint64_t digit = remaining >= 4
+                                  ? fraction / static_cast<std::uint64_t>(decimal_detail::pow10(remaining - 4)) % PostgresNumeric::BASE
+                                  : fraction % static_cast<std::uint64_t>(decimal_detail::pow10(remaining)) * static_cast<std::uint64_t>(decimal_detail::pow10(4 - remaining));
+        digits[count++] = static_cast<std::uint16_t>(digit);
+    }
+
+    // Drop zero digits at both ends; leading ones shift the weight
+    int first = 0;
+    int weight = integerDigits - 1;
+    while (first < count && digits[first] == 0)
+    {
+        ++first;
+        --weight;
+    }
+    while (count > first && digits[count - 1] == 0)
+    {
+        --count;
+    }
+
+    PostgresNumeric numeric;
+    numeric.size = count - first;
+    if (numeric.size == 0)
+    {
+        weight = 0;
+    }
+    numeric.header[0] = htons(static_cast<std::uint16_t>(numeric.size));
+    numeric.header[1] = htons(static_cast<std::uint16_t>(static_cast<std::int16_t>(weight)));
+    numeric.header[2] = htons(raw < 0 ? PostgresNumeric::NEGATIVE : PostgresNumeric::POSITIVE);
+    numeric.header[3] = htons(static_cast<std::uint16_t>(Decimal::SCALE));
+    for (int i = 0; i < numeric.size; ++i)
+    {
+        numeric.digits[i] = htons(digits[first + i]);
+    }
+    return numeric;
+}
+
+Decimal fromNumeric(const char *data, int size)
+{
+    auto read = [data](int index)
+    {
+        std::uint16_t network;
+        std::memcpy(&network, data + index * 2, sizeof(network));
+        return ntohs(network);
+    };
+    if (size < 8)
+    {
+        throw std::runtime_error("Malformed numeric value from database");
+    }
+    int count = read(0);
+    int weight = static_cast<std::int16_t>(read(1));
+    std::uint16_t sign = read(2);
+    if (size != 8 + count * 2 || (sign != PostgresNumeric::POSITIVE && sign != PostgresNumeric::NEGATIVE))
+    {
+        throw std::runtime_error("Malformed or non-finite numeric value from database");
+    }
+
+    // Accumulate the magnitude in units of 10^-SCALE; digits below that
+    // resolution must be zero
+    std::int64_t raw = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        std::int64_t digit = read(4 + i);
+        int exponent = 4 * (weight - i) + Decimal::SCALE;
+        if (digit >= PostgresNumeric::BASE)
+        {
+            throw std::runtime_error("Malformed numeric value from database");
+        }
+        if (exponent < 0)
+        {
+            std::int64_t divisor = exponent <= -4 ? PostgresNumeric::BASE : decimal_detail::pow10(-exponent);
+            if (digit % divisor != 0)
+            {
+                throw std::runtime_error("Numeric value from database has more than " + std::to_string(Decimal::SCALE) + " decimal places");
+            }
+            digit /= divisor;
+            exponent = 0;
+        }
+        std::int64_t term;
+        if (exponent > 18 ||
+            __builtin_mul_overflow(digit, decimal_detail::pow10(exponent), &term) ||
+            __builtin_add_overflow(raw, term, &raw))
+        {
+            throw std::overflow_error("Numeric value from database out of Decimal range");
+        }
+    }
+    return Decimal::fromRaw(sign == PostgresNumeric::NEGATIVE ? -raw : raw);
+}
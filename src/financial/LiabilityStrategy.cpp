@@ -1,12 +1,17 @@
 #include "financial/LiabilityStrategy.h"
 #include "financial/Liability.h"
 
-Decimal LoanLiabilityStrategy::calculateValue(const Liability &liability) const
+namespace market::financial
 {
-    return liability.getValue();
-}
 
-Decimal MarginLiabilityStrategy::calculateValue(const Liability &liability) const
-{
-    return liability.getValue();
-}
\ No newline at end of file
+    Decimal LoanLiabilityStrategy::calculateValue(const Liability &liability) const
+    {
+        return liability.getValue();
+    }
+
+    Decimal MarginLiabilityStrategy::calculateValue(const Liability &liability) const
+    {
+        return liability.getValue();
+    }
+
+} // namespace market::financial
\ No newline at end of file
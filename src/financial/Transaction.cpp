@@ -18,6 +18,21 @@ namespace market::financial
         return std::shared_ptr<Transaction>(new Transaction(idGen_.next(), type, amount, account, asset, liability));
     }
 
+    std::shared_ptr<Transaction> Transaction::restore(const std::string &id, Type type, const Decimal &amount, std::shared_ptr<market::core::Account> account, std::shared_ptr<Asset> asset, std::shared_ptr<Liability> liability, std::chrono::system_clock::time_point timestamp, Status status)
+    {
+        if (id.empty())
+            throw std::invalid_argument("Transaction ID cannot be empty");
+        if (amount <= Decimal(0))
+            throw std::invalid_argument("Transaction amount must be positive");
+        if (!account)
+            throw std::invalid_argument("Account cannot be null");
+        idGen_.observe(id);
+        std::shared_ptr<Transaction> transaction(new Transaction(id, type, amount, account, asset, liability));
+        transaction->timestamp_ = timestamp;
+        transaction->status_ = status;
+        return transaction;
+    }
+
     Transaction::Transaction(const std::string &id, Type type, const Decimal &amount, std::shared_ptr<market::core::Account> account, std::shared_ptr<Asset> asset, std::shared_ptr<Liability> liability)
         : id_(id), type_(type), amount_(amount), account_(account), asset_(asset), liability_(liability), timestamp_(std::chrono::system_clock::now()), status_(Status::PENDING) {}
 
@@ -12,7 +12,19 @@ namespace market::financial
         {
             throw std::invalid_argument("Currency must be a 3-letter code");
         }
-        return std::make_shared<Wallet>(idGen_.next(), currency);
+        return std::shared_ptr<Wallet>(new Wallet(idGen_.next(), currency));
+    }
+
+    std::shared_ptr<Wallet> Wallet::restore(const std::string &id, const std::string &currency, const Decimal &balance)
+    {
+        if (currency.size() != 3)
+        {
+            throw std::invalid_argument("Currency must be a 3-letter code");
+        }
+        idGen_.observe(id);
+        std::shared_ptr<Wallet> wallet(new Wallet(id, currency));
+        wallet->balance_ = balance;
+        return wallet;
     }
 
     Wallet::Wallet(const std::string &id, const std::string &currency)
@@ -1,6 +1,7 @@
 #include "accounting/TrialBalance.h"
 #include "accounting/IncomeStatement.h"
 #include "accounting/CashFlowStatement.h"
+#include "accounting/ReportEngine.h"
 #include "accounting/Ledger.h"
 #include "accounting/Journal.h"
 #include "accounting/JournalEntry.h"
@@ -30,45 +31,42 @@ int main()
     // Simulate some transactions
     // Transaction 1: Revenue of 1000
     std::vector<JournalEntry::Entry> entries1 = {
-        {"ACC001", market::accounting::EntryType::DEBIT, Decimal(1000), "Revenue received"},
-        {"ACC003", market::accounting::EntryType::CREDIT, Decimal(1000), "Revenue recorded"}};
+        {Symbol("ACC001"), market::accounting::EntryType::DEBIT, Decimal(1000), "Revenue received"},
+        {Symbol("ACC003"), market::accounting::EntryType::CREDIT, Decimal(1000), "Revenue recorded"}};
     auto entry1 = JournalEntry::create("TRX001", entries1, "Revenue transaction");
     journal->addEntry(entry1);
 
     // Transaction 2: Expense of 500
     std::vector<JournalEntry::Entry> entries2 = {
-        {"ACC004", market::accounting::EntryType::DEBIT, Decimal(500), "Expense incurred"},
-        {"ACC001", market::accounting::EntryType::CREDIT, Decimal(500), "Cash paid for expense"}};
+        {Symbol("ACC004"), market::accounting::EntryType::DEBIT, Decimal(500), "Expense incurred"},
+        {Symbol("ACC001"), market::accounting::EntryType::CREDIT, Decimal(500), "Cash paid for expense"}};
     auto entry2 = JournalEntry::create("TRX002", entries2, "Expense transaction");
     journal->addEntry(entry2);
 
     // Update ledger with journal entries
-    for (const auto &entry : journal->getEntries())
-    {
-        for (const auto &e : entry->getEntries())
-        {
-            auto ledgerEntry = LedgerEntry::create(e.accountId, entry->getId(), e.type, e.amount);
-            ledger->addEntry(ledgerEntry);
-        }
-    }
+    ledger->postBatch(journal->getEntries());
+
+    // Generate reports; the engine reads each balance once for all of them
+    std::vector<std::pair<std::string, std::string>> revenueAccounts = {{"ACC003", "Revenue"}};
+    std::vector<std::pair<std::string, std::string>> expenseAccounts = {{"ACC004", "Expenses"}};
+    std::vector<std::pair<std::string, std::string>> inflowAccounts = {{"ACC001", "Cash"}};
+    std::vector<std::pair<std::string, std::string>> outflowAccounts = {{"ACC001", "Cash"}};
+
+    auto engine = ReportEngine::create(ledger);
+    auto trialBalance = engine->addTrialBalance(accounts, false);
+    auto incomeStatement = engine->addIncomeStatement(revenueAccounts, expenseAccounts, false);
+    auto cashFlowStatement = engine->addCashFlowStatement(inflowAccounts, outflowAccounts, false);
+    engine->run();
 
-    // Generate reports
     // 1. Trial Balance
-    auto trialBalance = TrialBalance::create(ledger, accounts, false);
     std::cout << "Trial Balance Report:" << std::endl;
     trialBalance->generate(std::cout);
 
     // 2. Income Statement
-    std::vector<std::pair<std::string, std::string>> revenueAccounts = {{"ACC003", "Revenue"}};
-    std::vector<std::pair<std::string, std::string>> expenseAccounts = {{"ACC004", "Expenses"}};
-    auto incomeStatement = IncomeStatement::create(ledger, revenueAccounts, expenseAccounts, false);
     std::cout << "\nIncome Statement Report:" << std::endl;
     incomeStatement->generate(std::cout);
 
     // 3. Cash Flow Statement
-    std::vector<std::pair<std::string, std::string>> inflowAccounts = {{"ACC001", "Cash"}};
-    std::vector<std::pair<std::string, std::string>> outflowAccounts = {{"ACC001", "Cash"}};
-    auto cashFlowStatement = CashFlowStatement::create(ledger, inflowAccounts, outflowAccounts, false);
     std::cout << "\nCash Flow Statement Report:" << std::endl;
     cashFlowStatement->generate(std::cout);
 
@@ -0,0 +1,101 @@
+#include "utils/BinaryCodec.h"
+#include <stdexcept>
+
+void BinaryWriter::finishMessage(std::size_t start)
+{
+    std::uint64_t length = out_.size() - start - 1;
+    std::size_t width = 1;
+    for (std::uint64_t rest = length >> 7; rest != 0; rest >>= 7)
+    {
+        ++width;
+    }
+    if (width > 1)
+    {
+        out_.insert(start + 1, width - 1, '\0');
+    }
+    for (std::size_t i = 0; i < width; ++i)
+    {
+        std::uint8_t byte = static_cast<std::uint8_t>(length & 0x7F);
+        length >>= 7;
+        out_[start + i] = static_cast<char>(i + 1 < width ? byte | 0x80 : byte);
+    }
+}
+
+bool BinaryReader::next()
+{
+    if (position_ == data_.size())
+    {
+        return false;
+    }
+    std::uint64_t key = readVarint();
+    field_ = static_cast<std::uint32_t>(key >> 3);
+    wireType_ = static_cast<std::uint32_t>(key & 7);
+    if (field_ == 0 || key >> 35 != 0)
+    {
+        throw std::runtime_error("Malformed binary record: bad field number");
+    }
+
+    switch (wireType_)
+    {
+    case BinaryWriter::VARINT:
+        value_ = readVarint();
+        break;
+    case BinaryWriter::BYTES:
+    {
+        std::uint64_t length = readVarint();
+        if (length > data_.size() - position_)
+        {
+            throw std::runtime_error("Malformed binary record: field runs past the end");
+        }
+        bytes_ = data_.substr(position_, static_cast<std::size_t>(length));
+        position_ += static_cast<std::size_t>(length);
+        break;
+    }
+    default:
+        throw std::runtime_error("Malformed binary record: unknown wire type");
+    }
+    return true;
+}
+
+std::uint64_t BinaryReader::getUint() const
+{
+    if (wireType_ != BinaryWriter::VARINT)
+    {
+        throw std::runtime_error("Malformed binary record: field " + std::to_string(field_) + " is not a number");
+    }
+    return value_;
+}
+
+std::int64_t BinaryReader::getInt() const
+{
+    std::uint64_t value = getUint();
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+std::string_view BinaryReader::getBytes() const
+{
+    if (wireType_ != BinaryWriter::BYTES)
+    {
+        throw std::runtime_error("Malformed binary record: field " + std::to_string(field_) + " is not a string");
+    }
+    return bytes_;
+}
+
+std::uint64_t BinaryReader::readVarint()
+{
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        if (position_ == data_.size())
+        {
+            throw std::runtime_error("Malformed binary record: cut short");
+        }
+        std::uint8_t byte = static_cast<std::uint8_t>(data_[position_++]);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return value;
+        }
+    }
+    throw std::runtime_error("Malformed binary record: varint too long");
+}
@@ -0,0 +1,54 @@
+#include "utils/Crc32.h"
+#include <array>
+
+namespace
+{
+    using Tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+    // tables[k][b] is the CRC of byte b followed by k zero bytes
+    constexpr Tables makeTables()
+    {
+        Tables tables{};
+        for (std::uint32_t b = 0; b < 256; ++b)
+        {
+            std::uint32_t crc = b;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            tables[0][b] = crc;
+        }
+        for (std::size_t k = 1; k < 8; ++k)
+        {
+            for (std::uint32_t b = 0; b < 256; ++b)
+            {
+                std::uint32_t previous = tables[k - 1][b];
+                tables[k][b] = (previous >> 8) ^ tables[0][previous & 0xFF];
+            }
+        }
+        return tables;
+    }
+
+    constexpr Tables TABLES = makeTables();
+}
+
+std::uint32_t Crc32::compute(const void *data, std::size_t size, std::uint32_t crc)
+{
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    crc = ~crc;
+    for (; size >= 8; size -= 8, bytes += 8)
+    {
+        // Bytes are combined in little-endian order whatever the host
+        std::uint32_t low = crc ^ (static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8 |
+                                   static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24);
+        crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^
+              TABLES[5][(low >> 16) & 0xFF] ^ TABLES[4][low >> 24] ^
+              TABLES[3][bytes[4]] ^ TABLES[2][bytes[5]] ^
+              TABLES[1][bytes[6]] ^ TABLES[0][bytes[7]];
+    }
+    for (; size > 0; --size, ++bytes)
+    {
+        crc = (crc >> 8) ^ TABLES[0][(crc ^ *bytes) & 0xFF];
+    }
+    return ~crc;
+}
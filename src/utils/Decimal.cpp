@@ -1,75 +1,280 @@
 #include "../include/utils/Decimal.h"
-#include <sstream>
-#include <iomanip>
 #include <stdexcept>
+#include <cmath>
+#include <cctype>
+#include <limits>
+#include <algorithm>
 
-Decimal::Decimal(const std::string &str)
+namespace
 {
-    std::istringstream iss(str);
-    iss >> value_;
-    if (iss.fail())
+#if MARKET_DECIMAL_INT128
+    __extension__ typedef __int128 Wide;
+#else
+    using Wide = std::int64_t;
+#endif
+
+    // Decides whether a truncated result moves one unit away from zero.
+    // half compares the discarded part with one half of a unit (-1, 0 or 1);
+    // it is only consulted when something non-zero was discarded.
+    bool roundsAwayFromZero(Decimal::RoundingMode mode, bool negative, int half, bool odd)
     {
-        throw std::invalid_argument("Invalid decimal string");
+        switch (mode)
+        {
+        case Decimal::RoundingMode::DOWN:
+            return false;
+        case Decimal::RoundingMode::UP:
+            return true;
+        case Decimal::RoundingMode::FLOOR:
+            return negative;
+        case Decimal::RoundingMode::CEILING:
+            return !negative;
+        case Decimal::RoundingMode::HALF_UP:
+            return half >= 0;
+        case Decimal::RoundingMode::HALF_DOWN:
+            return half > 0;
+        case Decimal::RoundingMode::HALF_EVEN:
+            return half > 0 || (half == 0 && odd);
+        }
+        return false;
+    }
+
+    // Divides numerator by denominator and rounds the quotient to an integer
+    // according to mode.
+    std::int64_t roundQuotient(Wide numerator, Wide denominator, Decimal::RoundingMode mode)
+    {
+        Wide quotient = numerator / denominator;
+        Wide remainder = numerator % denominator;
+        if (remainder != 0)
+        {
+            bool negative = (numerator < 0) != (denominator < 0);
+            Wide twiceRemainder = remainder < 0 ? -remainder : remainder;
+            twiceRemainder *= 2;
+            Wide absDenominator = denominator < 0 ? -denominator : denominator;
+            int half = twiceRemainder < absDenominator ? -1 : (twiceRemainder == absDenominator ? 0 : 1);
+            if (roundsAwayFromZero(mode, negative, half, quotient % 2 != 0))
+            {
+                quotient += negative ? -1 : 1;
+            }
+        }
+
+        if (quotient > std::numeric_limits<std::int64_t>::max() ||
+            quotient < std::numeric_limits<std::int64_t>::min())
+        {
+            throw std::overflow_error("Decimal result out of range");
+        }
+        return static_cast<std::int64_t>(quotient);
+    }
+
+    Wide widen(std::int64_t lhs, std::int64_t rhs)
+    {
+#if MARKET_DECIMAL_INT128
+        return static_cast<Wide>(lhs) * rhs;
+#else
+        std::uint64_t lhsMagnitude = lhs < 0 ? 0 - static_cast<std::uint64_t>(lhs) : static_cast<std::uint64_t>(lhs);
+        std::uint64_t rhsMagnitude = rhs < 0 ? 0 - static_cast<std::uint64_t>(rhs) : static_cast<std::uint64_t>(rhs);
+        if (lhsMagnitude != 0 &&
+            rhsMagnitude > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) / lhsMagnitude)
+        {
+            throw std::overflow_error("Decimal intermediate out of range");
+        }
+        return lhs * rhs;
+#endif
     }
 }
 
-Decimal Decimal::operator+(const Decimal &other) const
+Decimal::Decimal(double value)
 {
-    return Decimal(value_ + other.value_);
+    if (std::isnan(value))
+    {
+        throw std::invalid_argument("Decimal cannot be NaN");
+    }
+    double scaled = std::round(value * static_cast<double>(ONE));
+    if (scaled >= 9.2233720368547758e18 || scaled < -9.2233720368547758e18)
+    {
+        throw std::overflow_error("Decimal value out of range");
+    }
+    value_ = static_cast<std::int64_t>(scaled);
 }
 
-Decimal Decimal::operator-(const Decimal &other) const
+Decimal::Decimal(const std::string &str)
 {
-    return Decimal(value_ - other.value_);
+    const char *first = str.data();
+    const char *last = str.data() + str.size();
+    while (first != last && std::isspace(static_cast<unsigned char>(*first)))
+    {
+        ++first;
+    }
+    while (last != first && std::isspace(static_cast<unsigned char>(*(last - 1))))
+    {
+        --last;
+    }
+
+    value_ = 0;
+    auto result = fromChars(first, last, *this);
+    if (result.ec == std::errc::result_out_of_range)
+    {
+        throw std::overflow_error("Decimal string out of range");
+    }
+    if (result.ec != std::errc() || result.ptr != last)
+    {
+        throw std::invalid_argument("Invalid decimal string");
+    }
 }
 
-Decimal Decimal::operator*(const Decimal &other) const
+Decimal Decimal::multiply(const Decimal &other, RoundingMode mode) const
 {
-    return Decimal(value_ * other.value_);
+    return fromRaw(roundQuotient(widen(value_, other.value_), ONE, mode));
 }
 
-Decimal Decimal::operator/(const Decimal &other) const
+Decimal Decimal::divide(const Decimal &other, RoundingMode mode) const
 {
     if (other.value_ == 0)
     {
         throw std::invalid_argument("Division by zero");
     }
-    return Decimal(value_ / other.value_);
+    return fromRaw(roundQuotient(widen(value_, ONE), other.value_, mode));
 }
 
-bool Decimal::operator==(const Decimal &other) const
+double Decimal::toDouble() const
 {
-    return std::abs(value_ - other.value_) < EPSILON;
+    return static_cast<double>(value_ / ONE) + static_cast<double>(value_ % ONE) / static_cast<double>(ONE);
 }
 
-bool Decimal::operator!=(const Decimal &other) const
+std::string Decimal::toString() const
 {
-    return !(*this == other);
+    char buffer[MAX_CHARS];
+    auto result = toChars(buffer, buffer + MAX_CHARS);
+    return std::string(buffer, result.ptr);
 }
 
-bool Decimal::operator<(const Decimal &other) const
+std::from_chars_result Decimal::fromChars(const char *first, const char *last, Decimal &value, RoundingMode mode)
 {
-    return value_ < other.value_ - EPSILON;
-}
+    const char *ptr = first;
+    bool negative = false;
+    if (ptr != last && (*ptr == '-' || *ptr == '+'))
+    {
+        negative = *ptr == '-';
+        ++ptr;
+    }
 
-bool Decimal::operator>(const Decimal &other) const
-{
-    return value_ > other.value_ + EPSILON;
-}
+    // Largest magnitude representable with this sign, in raw units
+    const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + (negative ? 1 : 0);
+    const std::uint64_t integerLimit = limit / static_cast<std::uint64_t>(ONE);
 
-bool Decimal::operator<=(const Decimal &other) const
-{
-    return !(*this > other);
-}
+    std::uint64_t integerPart = 0;
+    bool overflow = false;
+    const char *digitsStart = ptr;
+    for (; ptr != last && *ptr >= '0' && *ptr <= '9'; ++ptr)
+    {
+        std::uint64_t digit = static_cast<std::uint64_t>(*ptr - '0');
+        if (overflow || integerPart > (integerLimit - digit) / 10)
+        {
+            overflow = true;
+            continue;
+        }
+        integerPart = integerPart * 10 + digit;
+    }
+    bool hasDigits = ptr != digitsStart;
 
-bool Decimal::operator>=(const Decimal &other) const
-{
-    return !(*this < other);
+    std::uint64_t fraction = 0;
+    int fractionDigits = 0;
+    int firstDropped = -1;
+    bool stickyDropped = false;
+    if (ptr != last && *ptr == '.')
+    {
+        const char *fractionStart = ++ptr;
+        for (; ptr != last && *ptr >= '0' && *ptr <= '9'; ++ptr)
+        {
+            int digit = *ptr - '0';
+            if (fractionDigits < SCALE)
+            {
+                fraction = fraction * 10 + static_cast<std::uint64_t>(digit);
+                ++fractionDigits;
+            }
+            else if (firstDropped < 0)
+            {
+                firstDropped = digit;
+            }
+            else
+            {
+                stickyDropped = stickyDropped || digit != 0;
+            }
+        }
+        hasDigits = hasDigits || ptr != fractionStart;
+    }
+
+    if (!hasDigits)
+    {
+        return {first, std::errc::invalid_argument};
+    }
+    if (overflow)
+    {
+        return {ptr, std::errc::result_out_of_range};
+    }
+
+    for (; fractionDigits < SCALE; ++fractionDigits)
+    {
+        fraction *= 10;
+    }
+    std::uint64_t magnitude = integerPart * static_cast<std::uint64_t>(ONE) + fraction;
+    if (firstDropped > 0 || stickyDropped)
+    {
+        int half = firstDropped < 5 ? -1 : (firstDropped == 5 && !stickyDropped ? 0 : 1);
+        if (roundsAwayFromZero(mode, negative, half, magnitude % 2 != 0))
+        {
+            ++magnitude;
+        }
+    }
+    if (magnitude > limit)
+    {
+        return {ptr, std::errc::result_out_of_range};
+    }
+
+    value.value_ = negative ? static_cast<std::int64_t>(0 - magnitude) : static_cast<std::int64_t>(magnitude);
+    return {ptr, std::errc()};
 }
 
-std::string Decimal::toString() const
+std::to_chars_result Decimal::toChars(char *first, char *last) const
 {
-    std::ostringstream oss;
-    oss << value_;
-    return oss.str();
-}
\ No newline at end of file
+    std::uint64_t magnitude = value_ < 0 ? 0 - static_cast<std::uint64_t>(value_) : static_cast<std::uint64_t>(value_);
+    std::uint64_t integerPart = magnitude / static_cast<std::uint64_t>(ONE);
+    std::uint64_t fraction = magnitude % static_cast<std::uint64_t>(ONE);
+
+    // Digits are produced right to left into a scratch buffer
+    char scratch[MAX_CHARS];
+    char *end = scratch + MAX_CHARS;
+    char *begin = end;
+    if (fraction != 0)
+    {
+        // Print only the significant fractional digits
+        int digits = SCALE;
+        while (fraction % 10 == 0)
+        {
+            fraction /= 10;
+            --digits;
+        }
+        for (; digits > 0; --digits)
+        {
+            *--begin = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        *--begin = '.';
+    }
+    do
+    {
+        *--begin = static_cast<char>('0' + integerPart % 10);
+        integerPart /= 10;
+    } while (integerPart != 0);
+    if (value_ < 0)
+    {
+        *--begin = '-';
+    }
+
+    std::size_t length = static_cast<std::size_t>(end - begin);
+    if (static_cast<std::size_t>(last - first) < length)
+    {
+        return {last, std::errc::value_too_large};
+    }
+    std::copy(begin, end, first);
+    return {first + length, std::errc()};
+}
@@ -0,0 +1,86 @@
+#include "utils/FileIo.h"
+#include "utils/Crc32.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr std::size_t RECORD_HEADER_SIZE = 8;
+}
+
+std::runtime_error ioError(const std::string &what, const std::string &path)
+{
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+void writeAll(int fd, const char *data, std::size_t size, const std::string &path)
+{
+    while (size > 0)
+    {
+        ssize_t count = ::write(fd, data, size);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw ioError("Cannot write", path);
+        }
+        data += count;
+        size -= static_cast<std::size_t>(count);
+    }
+}
+
+void writeAt(int fd, const char *data, std::size_t size, std::uint64_t offset, const std::string &path)
+{
+    while (size > 0)
+    {
+        ssize_t count = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw ioError("Cannot write", path);
+        }
+        data += count;
+        size -= static_cast<std::size_t>(count);
+        offset += static_cast<std::uint64_t>(count);
+    }
+}
+
+void syncDirectory(const std::string &path)
+{
+    std::string::size_type slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw ioError("Cannot open directory", directory);
+    }
+    int result = ::fsync(fd);
+    int error = errno;
+    ::close(fd);
+    if (result != 0)
+    {
+        errno = error;
+        throw ioError("Cannot sync directory", directory);
+    }
+}
+
+bool recordFollows(const char *data, std::uint64_t start, std::uint64_t size, std::uint32_t minLength)
+{
+    for (std::uint64_t at = start + 1; at + RECORD_HEADER_SIZE + minLength <= size; ++at)
+    {
+        std::uint32_t length = loadUint32(data + at);
+        if (length >= minLength && length <= size - at - RECORD_HEADER_SIZE &&
+            Crc32::compute(data + at + RECORD_HEADER_SIZE, length) == loadUint32(data + at + 4))
+        {
+            return true;
+        }
+    }
+    return false;
+}
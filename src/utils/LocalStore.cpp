@@ -0,0 +1,406 @@
+#include "utils/LocalStore.h"
+#include "utils/Crc32.h"
+#include "utils/FileIo.h"
+#include "utils/MappedFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    // Compaction copies live records out in batches of this size
+    constexpr std::size_t COPY_BLOCK = 1 << 20;
+
+    // Kind and key length ahead of the key
+    constexpr std::size_t PAYLOAD_PREFIX = 5;
+}
+
+std::shared_ptr<LocalStore> LocalStore::open(const std::string &path, const LocalStoreOptions &options)
+{
+    // Left behind by a compaction that crashed before its rename
+    ::unlink((path + ".compact").c_str());
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw ioError("Cannot open local store", path);
+    }
+    std::shared_ptr<LocalStore> store(new LocalStore(path, fd, options));
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        throw ioError("Cannot stat local store", path);
+    }
+    std::uint64_t size = static_cast<std::uint64_t>(info.st_size);
+
+    std::uint64_t end = 0;
+    if (size >= HEADER_SIZE)
+    {
+        char header[HEADER_SIZE];
+        if (::pread(fd, header, HEADER_SIZE, 0) != static_cast<ssize_t>(HEADER_SIZE))
+        {
+            throw ioError("Cannot read local store", path);
+        }
+        if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0)
+        {
+            throw std::runtime_error("Not a local store: " + path);
+        }
+        if (loadUint32(header + sizeof(MAGIC)) != VERSION)
+        {
+            throw std::runtime_error("Unsupported local store version in " + path);
+        }
+        end = store->replay(size);
+    }
+    else
+    {
+        // New, or a crash cut the header short; either way it is empty
+        char header[HEADER_SIZE];
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        storeUint32(header + sizeof(MAGIC), VERSION);
+        if (::ftruncate(fd, 0) != 0)
+        {
+            throw ioError("Cannot truncate local store", path);
+        }
+        writeAt(fd, header, HEADER_SIZE, 0, path);
+        end = HEADER_SIZE;
+        size = 0;
+    }
+
+    if (end < size)
+    {
+        store->truncated_ = size - end;
+        if (::ftruncate(fd, static_cast<off_t>(end)) != 0)
+        {
+            throw ioError("Cannot truncate local store", path);
+        }
+    }
+    if (::fdatasync(fd) != 0)
+    {
+        throw ioError("Cannot sync local store", path);
+    }
+    store->end_ = end;
+    return store;
+}
+
+LocalStore::LocalStore(const std::string &path, int fd, const LocalStoreOptions &options)
+    : path_(path), fd_(fd), options_(options), replayed_(0), truncated_(0), end_(0), liveBytes_(0)
+{
+}
+
+LocalStore::~LocalStore()
+{
+    ::fdatasync(fd_);
+    ::close(fd_);
+}
+
+std::uint64_t LocalStore::replay(std::uint64_t size)
+{
+    auto file = MappedFile::open(path_);
+    const char *data = file->data();
+    size = std::min<std::uint64_t>(size, file->size());
+
+    std::uint64_t offset = HEADER_SIZE;
+    while (offset + RECORD_HEADER_SIZE <= size)
+    {
+        const char *record = data + offset;
+        std::uint32_t length = loadUint32(record);
+        const char *payload = record + RECORD_HEADER_SIZE;
+        // Short-circuits so nothing past the end of the file is read
+        bool whole = length >= PAYLOAD_PREFIX && offset + RECORD_HEADER_SIZE + length <= size &&
+                     Crc32::compute(payload, length) == loadUint32(record + 4);
+        std::uint8_t kind = whole ? static_cast<std::uint8_t>(payload[0]) : PUT;
+        std::uint32_t keySize = whole ? loadUint32(payload + 1) : 0;
+        if (!whole || keySize > length - PAYLOAD_PREFIX || (kind != PUT && kind != REMOVE))
+        {
+            // Torn only if it is the last record; otherwise cutting it off
+            // would lose the ones after it
+            if (recordFollows(data, offset, size, PAYLOAD_PREFIX))
+            {
+                throw std::runtime_error("Corrupt local store record at offset " + std::to_string(offset) + " in " + path_);
+            }
+            break;
+        }
+
+        std::uint32_t recordSize = static_cast<std::uint32_t>(RECORD_HEADER_SIZE + length);
+        std::string key(payload + PAYLOAD_PREFIX, keySize);
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            drop(it->second);
+        }
+        if (kind == PUT)
+        {
+            Location &location = it != index_.end() ? it->second : index_[key];
+            location = Location{offset, recordSize, static_cast<std::uint32_t>(length - PAYLOAD_PREFIX - keySize)};
+            liveBytes_ += recordSize;
+        }
+        else if (it != index_.end())
+        {
+            index_.erase(it);
+        }
+        ++replayed_;
+        offset += recordSize;
+    }
+    return offset;
+}
+
+void LocalStore::encode(std::uint8_t kind, std::string_view key, std::string_view value, std::vector<char> &out)
+{
+    if (key.empty())
+    {
+        throw std::invalid_argument("Key cannot be empty");
+    }
+    if (key.size() + value.size() > std::numeric_limits<std::uint32_t>::max() - RECORD_HEADER_SIZE - PAYLOAD_PREFIX)
+    {
+        throw std::invalid_argument("Key and value too large for one record");
+    }
+
+    std::size_t length = PAYLOAD_PREFIX + key.size() + value.size();
+    out.resize(RECORD_HEADER_SIZE + length);
+    char *payload = out.data() + RECORD_HEADER_SIZE;
+    payload[0] = static_cast<char>(kind);
+    storeUint32(payload + 1, static_cast<std::uint32_t>(key.size()));
+    std::memcpy(payload + PAYLOAD_PREFIX, key.data(), key.size());
+    if (!value.empty())
+    {
+        std::memcpy(payload + PAYLOAD_PREFIX + key.size(), value.data(), value.size());
+    }
+    storeUint32(out.data(), static_cast<std::uint32_t>(length));
+    storeUint32(out.data() + 4, Crc32::compute(payload, length));
+}
+
+void LocalStore::put(std::string_view key, std::string_view value)
+{
+    // Encoded before taking the lock, so writers only contend on the write
+    thread_local std::vector<char> record;
+    encode(PUT, key, value, record);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::uint64_t offset = end_;
+    append(record);
+
+    auto result = index_.try_emplace(std::string(key));
+    if (!result.second)
+    {
+        drop(result.first->second);
+    }
+    result.first->second = Location{offset, static_cast<std::uint32_t>(record.size()), static_cast<std::uint32_t>(value.size())};
+    liveBytes_ += record.size();
+    maybeCompact();
+}
+
+bool LocalStore::get(std::string_view key, std::string &value) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(std::string(key));
+    if (it == index_.end())
+    {
+        return false;
+    }
+    const Location &location = it->second;
+    value.resize(location.valueSize);
+    readAt(location.record + location.recordSize - location.valueSize, value.data(), location.valueSize);
+    return true;
+}
+
+bool LocalStore::contains(std::string_view key) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return index_.count(std::string(key)) > 0;
+}
+
+bool LocalStore::remove(std::string_view key)
+{
+    thread_local std::vector<char> record;
+    encode(REMOVE, key, std::string_view(), record);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(std::string(key));
+    if (it == index_.end())
+    {
+        return false;
+    }
+    append(record);
+    drop(it->second);
+    index_.erase(it);
+    maybeCompact();
+    return true;
+}
+
+void LocalStore::forEach(std::string_view prefix, const Visitor &visit) const
+{
+    std::string value;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto &[key, location] : index_)
+    {
+        if (key.compare(0, prefix.size(), prefix) != 0)
+        {
+            continue;
+        }
+        value.resize(location.valueSize);
+        readAt(location.record + location.recordSize - location.valueSize, value.data(), location.valueSize);
+        visit(key, value);
+    }
+}
+
+void LocalStore::sync()
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (::fdatasync(fd_) != 0)
+    {
+        throw ioError("Cannot sync local store", path_);
+    }
+}
+
+void LocalStore::compact()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    rewrite();
+}
+
+void LocalStore::rewrite()
+{
+    std::string tempPath = path_ + ".compact";
+    int fd = ::open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        throw ioError("Cannot create", tempPath);
+    }
+
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(index_.size());
+    std::uint64_t end = HEADER_SIZE;
+    try
+    {
+        auto file = MappedFile::open(path_);
+        std::vector<char> block;
+        block.reserve(COPY_BLOCK);
+        block.insert(block.end(), MAGIC, MAGIC + sizeof(MAGIC));
+        block.resize(HEADER_SIZE);
+        storeUint32(block.data() + sizeof(MAGIC), VERSION);
+        std::uint64_t blockStart = 0;
+
+        for (const auto &entry : index_)
+        {
+            const Location &location = entry.second;
+            if (block.size() + location.recordSize > COPY_BLOCK && !block.empty())
+            {
+                writeAt(fd, block.data(), block.size(), blockStart, tempPath);
+                blockStart += block.size();
+                block.clear();
+            }
+            const char *record = file->data() + location.record;
+            block.insert(block.end(), record, record + location.recordSize);
+            offsets.push_back(end);
+            end += location.recordSize;
+        }
+        writeAt(fd, block.data(), block.size(), blockStart, tempPath);
+
+        if (::fdatasync(fd) != 0)
+        {
+            throw ioError("Cannot sync", tempPath);
+        }
+        if (::rename(tempPath.c_str(), path_.c_str()) != 0)
+        {
+            throw ioError("Cannot replace local store", path_);
+        }
+    }
+    catch (...)
+    {
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        throw;
+    }
+
+    // The new file is in place; from here on only it is used
+    ::close(fd_);
+    fd_ = fd;
+    end_ = end;
+    auto offset = offsets.begin();
+    for (auto &entry : index_)
+    {
+        entry.second.record = *offset++;
+    }
+    syncDirectory(path_);
+}
+
+std::size_t LocalStore::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return index_.size();
+}
+
+std::uint64_t LocalStore::getLiveBytes() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return liveBytes_;
+}
+
+std::uint64_t LocalStore::getDeadBytes() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return end_ - HEADER_SIZE - liveBytes_;
+}
+
+void LocalStore::append(const std::vector<char> &record)
+{
+    // A failed write leaves end_ alone, so the next one overwrites the
+    // partial record
+    writeAt(fd_, record.data(), record.size(), end_, path_);
+    if (options_.syncEachWrite && ::fdatasync(fd_) != 0)
+    {
+        throw ioError("Cannot sync local store", path_);
+    }
+    end_ += record.size();
+}
+
+void LocalStore::drop(const Location &location)
+{
+    liveBytes_ -= location.recordSize;
+}
+
+void LocalStore::maybeCompact()
+{
+    std::uint64_t dead = end_ - HEADER_SIZE - liveBytes_;
+    if (dead <= options_.compactThreshold || dead <= liveBytes_)
+    {
+        return;
+    }
+    try
+    {
+        rewrite();
+    }
+    catch (const std::exception &)
+    {
+        // The write itself went through and the old file is still whole;
+        // the next write tries again
+    }
+}
+
+void LocalStore::readAt(std::uint64_t offset, char *out, std::size_t size) const
+{
+    while (size > 0)
+    {
+        ssize_t count = ::pread(fd_, out, size, static_cast<off_t>(offset));
+        if (count <= 0)
+        {
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            throw count == 0 ? std::runtime_error("Local store ends inside a record: " + path_)
+                             : ioError("Cannot read local store", path_);
+        }
+        out += count;
+        size -= static_cast<std::size_t>(count);
+        offset += static_cast<std::uint64_t>(count);
+    }
+}
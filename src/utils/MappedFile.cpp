@@ -0,0 +1,49 @@
+#include "utils/MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path + ": " + std::strerror(error));
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+
+    void *data = nullptr;
+    if (size > 0)
+    {
+        data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path + ": " + std::strerror(error));
+        }
+    }
+    // The mapping keeps the file open
+    ::close(fd);
+    return std::shared_ptr<MappedFile>(new MappedFile(path, static_cast<const char *>(data), size));
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        ::munmap(const_cast<char *>(data_), size_);
+    }
+}
@@ -0,0 +1,65 @@
+#include "utils/Symbol.h"
+#include <mutex>
+#include <stdexcept>
+
+SymbolTable &SymbolTable::instance()
+{
+    static SymbolTable table;
+    return table;
+}
+
+SymbolTable::SymbolTable()
+{
+    names_.emplace_back();
+    ids_.emplace(names_.back(), 0);
+}
+
+std::uint32_t SymbolTable::intern(std::string_view name)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end())
+    {
+        return it->second;
+    }
+    if (names_.size() >= NOT_FOUND)
+    {
+        throw std::length_error("Symbol table is full");
+    }
+    auto id = static_cast<std::uint32_t>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+std::uint32_t SymbolTable::find(std::string_view name) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    return it != ids_.end() ? it->second : NOT_FOUND;
+}
+
+const std::string &SymbolTable::name(std::uint32_t id) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (id >= names_.size())
+    {
+        throw std::out_of_range("Unknown symbol");
+    }
+    return names_[id];
+}
+
+std::size_t SymbolTable::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.size();
+}
@@ -0,0 +1,163 @@
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace
+{
+    // Shared by the calling thread and the helpers of one parallelFor call
+    struct Loop
+    {
+        Loop(std::size_t count, std::size_t grain, std::size_t chunks, const ThreadPool::ChunkFn &fn)
+            : count(count), grain(grain), chunks(chunks), fn(fn), next(0), remaining(chunks) {}
+
+        // Claims and runs chunks until none are left
+        void work()
+        {
+            for (std::size_t chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1))
+            {
+                try
+                {
+                    std::size_t begin = chunk * grain;
+                    fn(chunk, begin, std::min(begin + grain, count));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+                if (remaining.fetch_sub(1) == 1)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done.notify_all();
+                }
+            }
+        }
+
+        const std::size_t count;
+        const std::size_t grain;
+        const std::size_t chunks;
+        const ThreadPool::ChunkFn &fn;
+        std::atomic<std::size_t> next;
+        std::atomic<std::size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::create(std::size_t threads)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::shared_ptr<ThreadPool>(new ThreadPool(threads));
+}
+
+ThreadPool::ThreadPool(std::size_t threads) : stopping_(false)
+{
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        workers_.emplace_back([this]
+                              { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    available_.notify_all();
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [this]
+                            { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty())
+            {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+std::size_t ThreadPool::chunkCount(std::size_t count, std::size_t grain)
+{
+    grain = std::max<std::size_t>(grain, 1);
+    return (count + grain - 1) / grain;
+}
+
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain, const ChunkFn &fn)
+{
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t chunks = chunkCount(count, grain);
+    if (chunks == 0)
+    {
+        return;
+    }
+    if (chunks == 1)
+    {
+        fn(0, 0, count);
+        return;
+    }
+
+    auto loop = std::make_shared<Loop>(count, grain, chunks, fn);
+    std::size_t helpers = std::min(chunks - 1, workers_.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < helpers; ++i)
+        {
+            // A helper that starts after every chunk is claimed just returns
+            tasks_.emplace_back([loop]
+                                { loop->work(); });
+        }
+    }
+    available_.notify_all();
+
+    loop->work();
+    {
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->done.wait(lock, [&]
+                        { return loop->remaining.load() == 0; });
+    }
+    if (loop->error)
+    {
+        std::rethrow_exception(loop->error);
+    }
+}
+
+void ThreadPool::parallelFor(ThreadPool *pool, std::size_t count, std::size_t grain, const ChunkFn &fn)
+{
+    if (pool)
+    {
+        pool->parallelFor(count, grain, fn);
+        return;
+    }
+    std::size_t chunks = chunkCount(count, grain);
+    grain = std::max<std::size_t>(grain, 1);
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        std::size_t begin = chunk * grain;
+        fn(chunk, begin, std::min(begin + grain, count));
+    }
+}
@@ -0,0 +1,232 @@
+#include "database/AccountRepository.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using market::core::Account;
+
+namespace
+{
+    // Accounts in memory, counting the calls the repository makes
+    class MemoryAccountStore : public AccountStore
+    {
+    public:
+        AccountPtr load(const std::string &id) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++loads;
+            auto it = accounts_.find(id);
+            return it == accounts_.end() ? nullptr : it->second;
+        }
+
+        void loadAll(const std::function<void(AccountPtr)> &visit) override
+        {
+            std::map<std::string, AccountPtr> accounts;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                accounts = accounts_;
+            }
+            for (const auto &account : accounts)
+            {
+                visit(account.second);
+            }
+        }
+
+        void write(const std::vector<AccountPtr> &saved, const std::vector<std::string> &removed) override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (failWrites)
+            {
+                throw std::runtime_error("write refused");
+            }
+            for (const auto &account : saved)
+            {
+                accounts_[account->getId()] = account;
+            }
+            for (const auto &id : removed)
+            {
+                accounts_.erase(id);
+            }
+            writeSizes.push_back(saved.size() + removed.size());
+        }
+
+        bool contains(const std::string &id)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return accounts_.count(id) != 0;
+        }
+
+        std::size_t writeCount()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return writeSizes.size();
+        }
+
+        int loads = 0;
+        bool failWrites = false;
+        std::vector<std::size_t> writeSizes;
+
+    private:
+        std::mutex mutex_;
+        std::map<std::string, AccountPtr> accounts_;
+    };
+
+    class AccountRepositoryTest : public ::testing::Test
+    {
+    protected:
+        // The flusher only runs when a test asks for it
+        std::shared_ptr<AccountRepository> open(std::size_t cacheCapacity = 100, std::size_t flushBatchSize = 100)
+        {
+            AccountRepositoryOptions options;
+            options.cacheCapacity = cacheCapacity;
+            options.flushBatchSize = flushBatchSize;
+            options.flushInterval = std::chrono::hours(1);
+            return AccountRepository::create(store_, options);
+        }
+
+        // Stored without going through the repository
+        std::shared_ptr<Account> stored(const std::string &name)
+        {
+            auto account = Account::create(name, Account::AccountType::ASSET);
+            store_->write({account}, {});
+            store_->writeSizes.clear();
+            return account;
+        }
+
+        std::shared_ptr<MemoryAccountStore> store_ = std::make_shared<MemoryAccountStore>();
+    };
+}
+
+TEST_F(AccountRepositoryTest, RepeatLookupsComeFromTheCache)
+{
+    auto account = stored("Cash");
+    auto repository = open();
+
+    EXPECT_EQ(repository->findById(account->getId()), account);
+    EXPECT_EQ(repository->findById(account->getId()), account);
+    EXPECT_EQ(store_->loads, 1);
+    EXPECT_EQ(repository->getCachedCount(), 1u);
+
+    // Misses are not cached
+    EXPECT_EQ(repository->findById("ACC-none"), nullptr);
+    EXPECT_EQ(repository->findById("ACC-none"), nullptr);
+    EXPECT_EQ(store_->loads, 3);
+}
+
+TEST_F(AccountRepositoryTest, EvictsTheLeastRecentlyUsed)
+{
+    auto first = stored("First");
+    auto second = stored("Second");
+    auto third = stored("Third");
+    auto repository = open(2);
+
+    repository->findById(first->getId());
+    repository->findById(second->getId());
+    repository->findById(first->getId());
+    repository->findById(third->getId());
+    EXPECT_EQ(repository->getCachedCount(), 2u);
+    EXPECT_EQ(store_->loads, 3);
+
+    repository->findById(first->getId());
+    EXPECT_EQ(store_->loads, 3);
+    repository->findById(second->getId());
+    EXPECT_EQ(store_->loads, 4);
+}
+
+TEST_F(AccountRepositoryTest, ChangesAreSeenBeforeTheyAreFlushed)
+{
+    auto kept = stored("Kept");
+    auto removed = stored("Removed");
+    auto added = Account::create("Added", Account::AccountType::LIABILITY);
+    auto repository = open();
+
+    repository->save(added);
+    repository->remove(removed->getId());
+    EXPECT_EQ(repository->getPendingCount(), 2u);
+    EXPECT_FALSE(store_->contains(added->getId()));
+    EXPECT_TRUE(store_->contains(removed->getId()));
+
+    EXPECT_EQ(repository->findById(added->getId()), added);
+    EXPECT_EQ(repository->findById(removed->getId()), nullptr);
+    auto all = repository->findAll();
+    ASSERT_EQ(all.size(), 2u);
+    EXPECT_NE(std::find(all.begin(), all.end(), kept), all.end());
+    EXPECT_NE(std::find(all.begin(), all.end(), added), all.end());
+    EXPECT_EQ(store_->loads, 0);
+
+    repository->flush();
+    EXPECT_EQ(repository->getPendingCount(), 0u);
+    EXPECT_TRUE(store_->contains(added->getId()));
+    EXPECT_FALSE(store_->contains(removed->getId()));
+    EXPECT_EQ(store_->writeSizes, std::vector<std::size_t>{2});
+}
+
+TEST_F(AccountRepositoryTest, FlushesOneTransactionPerBatch)
+{
+    auto repository = open(100, 3);
+    for (int i = 0; i < 8; ++i)
+    {
+        repository->save(Account::create("Account " + std::to_string(i), Account::AccountType::ASSET));
+    }
+    repository->flush();
+    EXPECT_EQ(repository->getPendingCount(), 0u);
+
+    // The flusher may have taken some batches first
+    std::size_t written = 0;
+    for (std::size_t size : store_->writeSizes)
+    {
+        EXPECT_LE(size, 3u);
+        written += size;
+    }
+    EXPECT_EQ(written, 8u);
+    EXPECT_GE(store_->writeCount(), 3u);
+}
+
+TEST_F(AccountRepositoryTest, AFailedFlushKeepsItsChangesPending)
+{
+    auto account = Account::create("Cash", Account::AccountType::ASSET);
+    auto repository = open();
+    repository->save(account);
+
+    store_->failWrites = true;
+    EXPECT_THROW(repository->flush(), std::runtime_error);
+    EXPECT_EQ(repository->getPendingCount(), 1u);
+    EXPECT_EQ(repository->findById(account->getId()), account);
+
+    store_->failWrites = false;
+    repository->flush();
+    EXPECT_EQ(repository->getPendingCount(), 0u);
+    EXPECT_TRUE(store_->contains(account->getId()));
+}
+
+TEST_F(AccountRepositoryTest, AFullBatchWakesTheFlusher)
+{
+    auto repository = open(100, 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        repository->save(Account::create("Account " + std::to_string(i), Account::AccountType::ASSET));
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (repository->getPendingCount() != 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(repository->getPendingCount(), 0u);
+    EXPECT_EQ(store_->writeCount(), 1u);
+}
+
+TEST_F(AccountRepositoryTest, DestructionFlushesWhatIsPending)
+{
+    auto account = Account::create("Cash", Account::AccountType::ASSET);
+    open()->save(account);
+    EXPECT_TRUE(store_->contains(account->getId()));
+}
@@ -0,0 +1,99 @@
+#include "database/AsyncDatabase.h"
+#include "PostgresTest.h"
+#include <gtest/gtest.h>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using market::core::Account;
+
+namespace
+{
+    class AsyncDatabaseTest : public PostgresTest
+    {
+    protected:
+        std::shared_ptr<AsyncDatabase> open(std::size_t maxInFlight = 1024) const
+        {
+            AsyncDatabaseOptions options;
+            options.maxInFlight = maxInFlight;
+            return AsyncDatabase::create(host_, port_, dbname_, user_, password_, options);
+        }
+    };
+}
+
+TEST_F(AsyncDatabaseTest, CompletesPipelinedRequestsInOrder)
+{
+    auto database = open(16);
+    std::vector<std::shared_ptr<Account>> accounts;
+    std::vector<std::future<void>> saves;
+    for (int i = 0; i < 200; ++i)
+    {
+        accounts.push_back(Account::create("Account " + std::to_string(i), Account::AccountType::ASSET));
+        saves.push_back(database->saveAccount(accounts.back()));
+    }
+    auto removed = database->deleteAccount(accounts[0]->getId());
+    auto load = database->loadAccount(accounts[1]->getId());
+    auto missing = database->loadAccount(accounts[0]->getId());
+
+    for (auto &save : saves)
+    {
+        EXPECT_NO_THROW(save.get());
+    }
+    EXPECT_NO_THROW(removed.get());
+    auto loaded = load.get();
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->getName(), "Account 1");
+    EXPECT_EQ(missing.get(), nullptr);
+
+    database->drain();
+    EXPECT_EQ(database->getInFlightCount(), 0u);
+}
+
+TEST_F(AsyncDatabaseTest, AFailedStatementDoesNotAbortTheOthers)
+{
+    auto database = open();
+    auto before = Account::create("Before", Account::AccountType::ASSET);
+    auto after = Account::create("After", Account::AccountType::ASSET);
+
+    auto first = database->saveAccount(before);
+    // Longer than the name column allows
+    auto failed = database->saveAccount(Account::create(std::string(300, 'x'), Account::AccountType::ASSET));
+    auto second = database->saveAccount(after);
+
+    EXPECT_NO_THROW(first.get());
+    EXPECT_THROW(failed.get(), std::runtime_error);
+    EXPECT_NO_THROW(second.get());
+    EXPECT_TRUE(database->isConnected());
+
+    auto reread = connect();
+    EXPECT_NE(reread->loadAccount(before->getId()), nullptr);
+    EXPECT_NE(reread->loadAccount(after->getId()), nullptr);
+}
+
+TEST_F(AsyncDatabaseTest, ReconnectsAfterTheConnectionIsLost)
+{
+    auto database = open();
+    auto account = Account::create("Cash", Account::AccountType::ASSET);
+    database->saveAccount(account).get();
+
+    execute("SELECT pg_terminate_backend(pid) FROM pg_stat_activity"
+            " WHERE datname = current_database() AND pid <> pg_backend_pid()");
+
+    // The first request may still go out on the dead connection and fail
+    std::shared_ptr<Account> loaded;
+    for (int attempt = 0; attempt < 3 && !loaded; ++attempt)
+    {
+        try
+        {
+            loaded = database->loadAccount(account->getId()).get();
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+    }
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->getName(), "Cash");
+    EXPECT_TRUE(database->isConnected());
+}
@@ -0,0 +1,138 @@
+#include "accounting/BalanceKernel.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using market::accounting::BalanceKernel;
+
+namespace
+{
+    // Plain loops in uint64_t, independent of the kernels under test
+    std::int64_t referenceSum(const std::vector<std::int64_t> &amounts)
+    {
+        std::uint64_t total = 0;
+        for (std::int64_t amount : amounts)
+        {
+            total += static_cast<std::uint64_t>(amount);
+        }
+        return static_cast<std::int64_t>(total);
+    }
+
+    std::int64_t referenceSumUntil(const std::vector<std::int64_t> &amounts,
+                                   const std::vector<std::int64_t> &timestamps, std::int64_t cutoff)
+    {
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < amounts.size(); ++i)
+        {
+            if (timestamps[i] <= cutoff)
+            {
+                total += static_cast<std::uint64_t>(amounts[i]);
+            }
+        }
+        return static_cast<std::int64_t>(total);
+    }
+
+    class BalanceKernelTest : public ::testing::TestWithParam<BalanceKernel::Isa>
+    {
+    protected:
+        void SetUp() override
+        {
+            detected_ = BalanceKernel::getIsa();
+            BalanceKernel::setIsa(GetParam());
+        }
+
+        void TearDown() override
+        {
+            BalanceKernel::setIsa(detected_);
+        }
+
+        BalanceKernel::Isa detected_ = BalanceKernel::Isa::SCALAR;
+    };
+
+    std::vector<std::int64_t> randomColumn(std::mt19937_64 &rng, std::size_t count, std::int64_t bound)
+    {
+        std::uniform_int_distribution<std::int64_t> dist(-bound, bound);
+        std::vector<std::int64_t> column(count);
+        for (auto &value : column)
+        {
+            value = dist(rng);
+        }
+        return column;
+    }
+}
+
+// Every length up to a few vector widths, so each tail size is covered
+TEST_P(BalanceKernelTest, MatchesReferenceForEveryTailLength)
+{
+    std::mt19937_64 rng(42);
+    for (std::size_t count = 0; count <= 40; ++count)
+    {
+        auto amounts = randomColumn(rng, count, 1'000'000'000'000);
+        auto timestamps = randomColumn(rng, count, 1000);
+        SCOPED_TRACE(count);
+
+        EXPECT_EQ(BalanceKernel::sum(amounts.data(), count), referenceSum(amounts));
+        EXPECT_EQ(BalanceKernel::sumUntil(amounts.data(), timestamps.data(), count, 0),
+                  referenceSumUntil(amounts, timestamps, 0));
+
+        std::int64_t positive = -1;
+        std::int64_t negative = 1;
+        BalanceKernel::sumBySign(amounts.data(), count, positive, negative);
+        std::vector<std::int64_t> positives;
+        std::vector<std::int64_t> negatives;
+        for (std::int64_t amount : amounts)
+        {
+            (amount > 0 ? positives : negatives).push_back(amount);
+        }
+        EXPECT_EQ(positive, referenceSum(positives));
+        EXPECT_EQ(negative, referenceSum(negatives));
+    }
+}
+
+TEST_P(BalanceKernelTest, SumUntilIncludesTheCutoff)
+{
+    std::vector<std::int64_t> amounts{1, 2, 4, 8, 16};
+    std::vector<std::int64_t> timestamps{50, 10, 30, 20, 40};
+
+    EXPECT_EQ(BalanceKernel::sumUntil(amounts.data(), timestamps.data(), amounts.size(), 9), 0);
+    EXPECT_EQ(BalanceKernel::sumUntil(amounts.data(), timestamps.data(), amounts.size(), 30), 14);
+    EXPECT_EQ(BalanceKernel::sumUntil(amounts.data(), timestamps.data(), amounts.size(), 50), 31);
+}
+
+TEST_P(BalanceKernelTest, OverflowWrapsModulo2To64)
+{
+    const std::int64_t max = std::numeric_limits<std::int64_t>::max();
+    const std::int64_t min = std::numeric_limits<std::int64_t>::min();
+    std::vector<std::int64_t> amounts(37, max);
+    amounts[5] = min;
+    std::vector<std::int64_t> timestamps(amounts.size(), 0);
+
+    EXPECT_EQ(BalanceKernel::sum(amounts.data(), amounts.size()), referenceSum(amounts));
+    EXPECT_EQ(BalanceKernel::sum(amounts.data(), amounts.size()), max - 35);
+    EXPECT_EQ(BalanceKernel::sumUntil(amounts.data(), timestamps.data(), amounts.size(), 0), max - 35);
+
+    std::int64_t positive = 0;
+    std::int64_t negative = 0;
+    BalanceKernel::sumBySign(amounts.data(), amounts.size(), positive, negative);
+    EXPECT_EQ(positive, -36);
+    EXPECT_EQ(negative, min);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllIsas, BalanceKernelTest,
+                         ::testing::Values(BalanceKernel::Isa::SCALAR, BalanceKernel::Isa::SSE42,
+                                           BalanceKernel::Isa::AVX2),
+                         [](const ::testing::TestParamInfo<BalanceKernel::Isa> &info)
+                         {
+                             switch (info.param)
+                             {
+                             case BalanceKernel::Isa::AVX2:
+                                 return "Avx2";
+                             case BalanceKernel::Isa::SSE42:
+                                 return "Sse42";
+                             case BalanceKernel::Isa::SCALAR:
+                                 break;
+                             }
+                             return "Scalar";
+                         });
@@ -0,0 +1,182 @@
+#include "accounting/EntryCodec.h"
+#include "utils/BinaryCodec.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using namespace market::accounting;
+
+TEST(BinaryCodecTest, EncodesVarintsInLittleEndianGroupsOfSevenBits)
+{
+    std::string out;
+    BinaryWriter writer(out);
+    writer.writeUint(1, 300);
+    EXPECT_EQ(out, std::string("\x08\xAC\x02"));
+
+    out.clear();
+    writer.writeInt(2, -1);
+    EXPECT_EQ(out, std::string("\x10\x01"));
+}
+
+TEST(BinaryCodecTest, NumbersRoundTrip)
+{
+    const std::uint64_t unsignedValues[] = {0, 1, 127, 128, 16383, 16384, 1ull << 35,
+                                            std::numeric_limits<std::uint64_t>::max()};
+    const std::int64_t signedValues[] = {0, 1, -1, 63, -64, 64, -65,
+                                         std::numeric_limits<std::int64_t>::max(),
+                                         std::numeric_limits<std::int64_t>::min()};
+    std::string out;
+    BinaryWriter writer(out);
+    for (std::uint64_t value : unsignedValues)
+    {
+        writer.writeUint(1, value);
+    }
+    for (std::int64_t value : signedValues)
+    {
+        writer.writeInt(2, value);
+    }
+
+    BinaryReader reader(out);
+    for (std::uint64_t value : unsignedValues)
+    {
+        ASSERT_TRUE(reader.next());
+        EXPECT_EQ(reader.field(), 1u);
+        EXPECT_EQ(reader.getUint(), value);
+    }
+    for (std::int64_t value : signedValues)
+    {
+        ASSERT_TRUE(reader.next());
+        EXPECT_EQ(reader.field(), 2u);
+        EXPECT_EQ(reader.getInt(), value);
+    }
+    EXPECT_FALSE(reader.next());
+}
+
+TEST(BinaryCodecTest, NestedMessagesOfEveryLengthWidthRoundTrip)
+{
+    for (std::size_t length : {std::size_t{0}, std::size_t{100}, std::size_t{127}, std::size_t{128},
+                               std::size_t{20000}})
+    {
+        const std::string payload(length, 'p');
+        std::string out;
+        BinaryWriter writer(out);
+        writer.writeUint(1, 7);
+        writer.writeMessage(2, [&](BinaryWriter &fields)
+                            {
+            fields.writeBytes(1, payload);
+            fields.writeMessage(2, [](BinaryWriter &inner)
+                                { inner.writeInt(1, -42); }); });
+        writer.writeBytes(3, "after");
+
+        BinaryReader reader(out);
+        ASSERT_TRUE(reader.next());
+        EXPECT_EQ(reader.getUint(), 7u);
+        ASSERT_TRUE(reader.next());
+        ASSERT_EQ(reader.field(), 2u);
+        BinaryReader fields = reader.getMessage();
+        ASSERT_TRUE(fields.next());
+        EXPECT_EQ(fields.getBytes(), payload);
+        ASSERT_TRUE(fields.next());
+        BinaryReader inner = fields.getMessage();
+        ASSERT_TRUE(inner.next());
+        EXPECT_EQ(inner.getInt(), -42);
+        EXPECT_FALSE(inner.next());
+        EXPECT_FALSE(fields.next());
+        ASSERT_TRUE(reader.next());
+        EXPECT_EQ(reader.getBytes(), "after");
+        EXPECT_FALSE(reader.next());
+    }
+}
+
+TEST(BinaryCodecTest, ReaderSkipsFieldsItDoesNotAskFor)
+{
+    std::string out;
+    BinaryWriter writer(out);
+    writer.writeBytes(9, "from a newer writer");
+    writer.writeUint(1, 5);
+    writer.writeMessage(10, [](BinaryWriter &fields)
+                        { fields.writeUint(1, 1); });
+
+    std::uint64_t value = 0;
+    BinaryReader reader(out);
+    while (reader.next())
+    {
+        if (reader.field() == 1)
+        {
+            value = reader.getUint();
+        }
+    }
+    EXPECT_EQ(value, 5u);
+}
+
+TEST(BinaryCodecTest, MalformedDataThrows)
+{
+    auto readAll = [](const std::string &data)
+    {
+        BinaryReader reader(data);
+        while (reader.next())
+        {
+        }
+    };
+    // Cut short inside a varint, and inside a length-delimited field
+    EXPECT_THROW(readAll(std::string("\x08\x80", 2)), std::runtime_error);
+    EXPECT_THROW(readAll(std::string("\x12\x05" "abc", 5)), std::runtime_error);
+    // Field number 0, an unknown wire type, and a varint longer than 64 bits
+    EXPECT_THROW(readAll(std::string("\x00\x01", 2)), std::runtime_error);
+    EXPECT_THROW(readAll(std::string("\x0B\x01", 2)), std::runtime_error);
+    EXPECT_THROW(readAll(std::string(10, '\xFF') + '\x01'), std::runtime_error);
+
+    // Reading a field as the wrong type
+    std::string out;
+    BinaryWriter writer(out);
+    writer.writeUint(1, 1);
+    writer.writeBytes(2, "x");
+    BinaryReader reader(out);
+    ASSERT_TRUE(reader.next());
+    EXPECT_THROW(reader.getBytes(), std::runtime_error);
+    ASSERT_TRUE(reader.next());
+    EXPECT_THROW(reader.getUint(), std::runtime_error);
+}
+
+TEST(BinaryCodecTest, JournalEntryRoundTrips)
+{
+    auto entry = JournalEntry::create("TRX-1",
+                                      {{Symbol("CASH"), EntryType::DEBIT, Decimal(std::string("12.5")), "received"},
+                                       {Symbol("SALES"), EntryType::CREDIT, Decimal(std::string("12.5")), ""}},
+                                      "Sale");
+    std::string out;
+    BinaryWriter writer(out);
+    EntryCodec::encode(*entry, writer);
+
+    auto decoded = EntryCodec::decodeJournalEntry(out);
+    EXPECT_EQ(decoded->getNumericId(), entry->getNumericId());
+    EXPECT_EQ(decoded->getTransactionId(), entry->getTransactionId());
+    EXPECT_EQ(decoded->getDescription(), entry->getDescription());
+    EXPECT_EQ(decoded->getTimestamp(), entry->getTimestamp());
+    ASSERT_EQ(decoded->getEntries().size(), 2u);
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(decoded->getEntries()[i].accountId, entry->getEntries()[i].accountId);
+        EXPECT_EQ(decoded->getEntries()[i].type, entry->getEntries()[i].type);
+        EXPECT_EQ(decoded->getEntries()[i].amount, entry->getEntries()[i].amount);
+        EXPECT_EQ(decoded->getEntries()[i].description, entry->getEntries()[i].description);
+    }
+}
+
+TEST(BinaryCodecTest, LedgerEntryRoundTrips)
+{
+    auto entry = LedgerEntry::create(Symbol("CASH"), 42, EntryType::CREDIT, Decimal::fromRaw(12345));
+    std::string out;
+    BinaryWriter writer(out);
+    EntryCodec::encode(*entry, writer);
+
+    auto decoded = EntryCodec::decodeLedgerEntry(out);
+    EXPECT_EQ(decoded->getNumericId(), entry->getNumericId());
+    EXPECT_EQ(decoded->getAccountId(), entry->getAccountId());
+    EXPECT_EQ(decoded->getJournalEntryId(), 42u);
+    EXPECT_EQ(decoded->getType(), EntryType::CREDIT);
+    EXPECT_EQ(decoded->getAmount(), entry->getAmount());
+    EXPECT_EQ(decoded->getTimestamp(), entry->getTimestamp());
+}
@@ -0,0 +1,130 @@
+#include "database/Database.h"
+#include "PostgresTest.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using market::core::Account;
+using namespace market::accounting;
+
+namespace
+{
+    class DatabaseTest : public PostgresTest
+    {
+    protected:
+        // Balanced postings to ACC0 to ACC3 against CASH
+        static void post(Ledger &ledger, int first, int last)
+        {
+            std::vector<std::shared_ptr<JournalEntry>> entries;
+            for (int i = first; i <= last; ++i)
+            {
+                auto account = Symbol("ACC" + std::to_string(i % 4));
+                entries.push_back(JournalEntry::create("TRX" + std::to_string(i),
+                                                       {{account, EntryType::DEBIT, Decimal::fromRaw(i * 12345678), ""},
+                                                        {Symbol("CASH"), EntryType::CREDIT, Decimal::fromRaw(i * 12345678), ""}}));
+            }
+            ledger.postBatch(entries);
+        }
+
+        // The server keeps microseconds
+        static void expectSameEntries(const Ledger &actual, const Ledger &expected, std::string_view accountId)
+        {
+            auto actualEntries = actual.getEntries(accountId);
+            auto expectedEntries = expected.getEntries(accountId);
+            ASSERT_EQ(actualEntries.size(), expectedEntries.size()) << accountId;
+            for (std::size_t i = 0; i < expectedEntries.size(); ++i)
+            {
+                EXPECT_EQ(actualEntries[i].getNumericId(), expectedEntries[i].getNumericId());
+                EXPECT_EQ(actualEntries[i].getAccountId(), expectedEntries[i].getAccountId());
+                EXPECT_EQ(actualEntries[i].getJournalEntryId(), expectedEntries[i].getJournalEntryId());
+                EXPECT_EQ(actualEntries[i].getType(), expectedEntries[i].getType());
+                EXPECT_EQ(actualEntries[i].getAmount(), expectedEntries[i].getAmount());
+                EXPECT_EQ(actualEntries[i].getTimestamp(),
+                          std::chrono::time_point_cast<std::chrono::microseconds>(expectedEntries[i].getTimestamp()));
+            }
+        }
+    };
+}
+
+TEST_F(DatabaseTest, SavesLoadsAndDeletesAnAccount)
+{
+    auto database = connect();
+    auto account = Account::create("Operating cash", Account::AccountType::ASSET);
+
+    database->saveAccount(account);
+    auto loaded = database->loadAccount(account->getId());
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->getId(), account->getId());
+    EXPECT_EQ(loaded->getName(), "Operating cash");
+    EXPECT_EQ(loaded->getType(), Account::AccountType::ASSET);
+
+    // Saving again updates the row
+    database->saveAccount(Account::restore(account->getId(), "Petty cash", Account::AccountType::LIABILITY));
+    loaded = database->loadAccount(account->getId());
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->getName(), "Petty cash");
+    EXPECT_EQ(loaded->getType(), Account::AccountType::LIABILITY);
+
+    database->deleteAccount(account->getId());
+    EXPECT_EQ(database->loadAccount(account->getId()), nullptr);
+}
+
+TEST_F(DatabaseTest, RolledBackChangesAreNotStored)
+{
+    auto database = connect();
+    auto account = Account::create("Cash", Account::AccountType::ASSET);
+
+    database->beginTransaction();
+    database->saveAccount(account);
+    EXPECT_TRUE(database->isInTransaction());
+    database->rollbackTransaction();
+    EXPECT_FALSE(database->isInTransaction());
+    EXPECT_EQ(connect()->loadAccount(account->getId()), nullptr);
+}
+
+TEST_F(DatabaseTest, CopiedAccountsStreamBack)
+{
+    auto database = connect();
+    std::vector<std::shared_ptr<Account>> accounts;
+    for (int i = 0; i < 500; ++i)
+    {
+        accounts.push_back(Account::create("Account " + std::to_string(i), Account::AccountType::ASSET));
+    }
+    database->saveAccounts(accounts);
+    // Upserted, so a second copy renames instead of failing
+    accounts[7] = Account::restore(accounts[7]->getId(), "Renamed", Account::AccountType::EQUITY);
+    database->saveAccounts(accounts);
+
+    std::vector<std::shared_ptr<Account>> loaded;
+    connect()->loadAccounts([&](std::shared_ptr<Account> account)
+                            { loaded.push_back(std::move(account)); });
+    ASSERT_EQ(loaded.size(), accounts.size());
+    for (const auto &account : loaded)
+    {
+        if (account->getId() == accounts[7]->getId())
+        {
+            EXPECT_EQ(account->getName(), "Renamed");
+            EXPECT_EQ(account->getType(), Account::AccountType::EQUITY);
+        }
+    }
+}
+
+TEST_F(DatabaseTest, SavingALedgerAgainOnlyAddsItsNewEntries)
+{
+    auto database = connect();
+    auto ledger = Ledger::create("General");
+    post(*ledger, 1, 100);
+    database->saveLedgerEntries(*ledger);
+    post(*ledger, 101, 150);
+    database->saveLedgerEntries(*ledger);
+
+    auto loaded = Ledger::create("Loaded");
+    connect()->loadAll(*loaded);
+    for (const char *accountId : {"ACC0", "ACC1", "ACC2", "ACC3", "CASH"})
+    {
+        expectSameEntries(*loaded, *ledger, accountId);
+        EXPECT_EQ(loaded->getBalance(accountId), ledger->getBalance(accountId)) << accountId;
+    }
+}
@@ -0,0 +1,155 @@
+#include "utils/Decimal.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+static_assert(Decimal::SCALE == 8, "the expected values below assume 8 fractional digits");
+
+namespace
+{
+    using Mode = Decimal::RoundingMode;
+
+    // Parses the whole of text, failing the test if anything is left over
+    Decimal parse(const std::string &text, Mode mode = Mode::HALF_EVEN)
+    {
+        Decimal value;
+        auto result = Decimal::fromChars(text.data(), text.data() + text.size(), value, mode);
+        EXPECT_EQ(result.ec, std::errc()) << text;
+        EXPECT_EQ(result.ptr, text.data() + text.size()) << text;
+        return value;
+    }
+
+    std::string format(Decimal value)
+    {
+        char buffer[Decimal::MAX_CHARS];
+        auto result = value.toChars(buffer, buffer + sizeof(buffer));
+        EXPECT_EQ(result.ec, std::errc());
+        return std::string(buffer, result.ptr);
+    }
+}
+
+TEST(DecimalTest, ParsesSignsAndFractions)
+{
+    EXPECT_EQ(parse("0").toRaw(), 0);
+    EXPECT_EQ(parse("12").toRaw(), 1200000000);
+    EXPECT_EQ(parse("+12.5").toRaw(), 1250000000);
+    EXPECT_EQ(parse("-0.00000001").toRaw(), -1);
+    EXPECT_EQ(parse(".25").toRaw(), 25000000);
+    EXPECT_EQ(parse("7.").toRaw(), 700000000);
+}
+
+TEST(DecimalTest, StopsAtTheFirstCharacterThatIsNotPartOfTheNumber)
+{
+    const char text[] = "42.5USD";
+    Decimal value;
+    auto result = Decimal::fromChars(text, text + std::strlen(text), value);
+    EXPECT_EQ(result.ec, std::errc());
+    EXPECT_EQ(result.ptr, text + 4);
+    EXPECT_EQ(value, Decimal(std::string("42.5")));
+}
+
+TEST(DecimalTest, RejectsTextWithoutDigits)
+{
+    for (const char *text : {"", "-", "+.", ".", "abc"})
+    {
+        Decimal value = Decimal::fromRaw(123);
+        auto result = Decimal::fromChars(text, text + std::strlen(text), value);
+        EXPECT_EQ(result.ec, std::errc::invalid_argument) << text;
+        EXPECT_EQ(result.ptr, text) << text;
+        EXPECT_EQ(value.toRaw(), 123) << text;
+    }
+}
+
+TEST(DecimalTest, ReportsValuesOutOfRange)
+{
+    Decimal value;
+    const std::string tooLarge = "92233720368.54775808";
+    auto result = Decimal::fromChars(tooLarge.data(), tooLarge.data() + tooLarge.size(), value);
+    EXPECT_EQ(result.ec, std::errc::result_out_of_range);
+
+    EXPECT_EQ(parse("92233720368.54775807").toRaw(), std::numeric_limits<std::int64_t>::max());
+    EXPECT_EQ(parse("-92233720368.54775808").toRaw(), std::numeric_limits<std::int64_t>::min());
+    EXPECT_THROW(Decimal(std::string("1000000000000")), std::overflow_error);
+}
+
+TEST(DecimalTest, StringConstructorTrimsSpacesAndRejectsTrailingText)
+{
+    EXPECT_EQ(Decimal(std::string("  3.5 ")).toRaw(), 350000000);
+    EXPECT_THROW(Decimal(std::string("3.5x")), std::invalid_argument);
+    EXPECT_THROW(Decimal(std::string("")), std::invalid_argument);
+}
+
+// Each row: text with a ninth fraction digit, then the expected last digit
+// for HALF_EVEN, HALF_UP, HALF_DOWN, DOWN, UP, FLOOR and CEILING
+struct RoundingCase
+{
+    const char *text;
+    std::int64_t expected[7];
+};
+
+TEST(DecimalTest, RoundsDroppedDigitsWithEveryMode)
+{
+    const Mode modes[] = {Mode::HALF_EVEN, Mode::HALF_UP, Mode::HALF_DOWN, Mode::DOWN,
+                          Mode::UP, Mode::FLOOR, Mode::CEILING};
+    const RoundingCase cases[] = {
+        {"0.000000025", {2, 3, 2, 2, 3, 2, 3}},
+        {"0.000000035", {4, 4, 3, 3, 4, 3, 4}},
+        {"0.0000000251", {3, 3, 3, 2, 3, 2, 3}},
+        {"0.000000024", {2, 2, 2, 2, 3, 2, 3}},
+        {"0.000000026", {3, 3, 3, 2, 3, 2, 3}},
+        {"-0.000000025", {-2, -3, -2, -2, -3, -3, -2}},
+        {"-0.000000035", {-4, -4, -3, -3, -4, -4, -3}},
+        {"-0.000000026", {-3, -3, -3, -2, -3, -3, -2}},
+        {"0.0000000200", {2, 2, 2, 2, 2, 2, 2}},
+    };
+    for (const auto &c : cases)
+    {
+        for (int i = 0; i < 7; ++i)
+        {
+            EXPECT_EQ(parse(c.text, modes[i]).toRaw(), c.expected[i]) << c.text << " mode " << i;
+        }
+    }
+}
+
+TEST(DecimalTest, MultiplyAndDivideRound)
+{
+    Decimal third = Decimal(1).divide(Decimal(3), Mode::HALF_EVEN);
+    EXPECT_EQ(third.toRaw(), 33333333);
+    EXPECT_EQ(Decimal(2).divide(Decimal(3), Mode::HALF_EVEN).toRaw(), 66666667);
+    EXPECT_EQ(Decimal(2).divide(Decimal(3), Mode::DOWN).toRaw(), 66666666);
+    EXPECT_EQ(Decimal(-2).divide(Decimal(3), Mode::FLOOR).toRaw(), -66666667);
+
+    // 0.00000005 * 0.5 is exactly half a unit
+    EXPECT_EQ(Decimal::fromRaw(5).multiply(parse("0.5"), Mode::HALF_EVEN).toRaw(), 2);
+    EXPECT_EQ(Decimal::fromRaw(5).multiply(parse("0.5"), Mode::HALF_UP).toRaw(), 3);
+    EXPECT_EQ((parse("1.5") * parse("2.25")).toRaw(), 337500000);
+
+    EXPECT_THROW(Decimal(1) / Decimal(), std::invalid_argument);
+}
+
+TEST(DecimalTest, FormatsTheShortestExactText)
+{
+    EXPECT_EQ(format(Decimal()), "0");
+    EXPECT_EQ(format(Decimal(42)), "42");
+    EXPECT_EQ(format(parse("-12.50")), "-12.5");
+    EXPECT_EQ(format(Decimal::fromRaw(1)), "0.00000001");
+    EXPECT_EQ(format(Decimal::fromRaw(std::numeric_limits<std::int64_t>::min())), "-92233720368.54775808");
+    EXPECT_EQ(Decimal(std::string("0.1")).toString(), "0.1");
+
+    char small[3];
+    auto result = Decimal(1000).toChars(small, small + sizeof(small));
+    EXPECT_EQ(result.ec, std::errc::value_too_large);
+}
+
+TEST(DecimalTest, FormattingRoundTripsThroughParsing)
+{
+    for (std::int64_t raw : {std::int64_t{0}, std::int64_t{1}, std::int64_t{-1}, std::int64_t{123456789},
+                             std::int64_t{-100000000}, std::numeric_limits<std::int64_t>::max(),
+                             std::numeric_limits<std::int64_t>::min()})
+    {
+        Decimal value = Decimal::fromRaw(raw);
+        EXPECT_EQ(parse(format(value)), value) << raw;
+    }
+}
@@ -0,0 +1,171 @@
+#include "utils/FlatIdMap.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    struct Item
+    {
+        explicit Item(std::string id) : id(std::move(id)) {}
+        const std::string &getId() const { return id; }
+        std::string id;
+    };
+
+    template <std::size_t N>
+    std::set<std::string> idsOf(const FlatIdMap<Item, N> &map)
+    {
+        std::set<std::string> ids;
+        for (const auto &item : map)
+        {
+            EXPECT_TRUE(ids.insert(item->getId()).second) << "visited twice: " << item->getId();
+        }
+        return ids;
+    }
+
+    // Every expected ID is found, iteration visits exactly those, and the
+    // size agrees
+    template <std::size_t N>
+    void expectHolds(const FlatIdMap<Item, N> &map, const std::set<std::string> &expected)
+    {
+        EXPECT_EQ(map.size(), expected.size());
+        EXPECT_EQ(map.empty(), expected.empty());
+        for (const auto &id : expected)
+        {
+            auto item = map.get(id);
+            ASSERT_TRUE(item) << id;
+            EXPECT_EQ(item->getId(), id);
+        }
+        EXPECT_EQ(idsOf(map), expected);
+    }
+}
+
+TEST(FlatIdMapTest, InlineEntriesInsertFindAndErase)
+{
+    FlatIdMap<Item, 2> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.begin(), map.end());
+    EXPECT_FALSE(map.get("A"));
+
+    EXPECT_TRUE(map.insert(std::make_shared<Item>("A")));
+    EXPECT_TRUE(map.insert(std::make_shared<Item>("B")));
+    EXPECT_FALSE(map.insert(std::make_shared<Item>("A")));
+    expectHolds(map, {"A", "B"});
+
+    EXPECT_TRUE(map.erase("A"));
+    EXPECT_FALSE(map.erase("A"));
+    EXPECT_FALSE(map.contains("A"));
+    expectHolds(map, {"B"});
+}
+
+TEST(FlatIdMapTest, InsertKeepsTheFirstObjectWithAnId)
+{
+    FlatIdMap<Item, 2> map;
+    auto first = std::make_shared<Item>("A");
+    map.insert(first);
+    map.insert(std::make_shared<Item>("A"));
+    EXPECT_EQ(map.get("A"), first);
+}
+
+TEST(FlatIdMapTest, SpillsIntoTheTableAndKeepsEveryEntry)
+{
+    FlatIdMap<Item, 2> map;
+    std::set<std::string> expected;
+    for (int i = 0; i < 500; ++i)
+    {
+        std::string id = "ID" + std::to_string(i);
+        ASSERT_TRUE(map.insert(std::make_shared<Item>(id)));
+        expected.insert(id);
+        if (i < 20 || i % 97 == 0)
+        {
+            expectHolds(map, expected);
+        }
+    }
+    expectHolds(map, expected);
+    EXPECT_FALSE(map.insert(std::make_shared<Item>("ID250")));
+    EXPECT_FALSE(map.contains("ID500"));
+}
+
+// Erasing from the middle of a probe run must shift later entries back so
+// they stay reachable; checks every survivor after each erase
+TEST(FlatIdMapTest, EraseKeepsLaterEntriesOfTheProbeRunReachable)
+{
+    FlatIdMap<Item, 2> map;
+    std::set<std::string> expected;
+    for (int i = 0; i < 96; ++i)
+    {
+        std::string id = std::to_string(i * 7919);
+        map.insert(std::make_shared<Item>(id));
+        expected.insert(id);
+    }
+
+    std::vector<std::string> order(expected.begin(), expected.end());
+    std::mt19937 rng(7);
+    std::shuffle(order.begin(), order.end(), rng);
+    for (const auto &id : order)
+    {
+        ASSERT_TRUE(map.erase(id)) << id;
+        expected.erase(id);
+        EXPECT_FALSE(map.contains(id));
+        expectHolds(map, expected);
+    }
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(FlatIdMapTest, RandomInsertsAndErasesMatchASet)
+{
+    FlatIdMap<Item, 4> map;
+    std::set<std::string> expected;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> key(0, 199);
+    std::bernoulli_distribution inserting(0.6);
+    for (int step = 0; step < 20000; ++step)
+    {
+        std::string id = "K" + std::to_string(key(rng));
+        if (inserting(rng))
+        {
+            ASSERT_EQ(map.insert(std::make_shared<Item>(id)), expected.insert(id).second) << step;
+        }
+        else
+        {
+            ASSERT_EQ(map.erase(id), expected.erase(id) == 1) << step;
+        }
+        ASSERT_EQ(map.size(), expected.size()) << step;
+        if (step % 500 == 0)
+        {
+            expectHolds(map, expected);
+        }
+    }
+    expectHolds(map, expected);
+}
+
+TEST(FlatIdMapTest, CopiesAndMovesHoldTheSameObjects)
+{
+    FlatIdMap<Item, 2> map;
+    for (int i = 0; i < 10; ++i)
+    {
+        map.insert(std::make_shared<Item>(std::to_string(i)));
+    }
+    auto shared = map.get("3");
+
+    FlatIdMap<Item, 2> copy(map);
+    EXPECT_EQ(idsOf(copy), idsOf(map));
+    EXPECT_EQ(copy.get("3"), shared);
+    copy.erase("3");
+    EXPECT_TRUE(map.contains("3"));
+
+    FlatIdMap<Item, 2> moved(std::move(copy));
+    EXPECT_EQ(moved.size(), 9u);
+    EXPECT_FALSE(moved.contains("3"));
+
+    FlatIdMap<Item, 2> assigned;
+    assigned.insert(std::make_shared<Item>("old"));
+    assigned = map;
+    EXPECT_EQ(idsOf(assigned), idsOf(map));
+    EXPECT_FALSE(assigned.contains("old"));
+}
@@ -0,0 +1,243 @@
+#include "accounting/Journal.h"
+#include "accounting/JournalLog.h"
+#include "accounting/Ledger.h"
+#include "utils/Crc32.h"
+#include "TempFileTest.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace market::accounting;
+
+namespace
+{
+    class JournalLogTest : public TempFileTest
+    {
+    protected:
+        JournalLogTest() : TempFileTest(".log") {}
+
+        static std::shared_ptr<JournalEntry> makeEntry(int amount)
+        {
+            return JournalEntry::create("TRX" + std::to_string(amount),
+                                        {{Symbol("CASH"), EntryType::DEBIT, Decimal(amount), "in"},
+                                         {Symbol("SALES"), EntryType::CREDIT, Decimal(amount), "out"}},
+                                        "Sale");
+        }
+
+        // Writes count entries, returning them and the file size after each;
+        // sizes[0] is the empty log
+        std::vector<std::shared_ptr<JournalEntry>> writeEntries(int count, std::vector<std::uintmax_t> &sizes)
+        {
+            std::vector<std::shared_ptr<JournalEntry>> written;
+            auto log = JournalLog::create(path_);
+            sizes.push_back(std::filesystem::file_size(path_));
+            for (int i = 1; i <= count; ++i)
+            {
+                written.push_back(makeEntry(i));
+                log->write(*written.back());
+                sizes.push_back(std::filesystem::file_size(path_));
+            }
+            return written;
+        }
+
+        std::vector<std::shared_ptr<JournalEntry>> reopen(std::shared_ptr<JournalLog> &log)
+        {
+            std::vector<std::shared_ptr<JournalEntry>> replayed;
+            log = JournalLog::create(path_, [&](std::shared_ptr<JournalEntry> entry)
+                                     { replayed.push_back(std::move(entry)); });
+            return replayed;
+        }
+
+        static std::string littleEndian(std::uint32_t value)
+        {
+            std::string bytes(4, '\0');
+            for (int i = 0; i < 4; ++i)
+            {
+                bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+            return bytes;
+        }
+
+        static void expectSameEntry(const JournalEntry &actual, const JournalEntry &expected)
+        {
+            EXPECT_EQ(actual.getNumericId(), expected.getNumericId());
+            EXPECT_EQ(actual.getTransactionId(), expected.getTransactionId());
+            EXPECT_EQ(actual.getDescription(), expected.getDescription());
+            EXPECT_EQ(actual.getTimestamp(), expected.getTimestamp());
+            ASSERT_EQ(actual.getEntries().size(), expected.getEntries().size());
+            for (std::size_t i = 0; i < expected.getEntries().size(); ++i)
+            {
+                EXPECT_EQ(actual.getEntries()[i].accountId, expected.getEntries()[i].accountId);
+                EXPECT_EQ(actual.getEntries()[i].type, expected.getEntries()[i].type);
+                EXPECT_EQ(actual.getEntries()[i].amount, expected.getEntries()[i].amount);
+                EXPECT_EQ(actual.getEntries()[i].description, expected.getEntries()[i].description);
+            }
+        }
+
+    };
+}
+
+TEST_F(JournalLogTest, ReplaysEveryEntryWritten)
+{
+    std::vector<std::uintmax_t> sizes;
+    auto written = writeEntries(5, sizes);
+
+    std::shared_ptr<JournalLog> log;
+    auto replayed = reopen(log);
+    EXPECT_EQ(log->getReplayedCount(), written.size());
+    EXPECT_EQ(log->getTruncatedBytes(), 0u);
+    ASSERT_EQ(replayed.size(), written.size());
+    for (std::size_t i = 0; i < written.size(); ++i)
+    {
+        expectSameEntry(*replayed[i], *written[i]);
+    }
+}
+
+TEST_F(JournalLogTest, CutsOffATornLastRecord)
+{
+    std::vector<std::uintmax_t> sizes;
+    auto written = writeEntries(3, sizes);
+    // A crash partway through writing the third record
+    std::filesystem::resize_file(path_, sizes[3] - 5);
+
+    std::shared_ptr<JournalLog> log;
+    auto replayed = reopen(log);
+    ASSERT_EQ(replayed.size(), 2u);
+    expectSameEntry(*replayed[1], *written[1]);
+    EXPECT_EQ(log->getTruncatedBytes(), sizes[3] - 5 - sizes[2]);
+    EXPECT_EQ(std::filesystem::file_size(path_), sizes[2]);
+
+    // New records go after the surviving ones
+    auto next = makeEntry(10);
+    log->write(*next);
+    log.reset();
+    replayed = reopen(log);
+    ASSERT_EQ(replayed.size(), 3u);
+    expectSameEntry(*replayed[2], *next);
+}
+
+TEST_F(JournalLogTest, CutsOffALastRecordWithABadChecksum)
+{
+    std::vector<std::uintmax_t> sizes;
+    writeEntries(3, sizes);
+    flipByte(sizes[2] + 10);
+
+    std::shared_ptr<JournalLog> log;
+    auto replayed = reopen(log);
+    EXPECT_EQ(replayed.size(), 2u);
+    EXPECT_EQ(log->getTruncatedBytes(), sizes[3] - sizes[2]);
+    EXPECT_EQ(std::filesystem::file_size(path_), sizes[2]);
+}
+
+TEST_F(JournalLogTest, RefusesALogCorruptedBeforeItsLastRecord)
+{
+    std::vector<std::uintmax_t> sizes;
+    writeEntries(3, sizes);
+    flipByte(sizes[1] + 10);
+    std::string damaged = readFile();
+
+    EXPECT_THROW(JournalLog::create(path_), std::runtime_error);
+    // Nothing is truncated, so the records after the damage can be salvaged
+    EXPECT_EQ(readFile(), damaged);
+}
+
+TEST_F(JournalLogTest, RefusesALogWhoseMiddleLengthRunsPastTheEnd)
+{
+    std::vector<std::uintmax_t> sizes;
+    writeEntries(3, sizes);
+    // The second record's length now points past the end of the file, but
+    // the third record is still complete after it
+    writeAt(sizes[1], littleEndian(0x7FFFFFFF));
+    std::string damaged = readFile();
+
+    EXPECT_THROW(JournalLog::create(path_), std::runtime_error);
+    EXPECT_EQ(readFile(), damaged);
+}
+
+TEST_F(JournalLogTest, CutsOffAZeroFilledTail)
+{
+    std::vector<std::uintmax_t> sizes;
+    auto written = writeEntries(2, sizes);
+    // Zeroes read as empty records whose checksums match
+    writeAt(sizes[2], std::string(64, '\0'));
+
+    std::shared_ptr<JournalLog> log;
+    auto replayed = reopen(log);
+    ASSERT_EQ(replayed.size(), 2u);
+    expectSameEntry(*replayed[1], *written[1]);
+    EXPECT_EQ(log->getTruncatedBytes(), 64u);
+    EXPECT_EQ(std::filesystem::file_size(path_), sizes[2]);
+}
+
+TEST_F(JournalLogTest, CutsOffALastRecordThatDoesNotDecode)
+{
+    std::vector<std::uintmax_t> sizes;
+    writeEntries(2, sizes);
+    std::string payload = "\x08";
+    writeAt(sizes[2], littleEndian(static_cast<std::uint32_t>(payload.size())) +
+                          littleEndian(Crc32::compute(payload.data(), payload.size())) + payload);
+
+    std::shared_ptr<JournalLog> log;
+    auto replayed = reopen(log);
+    EXPECT_EQ(replayed.size(), 2u);
+    EXPECT_EQ(std::filesystem::file_size(path_), sizes[2]);
+}
+
+TEST_F(JournalLogTest, RefusesARecordThatDoesNotDecodeBeforeTheLast)
+{
+    std::vector<std::uintmax_t> sizes;
+    writeEntries(2, sizes);
+    std::string good = readFile().substr(sizes[1]);
+    std::string payload = "\x08";
+    writeAt(sizes[1], littleEndian(static_cast<std::uint32_t>(payload.size())) +
+                          littleEndian(Crc32::compute(payload.data(), payload.size())) + payload + good);
+
+    EXPECT_THROW(JournalLog::create(path_), std::runtime_error);
+}
+
+TEST_F(JournalLogTest, RefusesAFileThatIsNotAJournalLog)
+{
+    {
+        std::ofstream out(path_, std::ios::binary);
+        out << "not a journal log";
+    }
+    EXPECT_THROW(JournalLog::create(path_), std::runtime_error);
+}
+
+TEST_F(JournalLogTest, RecoverRebuildsTheJournalAndLedger)
+{
+    std::vector<std::shared_ptr<JournalEntry>> written;
+    {
+        auto journal = Journal::create("General");
+        auto log = JournalLog::recover(path_, *journal);
+        EXPECT_EQ(log->getReplayedCount(), 0u);
+        for (int i = 1; i <= 4; ++i)
+        {
+            written.push_back(makeEntry(i));
+            journal->addEntry(written.back());
+        }
+    }
+
+    auto expected = Ledger::create("Expected");
+    for (const auto &entry : written)
+    {
+        expected->post(*entry);
+    }
+
+    auto journal = Journal::create("General");
+    auto ledger = Ledger::create("General");
+    auto log = JournalLog::recover(path_, *journal, ledger.get());
+    EXPECT_EQ(journal->getLog(), log);
+    ASSERT_EQ(journal->getEntries().size(), written.size());
+    for (std::size_t i = 0; i < written.size(); ++i)
+    {
+        expectSameEntry(*journal->getEntries()[i], *written[i]);
+    }
+    EXPECT_EQ(ledger->getBalance("CASH"), expected->getBalance("CASH"));
+    EXPECT_EQ(ledger->getBalance("SALES"), expected->getBalance("SALES"));
+    EXPECT_NE(ledger->getBalance("CASH"), Decimal());
+}
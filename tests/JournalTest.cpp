@@ -0,0 +1,104 @@
+#include "accounting/Journal.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace market::accounting;
+
+namespace
+{
+    using Clock = std::chrono::system_clock;
+
+    class JournalTest : public ::testing::Test
+    {
+    protected:
+        // Adds one balanced entry per second offset, in the order given,
+        // each with its offset as the transaction ID
+        void add(std::initializer_list<int> seconds)
+        {
+            for (int second : seconds)
+            {
+                journal_->addEntry(JournalEntry::restore(++lastId_, std::to_string(second),
+                                                         {{Symbol("CASH"), EntryType::DEBIT, Decimal(1), ""},
+                                                          {Symbol("SALES"), EntryType::CREDIT, Decimal(1), ""}},
+                                                         "", at(second)));
+            }
+        }
+
+        static Clock::time_point at(int second)
+        {
+            return Clock::time_point(std::chrono::hours(24 * 365 * 30)) + std::chrono::seconds(second);
+        }
+
+        static std::vector<std::string> transactionIds(const Journal::EntryRange &range)
+        {
+            std::vector<std::string> ids;
+            for (const JournalEntry &entry : range)
+            {
+                ids.emplace_back(entry.getTransactionId());
+            }
+            EXPECT_EQ(ids.size(), range.size());
+            return ids;
+        }
+
+        std::shared_ptr<Journal> journal_ = Journal::create("General");
+        std::uint64_t lastId_ = 1000000;
+    };
+
+    using Ids = std::vector<std::string>;
+}
+
+TEST_F(JournalTest, DateRangeOfEntriesAddedInOrder)
+{
+    add({1, 2, 2, 3, 5, 8});
+
+    EXPECT_EQ(transactionIds(journal_->getEntryRangeByDateRange(at(2), at(5))), (Ids{"2", "2", "3", "5"}));
+    EXPECT_EQ(transactionIds(journal_->getEntryRangeByDateRange(at(0), at(100))).size(), 6u);
+    EXPECT_TRUE(journal_->getEntryRangeByDateRange(at(6), at(7)).empty());
+    EXPECT_TRUE(journal_->getEntryRangeByDateRange(at(5), at(2)).empty());
+}
+
+TEST_F(JournalTest, DateRangeOfEntriesAddedOutOfOrder)
+{
+    add({1, 5, 3, 8, 2, 5});
+
+    // Timestamp order; the two at 5 in the order they were added
+    auto range = journal_->getEntryRangeByDateRange(at(2), at(5));
+    EXPECT_EQ(transactionIds(range), (Ids{"2", "3", "5", "5"}));
+    std::vector<const JournalEntry *> added;
+    for (const auto &entry : journal_->getEntries())
+    {
+        added.push_back(entry.get());
+    }
+    auto it = range.begin();
+    std::advance(it, 2);
+    EXPECT_EQ(&*it, added[1]);
+    EXPECT_EQ(&*++it, added[5]);
+
+    // Agrees with the copying query, whatever the order
+    EXPECT_EQ(journal_->getEntryRangeByDateRange(at(0), at(100)).size(),
+              journal_->getEntriesByDateRange(at(0), at(100)).size());
+    EXPECT_TRUE(journal_->getEntryRangeByDateRange(at(6), at(7)).empty());
+}
+
+TEST_F(JournalTest, ClosingAPeriodStartsOrderedAgain)
+{
+    add({3, 1});
+    journal_->closePeriod();
+    add({4, 6});
+
+    EXPECT_EQ(transactionIds(journal_->getEntryRangeByDateRange(at(0), at(5))), (Ids{"4"}));
+}
+
+TEST_F(JournalTest, AccountAndTransactionRanges)
+{
+    add({1, 2, 1});
+
+    EXPECT_EQ(journal_->getEntryRangeByAccount("CASH").size(), 3u);
+    EXPECT_TRUE(journal_->getEntryRangeByAccount("NONE").empty());
+    EXPECT_EQ(transactionIds(journal_->getEntryRangeByTransaction("1")), (Ids{"1", "1"}));
+}
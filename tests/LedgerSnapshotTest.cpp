@@ -0,0 +1,145 @@
+#include "accounting/Ledger.h"
+#include "accounting/LedgerSnapshotFile.h"
+#include "TempFileTest.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace market::accounting;
+
+namespace
+{
+    class LedgerSnapshotTest : public TempFileTest
+    {
+    protected:
+        LedgerSnapshotTest() : TempFileTest(".snap", {".tmp"}) {}
+
+        void SetUp() override
+        {
+            TempFileTest::SetUp();
+            ledger_ = Ledger::create("General");
+            for (int i = 1; i <= 40; ++i)
+            {
+                auto account = Symbol("ACC" + std::to_string(i % 4));
+                entries_.push_back(JournalEntry::create("TRX" + std::to_string(i),
+                                                        {{account, EntryType::DEBIT, Decimal(i), ""},
+                                                         {Symbol("CASH"), EntryType::CREDIT, Decimal(i), ""}}));
+            }
+            ledger_->postBatch(entries_);
+        }
+
+        static void expectSameEntries(const Ledger &actual, const Ledger &expected, std::string_view accountId)
+        {
+            auto actualEntries = actual.getEntries(accountId);
+            auto expectedEntries = expected.getEntries(accountId);
+            ASSERT_EQ(actualEntries.size(), expectedEntries.size()) << accountId;
+            for (std::size_t i = 0; i < expectedEntries.size(); ++i)
+            {
+                EXPECT_EQ(actualEntries[i].getNumericId(), expectedEntries[i].getNumericId());
+                EXPECT_EQ(actualEntries[i].getAccountId(), expectedEntries[i].getAccountId());
+                EXPECT_EQ(actualEntries[i].getJournalEntryId(), expectedEntries[i].getJournalEntryId());
+                EXPECT_EQ(actualEntries[i].getType(), expectedEntries[i].getType());
+                EXPECT_EQ(actualEntries[i].getAmount(), expectedEntries[i].getAmount());
+                EXPECT_EQ(actualEntries[i].getTimestamp(), expectedEntries[i].getTimestamp());
+            }
+        }
+
+        std::shared_ptr<Ledger> ledger_;
+        std::vector<std::shared_ptr<JournalEntry>> entries_;
+    };
+}
+
+TEST_F(LedgerSnapshotTest, OpenedLedgerMatchesTheOneWritten)
+{
+    ledger_->writeSnapshot(path_);
+    auto opened = Ledger::openSnapshot(path_);
+
+    EXPECT_EQ(opened->getName(), "General");
+    for (const char *account : {"ACC0", "ACC1", "ACC2", "ACC3", "CASH"})
+    {
+        EXPECT_EQ(opened->getBalance(account), ledger_->getBalance(account)) << account;
+        expectSameEntries(*opened, *ledger_, account);
+    }
+    auto asOf = entries_[20]->getTimestamp();
+    EXPECT_EQ(opened->getBalance("CASH", asOf), ledger_->getBalance("CASH", asOf));
+    EXPECT_EQ(opened->snapshot().getSequence(), ledger_->snapshot().getSequence());
+}
+
+TEST_F(LedgerSnapshotTest, FileHoldsEveryAccountsColumns)
+{
+    ledger_->writeSnapshot(path_);
+    auto file = LedgerSnapshotFile::open(path_);
+
+    EXPECT_EQ(file->getVersion(), 2u);
+    EXPECT_EQ(file->getLedgerName(), "General");
+    ASSERT_EQ(file->getAccountCount(), 5u);
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < file->getAccountCount(); ++i)
+    {
+        auto account = file->getAccount(i);
+        auto expected = ledger_->getEntries(account.accountId);
+        ASSERT_EQ(account.ids.size(), expected.size()) << account.accountId;
+        EXPECT_EQ(account.amounts.size(), expected.size());
+        EXPECT_EQ(account.timestamps.size(), expected.size());
+        EXPECT_EQ(account.cumulative.size(), expected.size());
+        ASSERT_EQ(account.journalEntries.size(), expected.size());
+        for (std::size_t row = 0; row < expected.size(); ++row)
+        {
+            EXPECT_EQ(account.ids[row], expected[row].getNumericId());
+            EXPECT_EQ(account.journalEntries[row], expected[row].getJournalEntryId());
+        }
+        EXPECT_EQ(Decimal::fromRaw(account.cumulative[expected.size() - 1]), ledger_->getBalance(account.accountId));
+        rows += expected.size();
+    }
+    EXPECT_EQ(rows, 2 * entries_.size());
+}
+
+TEST_F(LedgerSnapshotTest, PostingToAnOpenedLedgerContinuesAfterTheSnapshot)
+{
+    ledger_->writeSnapshot(path_);
+    auto opened = Ledger::openSnapshot(path_);
+    auto before = opened->getEntries("ACC1");
+
+    auto next = JournalEntry::create("TRX-next", {{Symbol("ACC1"), EntryType::DEBIT, Decimal(7), ""},
+                                                  {Symbol("NEW"), EntryType::CREDIT, Decimal(7), ""}});
+    opened->post(*next);
+    ledger_->post(*next);
+
+    auto after = opened->getEntries("ACC1");
+    ASSERT_EQ(after.size(), before.size() + 1);
+    EXPECT_GT(after.back().getNumericId(), before.back().getNumericId());
+    EXPECT_EQ(after.back().getJournalEntryId(), next->getNumericId());
+    EXPECT_EQ(opened->getBalance("ACC1"), ledger_->getBalance("ACC1"));
+    EXPECT_EQ(opened->getBalance("NEW"), ledger_->getBalance("NEW"));
+    // The file itself is unchanged
+    EXPECT_EQ(Ledger::openSnapshot(path_)->getEntries("ACC1").size(), before.size());
+}
+
+TEST_F(LedgerSnapshotTest, EmptyLedgerRoundTrips)
+{
+    Ledger::create("Empty")->writeSnapshot(path_);
+    auto opened = Ledger::openSnapshot(path_);
+    EXPECT_EQ(opened->getName(), "Empty");
+    EXPECT_EQ(opened->getBalance("CASH"), Decimal());
+    EXPECT_TRUE(opened->getEntries("CASH").empty());
+}
+
+TEST_F(LedgerSnapshotTest, OpenRejectsDamagedFiles)
+{
+    ledger_->writeSnapshot(path_);
+    auto size = std::filesystem::file_size(path_);
+    std::filesystem::resize_file(path_, size / 2);
+    EXPECT_THROW(LedgerSnapshotFile::open(path_), std::runtime_error);
+
+    {
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        out << std::string(256, 'x');
+    }
+    EXPECT_THROW(LedgerSnapshotFile::open(path_), std::runtime_error);
+    EXPECT_THROW(LedgerSnapshotFile::open(path_ + ".missing"), std::runtime_error);
+}
@@ -0,0 +1,109 @@
+#include "database/LocalRepository.h"
+#include "TempFileTest.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace market;
+
+namespace
+{
+    class LocalRepositoryTest : public TempFileTest
+    {
+    protected:
+        LocalRepositoryTest() : TempFileTest(".store", {".compact"}) {}
+    };
+}
+
+TEST_F(LocalRepositoryTest, AccountComesBackWithEverythingItHolds)
+{
+    auto buyer = core::Account::create("Buyer", core::Account::AccountType::ASSET);
+    auto seller = core::Account::create("Seller", core::Account::AccountType::LIABILITY);
+    auto wallet = financial::Wallet::restore("WLT-test-1", "USD", Decimal(250));
+    auto asset = financial::Asset::create("Bond", Decimal(1000));
+    auto contract = contracts::Contract::create("Sale", buyer, seller);
+    contract->addTerm("price", "1000");
+    contract->setState(contracts::Contract::State::ACTIVE);
+    buyer->addWallet(wallet);
+    buyer->addAsset(asset);
+    buyer->addContract(contract);
+    seller->addContract(contract);
+
+    {
+        auto store = LocalStore::open(path_);
+        LocalWalletRepository::create(store)->save(wallet);
+        LocalAssetRepository::create(store)->save(asset);
+        LocalContractRepository::create(store)->save(contract);
+        auto accounts = LocalAccountRepository::create(store);
+        accounts->save(buyer);
+        accounts->save(seller);
+    }
+
+    auto store = LocalStore::open(path_);
+    auto loaded = LocalAccountRepository::create(store)->findById(buyer->getId());
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->getName(), "Buyer");
+    EXPECT_EQ(loaded->getType(), core::Account::AccountType::ASSET);
+
+    auto loadedWallet = loaded->getWallet(wallet->getId());
+    ASSERT_TRUE(loadedWallet);
+    EXPECT_EQ(loadedWallet->getCurrency(), "USD");
+    EXPECT_EQ(loadedWallet->getNetWorth(), Decimal(250));
+
+    auto loadedAsset = loaded->getAsset(asset->getId());
+    ASSERT_TRUE(loadedAsset);
+    EXPECT_EQ(loadedAsset->getType(), "Bond");
+    EXPECT_EQ(loadedAsset->getValue(), Decimal(1000));
+
+    // The contract refers back to the account holding it: one instance, not
+    // a second copy decoded for the reference
+    auto loadedContract = loaded->getContract(contract->getId());
+    ASSERT_TRUE(loadedContract);
+    EXPECT_EQ(loadedContract->getParty1(), loaded);
+    ASSERT_TRUE(loadedContract->getParty2());
+    EXPECT_EQ(loadedContract->getParty2()->getId(), seller->getId());
+    EXPECT_EQ(loadedContract->getParty2()->getContract(contract->getId()), loadedContract);
+    EXPECT_EQ(loadedContract->getState(), contracts::Contract::State::ACTIVE);
+    EXPECT_EQ(loadedContract->getTerm("price"), "1000");
+}
+
+TEST_F(LocalRepositoryTest, FindAllSharesObjectsReferredToTwice)
+{
+    auto store = LocalStore::open(path_);
+    auto accounts = LocalAccountRepository::create(store);
+    auto contracts = LocalContractRepository::create(store);
+
+    auto first = core::Account::create("First", core::Account::AccountType::ASSET);
+    auto second = core::Account::create("Second", core::Account::AccountType::ASSET);
+    auto contract = contracts::Contract::create("Swap", first, second);
+    first->addContract(contract);
+    second->addContract(contract);
+    contracts->save(contract);
+    accounts->save(first);
+    accounts->save(second);
+
+    auto all = accounts->findAll();
+    ASSERT_EQ(all.size(), 2u);
+    auto a = all[0]->getContract(contract->getId());
+    auto b = all[1]->getContract(contract->getId());
+    ASSERT_TRUE(a);
+    EXPECT_EQ(a, b);
+}
+
+TEST_F(LocalRepositoryTest, RemoveAndMissingReferences)
+{
+    auto store = LocalStore::open(path_);
+    auto accounts = LocalAccountRepository::create(store);
+
+    auto account = core::Account::create("Holder", core::Account::AccountType::ASSET);
+    account->addWallet(financial::Wallet::restore("WLT-test-unsaved", "EUR", Decimal(1)));
+    // The wallet was never saved, so the account cannot be rebuilt
+    accounts->save(account);
+    EXPECT_THROW(accounts->findById(account->getId()), std::runtime_error);
+
+    accounts->remove(account->getId());
+    EXPECT_FALSE(accounts->findById(account->getId()));
+    EXPECT_TRUE(accounts->findAll().empty());
+    EXPECT_THROW(accounts->save(nullptr), std::invalid_argument);
+}
@@ -0,0 +1,150 @@
+#include "utils/LocalStore.h"
+#include "TempFileTest.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    class LocalStoreTest : public TempFileTest
+    {
+    protected:
+        LocalStoreTest() : TempFileTest(".store", {".compact"}) {}
+
+        // Puts key=value for each pair, returning the file size after each;
+        // sizes[0] is the empty store
+        std::vector<std::uintmax_t> putAll(const std::vector<std::pair<std::string, std::string>> &pairs)
+        {
+            std::vector<std::uintmax_t> sizes;
+            auto store = LocalStore::open(path_);
+            sizes.push_back(std::filesystem::file_size(path_));
+            for (const auto &[key, value] : pairs)
+            {
+                store->put(key, value);
+                sizes.push_back(std::filesystem::file_size(path_));
+            }
+            return sizes;
+        }
+
+        static std::string valueOf(const LocalStore &store, const std::string &key)
+        {
+            std::string value;
+            EXPECT_TRUE(store.get(key, value)) << key;
+            return value;
+        }
+    };
+}
+
+TEST_F(LocalStoreTest, ReopenRebuildsTheIndex)
+{
+    putAll({{"a", "1"}, {"b", "2"}, {"a", "3"}});
+
+    auto store = LocalStore::open(path_);
+    EXPECT_EQ(store->getReplayedCount(), 3u);
+    EXPECT_EQ(store->getTruncatedBytes(), 0u);
+    EXPECT_EQ(store->size(), 2u);
+    EXPECT_EQ(valueOf(*store, "a"), "3");
+    EXPECT_EQ(valueOf(*store, "b"), "2");
+}
+
+TEST_F(LocalStoreTest, RemovalsSurviveAReopen)
+{
+    {
+        auto store = LocalStore::open(path_);
+        store->put("kept", "1");
+        store->put("gone", "2");
+        EXPECT_TRUE(store->remove("gone"));
+        EXPECT_FALSE(store->remove("never"));
+    }
+
+    auto store = LocalStore::open(path_);
+    EXPECT_EQ(store->size(), 1u);
+    EXPECT_TRUE(store->contains("kept"));
+    EXPECT_FALSE(store->contains("gone"));
+}
+
+TEST_F(LocalStoreTest, CutsOffATornTail)
+{
+    auto sizes = putAll({{"a", "first"}, {"b", "second"}, {"c", "third"}});
+    // A crash partway through writing the third record
+    std::filesystem::resize_file(path_, sizes[3] - 3);
+
+    auto store = LocalStore::open(path_);
+    EXPECT_EQ(store->size(), 2u);
+    EXPECT_FALSE(store->contains("c"));
+    EXPECT_EQ(store->getTruncatedBytes(), sizes[3] - 3 - sizes[2]);
+    EXPECT_EQ(std::filesystem::file_size(path_), sizes[2]);
+
+    // New records go after the surviving ones
+    store->put("c", "again");
+    store.reset();
+    store = LocalStore::open(path_);
+    EXPECT_EQ(valueOf(*store, "c"), "again");
+    EXPECT_EQ(valueOf(*store, "b"), "second");
+}
+
+TEST_F(LocalStoreTest, RefusesABadChecksumBeforeTheLastRecord)
+{
+    auto sizes = putAll({{"a", "first"}, {"b", "second"}, {"c", "third"}});
+    flipByte(sizes[1] - 2);
+    std::string damaged = readFile();
+
+    EXPECT_THROW(LocalStore::open(path_), std::runtime_error);
+    // Nothing is truncated, so the records after the damage can be salvaged
+    EXPECT_EQ(readFile(), damaged);
+}
+
+TEST_F(LocalStoreTest, CompactKeepsEveryLiveValueAndShrinksTheFile)
+{
+    LocalStoreOptions options;
+    options.compactThreshold = UINT64_MAX;
+    auto store = LocalStore::open(path_, options);
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int key = 0; key < 50; ++key)
+        {
+            store->put("key" + std::to_string(key), "value" + std::to_string(round * 100 + key));
+        }
+    }
+    store->remove("key0");
+    std::uintmax_t before = std::filesystem::file_size(path_);
+    ASSERT_GT(store->getDeadBytes(), 0u);
+
+    store->compact();
+    EXPECT_LT(std::filesystem::file_size(path_), before);
+    EXPECT_EQ(store->getDeadBytes(), 0u);
+    EXPECT_FALSE(std::filesystem::exists(path_ + ".compact"));
+
+    auto check = [](const LocalStore &compacted)
+    {
+        EXPECT_EQ(compacted.size(), 49u);
+        EXPECT_FALSE(compacted.contains("key0"));
+        for (int key = 1; key < 50; ++key)
+        {
+            EXPECT_EQ(valueOf(compacted, "key" + std::to_string(key)), "value" + std::to_string(900 + key));
+        }
+    };
+    check(*store);
+    store.reset();
+    store = LocalStore::open(path_);
+    check(*store);
+}
+
+TEST_F(LocalStoreTest, DiscardsALeftoverCompactFile)
+{
+    putAll({{"a", "1"}});
+    {
+        std::ofstream out(path_ + ".compact", std::ios::binary);
+        out << "half a compaction";
+    }
+
+    auto store = LocalStore::open(path_);
+    EXPECT_FALSE(std::filesystem::exists(path_ + ".compact"));
+    EXPECT_EQ(valueOf(*store, "a"), "1");
+}
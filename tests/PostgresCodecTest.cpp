@@ -0,0 +1,124 @@
+#include "database/PostgresCodec.h"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(Decimal::SCALE == 8, "the encodings below assume 8 fractional digits");
+
+namespace
+{
+    std::string bytesOf(const PostgresNumeric &numeric)
+    {
+        std::string bytes(reinterpret_cast<const char *>(numeric.header), sizeof(numeric.header));
+        bytes.append(reinterpret_cast<const char *>(numeric.digits), numeric.size * 2);
+        return bytes;
+    }
+
+    // Binary numeric from host-order header fields and digits
+    std::string numeric(std::int16_t weight, std::uint16_t sign, std::initializer_list<std::uint16_t> digits)
+    {
+        std::vector<std::uint16_t> words{static_cast<std::uint16_t>(digits.size()),
+                                         static_cast<std::uint16_t>(weight), sign, 8};
+        words.insert(words.end(), digits);
+        std::string bytes;
+        for (std::uint16_t word : words)
+        {
+            std::uint16_t network = htons(word);
+            bytes.append(reinterpret_cast<const char *>(&network), 2);
+        }
+        return bytes;
+    }
+
+    Decimal decode(const std::string &bytes)
+    {
+        return fromNumeric(bytes.data(), static_cast<int>(bytes.size()));
+    }
+
+    Decimal roundTrip(const Decimal &value)
+    {
+        PostgresNumeric encoded = toNumeric(value);
+        EXPECT_EQ(encoded.byteSize(), static_cast<int>(bytesOf(encoded).size()));
+        return decode(bytesOf(encoded));
+    }
+}
+
+TEST(PostgresCodecTest, EncodesTheDigitsTheServerExpects)
+{
+    EXPECT_EQ(bytesOf(toNumeric(Decimal::fromRaw(0))), numeric(0, PostgresNumeric::POSITIVE, {}));
+    EXPECT_EQ(bytesOf(toNumeric(Decimal(12345))), numeric(1, PostgresNumeric::POSITIVE, {1, 2345}));
+    EXPECT_EQ(bytesOf(toNumeric(Decimal::fromRaw(-150000000))), numeric(0, PostgresNumeric::NEGATIVE, {1, 5000}));
+    // 0.00000001: the only digit sits in the second group after the point
+    EXPECT_EQ(bytesOf(toNumeric(Decimal::fromRaw(1))), numeric(-2, PostgresNumeric::POSITIVE, {1}));
+    // 10000.0001: zero groups in the middle are kept
+    EXPECT_EQ(bytesOf(toNumeric(Decimal::fromRaw(1000000010000))), numeric(1, PostgresNumeric::POSITIVE, {1, 0, 1}));
+}
+
+TEST(PostgresCodecTest, RoundTripsEveryScaleAndSign)
+{
+    const std::int64_t raws[] = {
+        0,
+        1,
+        -1,
+        99999999,
+        Decimal::ONE,
+        -Decimal::ONE,
+        123456789012345678,
+        -123456789012345678,
+        std::numeric_limits<std::int64_t>::max(),
+        std::numeric_limits<std::int64_t>::min() + 1,
+    };
+    for (std::int64_t raw : raws)
+    {
+        EXPECT_EQ(roundTrip(Decimal::fromRaw(raw)).toRaw(), raw) << raw;
+    }
+    for (std::int64_t raw = 1; raw < std::numeric_limits<std::int64_t>::max() / 10; raw = raw * 10 + 3)
+    {
+        EXPECT_EQ(roundTrip(Decimal::fromRaw(raw)).toRaw(), raw) << raw;
+    }
+}
+
+TEST(PostgresCodecTest, AcceptsZerosBelowTheScale)
+{
+    // 1.5 stored with scale 12, as the server may send it
+    EXPECT_EQ(decode(numeric(0, PostgresNumeric::POSITIVE, {1, 5000, 0, 0})).toRaw(), 150000000);
+    // -0.00000001 with a zero group after it
+    EXPECT_EQ(decode(numeric(-2, PostgresNumeric::NEGATIVE, {1, 0})).toRaw(), -1);
+}
+
+TEST(PostgresCodecTest, RefusesMalformedValues)
+{
+    // Shorter than a header
+    EXPECT_THROW(fromNumeric("\0\0\0", 3), std::runtime_error);
+    // Digit count disagrees with the length
+    std::string truncated = numeric(0, PostgresNumeric::POSITIVE, {1, 2});
+    truncated.pop_back();
+    EXPECT_THROW(decode(truncated), std::runtime_error);
+    // NaN
+    EXPECT_THROW(decode(numeric(0, 0xC000, {})), std::runtime_error);
+    // A base-10000 digit of 10000
+    EXPECT_THROW(decode(numeric(0, PostgresNumeric::POSITIVE, {10000})), std::runtime_error);
+    // 0.000000001 has a ninth decimal place
+    EXPECT_THROW(decode(numeric(-3, PostgresNumeric::POSITIVE, {1000})), std::runtime_error);
+    // 10^20 is past Decimal's range
+    EXPECT_THROW(decode(numeric(5, PostgresNumeric::POSITIVE, {1})), std::overflow_error);
+    EXPECT_THROW(decode(numeric(2, PostgresNumeric::NEGATIVE, {9999, 9999, 9999})), std::overflow_error);
+}
+
+TEST(PostgresCodecTest, CountsMicrosecondsFromTheYear2000)
+{
+    using namespace std::chrono;
+    system_clock::time_point epoch2000 = system_clock::time_point(seconds(946684800));
+    EXPECT_EQ(toPostgresTime(epoch2000), 0);
+    EXPECT_EQ(toPostgresTime(epoch2000 + microseconds(1)), 1);
+    EXPECT_EQ(toPostgresTime(system_clock::time_point()), -946684800LL * 1000000);
+
+    system_clock::time_point now = time_point_cast<microseconds>(system_clock::now());
+    EXPECT_EQ(fromPostgresTime(toPostgresTime(now)), now);
+    EXPECT_EQ(fromPostgresTime(-1), epoch2000 - microseconds(1));
+}
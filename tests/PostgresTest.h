@@ -0,0 +1,60 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <libpq-fe.h>
+#include "database/Database.h"
+
+// Fixture for tests that need a PostgreSQL server. Set MARKET_TEST_PG to
+// "host port dbname user password" naming a scratch database: each test
+// creates the accounts and ledger_entries tables there if they are missing
+// and empties them first. Without it the tests are skipped.
+class PostgresTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const char *settings = std::getenv("MARKET_TEST_PG");
+        if (!settings)
+        {
+            GTEST_SKIP() << "MARKET_TEST_PG is not set";
+        }
+        std::istringstream fields(settings);
+        fields >> host_ >> port_ >> dbname_ >> user_ >> password_;
+
+        execute("CREATE TABLE IF NOT EXISTS accounts (id VARCHAR(12) PRIMARY KEY, name VARCHAR(255) NOT NULL,"
+                " type SMALLINT NOT NULL)");
+        execute("CREATE TABLE IF NOT EXISTS ledger_entries (id BIGINT PRIMARY KEY, account_id VARCHAR(32) NOT NULL,"
+                " journal_entry_id VARCHAR(16) NOT NULL, type SMALLINT NOT NULL, amount DECIMAL(20,8) NOT NULL,"
+                " posted_at TIMESTAMPTZ NOT NULL)");
+        execute("TRUNCATE accounts, ledger_entries");
+    }
+
+    // A new connection, already connected
+    std::unique_ptr<Database> connect() const
+    {
+        auto database = std::make_unique<Database>(host_, port_, dbname_, user_, password_);
+        database->connect();
+        return database;
+    }
+
+    // Runs query on a connection of its own
+    void execute(const char *query) const
+    {
+        std::unique_ptr<PGconn, void (*)(PGconn *)> conn(
+            PQsetdbLogin(host_.c_str(), port_.c_str(), nullptr, nullptr, dbname_.c_str(), user_.c_str(), password_.c_str()),
+            PQfinish);
+        ASSERT_EQ(PQstatus(conn.get()), CONNECTION_OK) << PQerrorMessage(conn.get());
+        std::unique_ptr<PGresult, void (*)(PGresult *)> res(PQexec(conn.get(), query), PQclear);
+        ExecStatusType status = PQresultStatus(res.get());
+        ASSERT_TRUE(status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK) << query << ": " << PQerrorMessage(conn.get());
+    }
+
+    std::string host_;
+    std::string port_;
+    std::string dbname_;
+    std::string user_;
+    std::string password_;
+};
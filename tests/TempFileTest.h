@@ -0,0 +1,72 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Fixture for tests that work on one file: path_ is named after the test,
+// under the test temp directory, with the given suffix. It and path_ plus
+// each of the sibling suffixes (temporary files a writer leaves next to it)
+// are removed before and after every test.
+class TempFileTest : public ::testing::Test
+{
+protected:
+    explicit TempFileTest(std::string suffix, std::initializer_list<std::string> siblings = {})
+        : suffix_(std::move(suffix)), siblings_(siblings)
+    {
+    }
+
+    void SetUp() override
+    {
+        path_ = ::testing::TempDir() + ::testing::UnitTest::GetInstance()->current_test_info()->name() + suffix_;
+        removeFiles();
+    }
+
+    void TearDown() override
+    {
+        removeFiles();
+    }
+
+    std::string readFile() const
+    {
+        std::ifstream in(path_, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void writeAt(std::uintmax_t offset, const std::string &bytes) const
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    void flipByte(std::uintmax_t offset) const
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(offset));
+        char byte = 0;
+        file.get(byte);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.put(static_cast<char>(byte ^ 0x5A));
+    }
+
+    std::string path_;
+
+private:
+    void removeFiles() const
+    {
+        std::filesystem::remove(path_);
+        for (const std::string &sibling : siblings_)
+        {
+            std::filesystem::remove(path_ + sibling);
+        }
+    }
+
+    std::string suffix_;
+    std::vector<std::string> siblings_;
+};
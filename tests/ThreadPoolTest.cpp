@@ -0,0 +1,118 @@
+#include "utils/ThreadPool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, ChunkCountRoundsUp)
+{
+    EXPECT_EQ(ThreadPool::chunkCount(0, 4), 0u);
+    EXPECT_EQ(ThreadPool::chunkCount(1, 4), 1u);
+    EXPECT_EQ(ThreadPool::chunkCount(8, 4), 2u);
+    EXPECT_EQ(ThreadPool::chunkCount(9, 4), 3u);
+    // A grain of zero is treated as one
+    EXPECT_EQ(ThreadPool::chunkCount(5, 0), 5u);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryElementOnceInFixedChunks)
+{
+    auto pool = ThreadPool::create(4);
+    const std::size_t count = 10'001;
+    const std::size_t grain = 64;
+    std::vector<std::atomic<int>> visits(count);
+    std::vector<std::atomic<int>> chunkRuns(ThreadPool::chunkCount(count, grain));
+
+    pool->parallelFor(count, grain, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                      {
+        EXPECT_EQ(begin, chunk * grain);
+        EXPECT_EQ(end, std::min(begin + grain, count));
+        ++chunkRuns[chunk];
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            ++visits[i];
+        } });
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(visits[i].load(), 1) << i;
+    }
+    for (std::size_t chunk = 0; chunk < chunkRuns.size(); ++chunk)
+    {
+        ASSERT_EQ(chunkRuns[chunk].load(), 1) << chunk;
+    }
+}
+
+TEST(ThreadPoolTest, EmptyRangeDoesNotCallFn)
+{
+    auto pool = ThreadPool::create(2);
+    bool called = false;
+    pool->parallelFor(0, 16, [&](std::size_t, std::size_t, std::size_t)
+                      { called = true; });
+    EXPECT_FALSE(called);
+}
+
+// Reducing per-chunk results in chunk order gives the same answer whatever
+// the number of threads, including none
+TEST(ThreadPoolTest, ChunkedReductionIsIndependentOfThreadCount)
+{
+    const std::size_t count = 5'000;
+    const std::size_t grain = 37;
+    auto reduce = [&](ThreadPool *pool)
+    {
+        std::vector<std::uint64_t> partial(ThreadPool::chunkCount(count, grain));
+        ThreadPool::parallelFor(pool, count, grain, [&](std::size_t chunk, std::size_t begin, std::size_t end)
+                                {
+            std::uint64_t hash = chunk;
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                hash = hash * 31 + i;
+            }
+            partial[chunk] = hash; });
+        std::uint64_t total = 0;
+        for (std::uint64_t value : partial)
+        {
+            total = total * 1'000'003 + value;
+        }
+        return total;
+    };
+
+    std::uint64_t inline_ = reduce(nullptr);
+    auto single = ThreadPool::create(1);
+    auto wide = ThreadPool::create(8);
+    EXPECT_EQ(reduce(single.get()), inline_);
+    EXPECT_EQ(reduce(wide.get()), inline_);
+}
+
+TEST(ThreadPoolTest, RethrowsAfterEveryChunkFinishes)
+{
+    auto pool = ThreadPool::create(4);
+    std::atomic<std::size_t> finished{0};
+    EXPECT_THROW(pool->parallelFor(100, 1, [&](std::size_t chunk, std::size_t, std::size_t)
+                                   {
+                     if (chunk == 7)
+                     {
+                         throw std::runtime_error("chunk failed");
+                     }
+                     std::this_thread::yield();
+                     ++finished; }),
+                 std::runtime_error);
+    EXPECT_EQ(finished.load(), 99u);
+
+    // The pool is still usable afterwards
+    std::atomic<std::size_t> total{0};
+    pool->parallelFor(10, 1, [&](std::size_t, std::size_t begin, std::size_t end)
+                      { total += end - begin; });
+    EXPECT_EQ(total.load(), 10u);
+}
+
+TEST(ThreadPoolTest, NestedCallsFromWorkersDoNotDeadlock)
+{
+    auto pool = ThreadPool::create(2);
+    std::atomic<std::size_t> total{0};
+    pool->parallelFor(8, 1, [&](std::size_t, std::size_t, std::size_t)
+                      { pool->parallelFor(16, 2, [&](std::size_t, std::size_t begin, std::size_t end)
+                                          { total += end - begin; }); });
+    EXPECT_EQ(total.load(), 8u * 16u);
+}